@@ -0,0 +1,116 @@
+#include <string>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+
+#include <Core/src/scene/scene.hpp>
+#include <Core/src/scene/data/Model.hpp>
+#include <Core/src/scene/data/ModelFile.hpp>
+#include <Core/src/gfx/gfx.hpp>
+#include <Core/src/gfx/data/TextureFile.hpp>
+#include <Core/src/utils/Exception.hpp>
+#include <Core/src/utils/JobSystem.hpp>
+
+using namespace gage;
+
+// Converts gltf models and images into the engine formats SceneGraph::import_model and AssetCache::get_texture pick up next to them:
+// AssetCooker res/models/toothless.glb res/textures/grass_tiled.jpg ... writes res/models/toothless.gmdl and res/textures/grass_tiled.gtex
+// --lods <count> and --lod-error <fraction of the mesh radius> configure the level of detail chain of the models after them,
+// --color, --linear and --normal tell how the images after them are filtered and compressed (model textures follow their material slot),
+// --fast compresses color to BC1 / BC3 instead of BC7,
+// --vertex-layout full | quantized | quantized-position picks the vertex formats of the models after it (quantized by default)
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: AssetCooker [--lods <count>] [--lod-error <fraction>] [--fast] [--color | --linear | --normal] [--vertex-layout <full | quantized | quantized-position>] <model.glb | model.gltf | image>...\n";
+        return 1;
+    }
+
+    gfx::init();
+    scene::init();
+    // Images, meshes and textures of a model are processed in parallel on its workers
+    utils::JobSystem job_system{};
+    scene::data::MeshLodSettings lod_settings{};
+    gfx::data::TextureCookSettings texture_settings{};
+    scene::data::VertexLayout vertex_layout{scene::data::VertexLayout::Quantized};
+    int failed = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--fast")
+        {
+            texture_settings.fast = true;
+            continue;
+        }
+        if (argument == "--color" || argument == "--linear" || argument == "--normal")
+        {
+            texture_settings.kind = argument == "--color" ? gfx::data::TextureKind::Color :
+                                    argument == "--linear" ? gfx::data::TextureKind::Linear : gfx::data::TextureKind::Normal;
+            continue;
+        }
+        if (argument == "--vertex-layout" && i + 1 < argc)
+        {
+            std::string value = argv[++i];
+            if (value == "full")
+                vertex_layout = scene::data::VertexLayout::Full;
+            else if (value == "quantized")
+                vertex_layout = scene::data::VertexLayout::Quantized;
+            else if (value == "quantized-position")
+                vertex_layout = scene::data::VertexLayout::QuantizedPosition;
+            else
+            {
+                std::cerr << "Invalid value for " << argument << ": " << value << "\n";
+                failed++;
+            }
+            continue;
+        }
+        if ((argument == "--lods" || argument == "--lod-error") && i + 1 < argc)
+        {
+            try
+            {
+                if (argument == "--lods")
+                    lod_settings.max_lod_count = std::max(std::stoi(argv[++i]), 1);
+                else
+                    lod_settings.max_error = std::stof(argv[++i]);
+            }
+            catch (const std::exception &)
+            {
+                std::cerr << "Invalid value for " << argument << ": " << argv[i] << "\n";
+                failed++;
+            }
+            continue;
+        }
+
+        std::filesystem::path input_path = argument;
+        try
+        {
+            if (input_path.extension() == ".glb" || input_path.extension() == ".gltf")
+            {
+                std::filesystem::path output_path = std::filesystem::path(input_path).replace_extension(scene::data::file::EXTENSION);
+                bool binary = input_path.extension() == ".glb";
+                auto gltf_model = scene::data::load_gltf(job_system, input_path.string(), binary ? scene::data::ModelImportMode::Binary : scene::data::ModelImportMode::ASCII);
+                scene::data::Model model(job_system, input_path.string(), std::move(gltf_model), lod_settings, vertex_layout);
+                model.cook(job_system, output_path.string(), texture_settings.fast);
+            }
+            else
+            {
+                std::filesystem::path output_path = std::filesystem::path(input_path).replace_extension(gfx::data::file::TEXTURE_EXTENSION);
+                std::vector<unsigned char> texture_file = gfx::data::cook_texture(input_path.string(), texture_settings);
+                std::ofstream output(output_path, std::ios::binary);
+                if (!output.write(reinterpret_cast<const char *>(texture_file.data()), texture_file.size()))
+                    throw utils::FileLoaderException{"Failed to write " + output_path.string()};
+            }
+        }
+        catch (utils::Exception &e)
+        {
+            std::cerr << "Failed to cook " << input_path.string() << ": " << e.what() << "\n";
+            failed++;
+        }
+    }
+    scene::shutdown();
+    gfx::shutdown();
+
+    return failed == 0 ? 0 : 1;
+}
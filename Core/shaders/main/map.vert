@@ -2,9 +2,10 @@
 #extension GL_ARB_shading_language_include : require
 
 #include "../includes/descriptor_set_0.inc"
+#include "../includes/vertex_quantization.inc"
 
 layout(location = 0) in vec3 in_pos;
-layout(location = 1) in vec3 in_normal;
+layout(location = 1) in vec2 in_normal; // Octahedral
 layout(location = 2) in vec2 in_uvs; 
 
 
@@ -26,6 +27,6 @@ void main()
     vec4 p_view = descriptor_set_0_ubo.view * vec4(p.xyz, 1.0);
 	gl_Position = descriptor_set_0_ubo.projection * p_view;
     vs_out.world_pos = p.xyz;
-    vs_out.normal = mat3x3(ps.model_transform) * in_normal;
+    vs_out.normal = mat3x3(ps.model_transform) * decode_octahedral_normal(in_normal);
     vs_out.uv = in_uvs;
 }
\ No newline at end of file
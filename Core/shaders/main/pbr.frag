@@ -39,8 +39,9 @@ void main()
     vec3 n = normalize(fs_in.normal);
     if(material.has_normal)
     {
-       n = texture(textures[2], fs_in.uv).rgb; 
-       n = n * 2.0 - 1.0;
+       // Cooked normal maps only store xy (BC5), z is rebuilt for every kind of normal map
+       n.xy = texture(textures[2], fs_in.uv).rg * 2.0 - 1.0;
+       n.z = sqrt(max(1.0 - dot(n.xy, n.xy), 0.0));
        n = normalize(fs_in.TBN * n); 
     }
 
@@ -3,6 +3,10 @@
 
 #include "../includes/descriptor_set_0.inc"
 #include "../includes/pbr_descriptor_set_2_vert.inc"
+#include "../includes/vertex_quantization.inc"
+
+// Set per vertex layout, in_normal.xy is an octahedral normal
+layout(constant_id = 0) const bool OCTAHEDRAL_NORMALS = false;
 
 layout(location = 0) in vec3 in_pos;
 layout(location = 1) in vec3 in_normal;
@@ -22,21 +26,26 @@ layout(location = 0) out VSOutput
 
 layout(push_constant, std140) uniform PushConstant {
     mat4x4 model_transform;
+    vec4 position_offset;
+    vec4 position_scale;
+    vec4 texcoord_transform;
 };
 
 void main() 
 {   
-    vec4 total_position = model_transform * vec4(in_pos, 1.0);
-    vec3 total_normal = mat3(transpose(inverse(model_transform))) * in_normal;
+    vec3 pos = in_pos * position_scale.xyz + position_offset.xyz;
+    vec3 normal = OCTAHEDRAL_NORMALS ? decode_octahedral_normal(in_normal.xy) : in_normal;
+    vec4 total_position = model_transform * vec4(pos, 1.0);
+    vec3 total_normal = mat3(transpose(inverse(model_transform))) * normal;
     if(animation.enabled == 1)
     { 
         total_position = vec4(0, 0, 0, 0);
         total_normal = vec3(0, 0, 0);
         for(uint i = 0 ; i < 4 ; i++)
         {
-            vec4 local_position = animation.bone_matrices[in_bone_ids[i]] * vec4(in_pos,1.0f);
+            vec4 local_position = animation.bone_matrices[in_bone_ids[i]] * vec4(pos,1.0f);
             total_position += local_position * in_weights[i];
-            vec3 local_normal = mat3(animation.bone_matrices[in_bone_ids[i]]) * in_normal;
+            vec3 local_normal = mat3(animation.bone_matrices[in_bone_ids[i]]) * normal;
             total_normal += local_normal * in_weights[i];
         }
     }
@@ -44,6 +53,6 @@ void main()
     vec4 p_view = descriptor_set_0_ubo.view * vec4(total_position.xyz, 1.0);
 	gl_Position = descriptor_set_0_ubo.projection * p_view;
 	vs_out.normal = total_normal;
-	vs_out.uv = in_uvs;
+	vs_out.uv = in_uvs * texcoord_transform.zw + texcoord_transform.xy;
     vs_out.world_pos = total_position.xyz;
 }
\ No newline at end of file
@@ -2,11 +2,12 @@
 #extension GL_ARB_shading_language_include : require
 
 #include "../includes/descriptor_set_0.inc"
+#include "../includes/vertex_quantization.inc"
 
 
 layout(location = 0) in vec3 in_pos;
 layout(location = 1) in vec2 in_tex_coord;
-layout(location = 2) in vec3 in_normal;
+layout(location = 2) in vec2 in_normal; // Octahedral
 
 layout(location = 0) out VSOutput
 {
@@ -21,7 +22,7 @@ void main()
     
     gl_Position = descriptor_set_0_ubo.projection * descriptor_set_0_ubo.view * vec4(in_pos, 1.0);
     vs_out.tex_coord = in_tex_coord * 200.0;
-    vs_out.normal = in_normal;
+    vs_out.normal = decode_octahedral_normal(in_normal);
 
 
 }
\ No newline at end of file
@@ -9,6 +9,8 @@ layout(location = 2) in vec4 in_weights;
 
 layout(push_constant, std140) uniform PushConstant {
     mat4x4 model_transform;
+    vec4 position_offset;
+    vec4 position_scale;
 };
 
 layout(set = 1, binding = 0) uniform Animation
@@ -20,13 +22,14 @@ layout(set = 1, binding = 0) uniform Animation
 
 void main()
 {
-    vec4 total_position = model_transform * vec4(in_pos, 1.0);
+    vec3 pos = in_pos * position_scale.xyz + position_offset.xyz;
+    vec4 total_position = model_transform * vec4(pos, 1.0);
     if(animation.enabled)
     {
         total_position = vec4(0, 0, 0, 0);
         for(uint i = 0 ; i < 4 ; i++)
         {
-            vec4 local_position = animation.bone_matrices[in_bone_ids[i]] * vec4(in_pos,1.0f);
+            vec4 local_position = animation.bone_matrices[in_bone_ids[i]] * vec4(pos,1.0f);
             total_position += local_position * in_weights[i];
         }
     }
@@ -3,6 +3,7 @@
 
 #include <Core/src/utils/VulkanHelper.hpp>
 #include <Core/src/utils/FileLoader.hpp>
+#include <Core/src/mem.hpp>
 
 #include "gfx.hpp"
 #include "Exception.hpp"
@@ -24,7 +25,7 @@ namespace gage::gfx
 
     };
 
-    Graphics::Graphics(GLFWwindow *window, uint32_t width, uint32_t height, std::string app_name) : 
+    Graphics::Graphics(GLFWwindow *window, uint32_t width, uint32_t height, std::string app_name, uint32_t worker_count) : 
         app_name{std::move(app_name)},
         draw_extent{width, height},
         draw_extent_temp{width, height},
@@ -37,8 +38,8 @@ namespace gage::gfx
         allocator(device, instance),
         defaults(device, cmd_pool, allocator),
         frame_datas { 
-            data::FrameData(device, desc_pool, cmd_pool, allocator.allocator, global_desc_layout.layout), 
-            data::FrameData(device, desc_pool, cmd_pool, allocator.allocator, global_desc_layout.layout)
+            data::FrameData(device, desc_pool, cmd_pool, allocator.allocator, global_desc_layout.layout, worker_count), 
+            data::FrameData(device, desc_pool, cmd_pool, allocator.allocator, global_desc_layout.layout, worker_count)
         },
         directional_light_shadow_map_resolution(2048),
         directional_light_shadow_map_resolution_temp(2048),
@@ -63,6 +64,7 @@ namespace gage::gfx
 
     VkCommandBuffer Graphics::clear(const data::Camera &camera)
     {
+        MemoryTagScope memory_tag(MemoryTag::GFX);
         VkSemaphore &present_semaphore = frame_datas[frame_index].present_semaphore;
         VkFence &render_fence = frame_datas[frame_index].render_fence;
         VmaAllocationInfo &global_alloc_info = frame_datas[frame_index].global_alloc_info;
@@ -70,6 +72,7 @@ namespace gage::gfx
         // wait until the GPU has finished rendering the last frame. Timeout of 1 second
         vk_check(vkWaitForFences(device.device, 1, &render_fence, true, 1000000000));
         vk_check(vkResetFences(device.device, 1, &render_fence));
+        frame_datas[frame_index].reset_secondary_cmds();
 
         // Check for swapchain recreation
         if (draw_extent.width != draw_extent_temp.width || draw_extent.height != draw_extent_temp.height)
@@ -127,6 +130,7 @@ namespace gage::gfx
 
     void Graphics::end_frame(VkCommandBuffer cmd)
     {
+        MemoryTagScope memory_tag(MemoryTag::GFX);
 
         VkSemaphore &present_semaphore = frame_datas[frame_index].present_semaphore;
         VkSemaphore &render_semaphore = frame_datas[frame_index].render_semaphore;
@@ -64,7 +64,8 @@ namespace gage::gfx
             glm::vec4 directional_light_cascade_planes[CASCADE_COUNT]{{10, 0, 0, 0}, {30, 0, 0, 0}, {50, 0, 0, 0}};
         };
     public:
-        Graphics(GLFWwindow *window, uint32_t width, uint32_t height, std::string app_name);
+        // worker_count is the number of threads that record secondary command buffers
+        Graphics(GLFWwindow *window, uint32_t width, uint32_t height, std::string app_name, uint32_t worker_count = 1);
         Graphics(const Graphics &) = delete;
         void operator=(const Graphics &) = delete;
         Graphics(Graphics&&) = delete;
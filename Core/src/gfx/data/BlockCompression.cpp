@@ -0,0 +1,413 @@
+#include <pch.hpp>
+#include "BlockCompression.hpp"
+
+namespace gage::gfx::data
+{
+    static constexpr uint32_t BLOCK_PIXELS = 16;
+
+    // Line through the block that the endpoints are picked on: mean of the channels and their principal axis
+    template <uint32_t N>
+    static void fit_line(const float (&colors)[BLOCK_PIXELS][N], float (&mean)[N], float (&axis)[N])
+    {
+        for (uint32_t c = 0; c < N; c++)
+        {
+            mean[c] = 0.0f;
+            for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+                mean[c] += colors[i][c];
+            mean[c] /= BLOCK_PIXELS;
+        }
+
+        float covariance[N][N]{};
+        for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+        {
+            for (uint32_t a = 0; a < N; a++)
+            {
+                for (uint32_t b = a; b < N; b++)
+                    covariance[a][b] += (colors[i][a] - mean[a]) * (colors[i][b] - mean[b]);
+            }
+        }
+        for (uint32_t a = 0; a < N; a++)
+        {
+            for (uint32_t b = 0; b < a; b++)
+                covariance[a][b] = covariance[b][a];
+        }
+
+        // Power iteration, starting on the diagonal keeps it away from the zero vector in most blocks
+        for (uint32_t c = 0; c < N; c++)
+            axis[c] = 1.0f;
+        for (uint32_t iteration = 0; iteration < 8; iteration++)
+        {
+            float next[N]{};
+            float length = 0.0f;
+            for (uint32_t a = 0; a < N; a++)
+            {
+                for (uint32_t b = 0; b < N; b++)
+                    next[a] += covariance[a][b] * axis[b];
+                length = std::max(length, std::abs(next[a]));
+            }
+            if (length < 1e-8f)
+                break;
+            for (uint32_t c = 0; c < N; c++)
+                axis[c] = next[c] / length;
+        }
+    }
+
+    // Projects the pixels on the fitted line and returns its extremes
+    template <uint32_t N>
+    static void find_endpoints(const float (&colors)[BLOCK_PIXELS][N], float (&e0)[N], float (&e1)[N])
+    {
+        float mean[N], axis[N];
+        fit_line(colors, mean, axis);
+
+        float length_squared = 0.0f;
+        for (uint32_t c = 0; c < N; c++)
+            length_squared += axis[c] * axis[c];
+
+        float t_min = 0.0f, t_max = 0.0f;
+        if (length_squared > 1e-8f)
+        {
+            t_min = std::numeric_limits<float>::max();
+            t_max = std::numeric_limits<float>::lowest();
+            for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+            {
+                float t = 0.0f;
+                for (uint32_t c = 0; c < N; c++)
+                    t += (colors[i][c] - mean[c]) * axis[c];
+                t /= length_squared;
+                t_min = std::min(t_min, t);
+                t_max = std::max(t_max, t);
+            }
+        }
+        for (uint32_t c = 0; c < N; c++)
+        {
+            e0[c] = std::clamp(mean[c] + axis[c] * t_min, 0.0f, 255.0f);
+            e1[c] = std::clamp(mean[c] + axis[c] * t_max, 0.0f, 255.0f);
+        }
+    }
+
+    // Least squares endpoints for fixed interpolation weights (0 = e0, 1 = e1), false if the weights cannot separate them
+    template <uint32_t N>
+    static bool refine_endpoints(const float (&colors)[BLOCK_PIXELS][N], const float (&weights)[BLOCK_PIXELS], float (&e0)[N], float (&e1)[N])
+    {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[N]{}, bx[N]{};
+        for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+        {
+            float b = weights[i];
+            float a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (uint32_t c = 0; c < N; c++)
+            {
+                ax[c] += a * colors[i][c];
+                bx[c] += b * colors[i][c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) < 1e-6f)
+            return false;
+
+        for (uint32_t c = 0; c < N; c++)
+        {
+            e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+            e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    static uint16_t pack_565(const float (&color)[3])
+    {
+        uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+        uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+        uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    static void unpack_565(uint16_t packed, int32_t (&color)[3])
+    {
+        int32_t r = (packed >> 11) & 0x1F;
+        int32_t g = (packed >> 5) & 0x3F;
+        int32_t b = packed & 0x1F;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // Picks the closest of the 4 colors for every pixel, returns the indices and the total squared error
+    static uint32_t find_bc1_indices(const float (&colors)[BLOCK_PIXELS][3], uint16_t c0, uint16_t c1, uint32_t& error)
+    {
+        int32_t palette[4][3];
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        uint32_t indices = 0;
+        error = 0;
+        for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+        {
+            uint32_t best = 0;
+            uint32_t best_error = std::numeric_limits<uint32_t>::max();
+            for (uint32_t p = 0; p < 4; p++)
+            {
+                uint32_t e = 0;
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    int32_t d = static_cast<int32_t>(colors[i][c]) - palette[p][c];
+                    e += d * d;
+                }
+                if (e < best_error)
+                {
+                    best_error = e;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 2);
+            error += best_error;
+        }
+        return indices;
+    }
+
+    void encode_bc1_block(const unsigned char* pixels, unsigned char* block)
+    {
+        float colors[BLOCK_PIXELS][3];
+        for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+        {
+            for (uint32_t c = 0; c < 3; c++)
+                colors[i][c] = pixels[i * 4 + c];
+        }
+
+        float e0[3], e1[3];
+        find_endpoints(colors, e0, e1);
+        uint16_t c0 = pack_565(e0);
+        uint16_t c1 = pack_565(e1);
+        uint32_t error;
+        uint32_t indices = find_bc1_indices(colors, c0, c1, error);
+
+        // One least squares pass over the chosen weights, kept when it lowers the error
+        static constexpr float INDEX_WEIGHTS[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+        float weights[BLOCK_PIXELS];
+        for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+            weights[i] = INDEX_WEIGHTS[(indices >> (i * 2)) & 0x3];
+        if (error > 0 && refine_endpoints(colors, weights, e0, e1))
+        {
+            uint16_t refined_c0 = pack_565(e0);
+            uint16_t refined_c1 = pack_565(e1);
+            uint32_t refined_error;
+            uint32_t refined_indices = find_bc1_indices(colors, refined_c0, refined_c1, refined_error);
+            if (refined_error < error)
+            {
+                c0 = refined_c0;
+                c1 = refined_c1;
+                indices = refined_indices;
+            }
+        }
+
+        // The 4 color mode needs c0 > c1, swapping the endpoints swaps indices 0 with 1 and 2 with 3
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+            indices ^= 0x55555555;
+        }
+        else if (c0 == c1)
+        {
+            indices = 0;
+        }
+
+        block[0] = c0 & 0xFF;
+        block[1] = c0 >> 8;
+        block[2] = c1 & 0xFF;
+        block[3] = c1 >> 8;
+        for (uint32_t i = 0; i < 4; i++)
+            block[4 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+
+    void encode_bc4_block(const unsigned char* pixels, uint32_t channel, unsigned char* block)
+    {
+        uint32_t min = 255, max = 0;
+        for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+        {
+            min = std::min<uint32_t>(min, pixels[i * 4 + channel]);
+            max = std::max<uint32_t>(max, pixels[i * 4 + channel]);
+        }
+
+        // 8 value mode, a0 > a1 and the 6 values in between
+        uint64_t bits = max | (min << 8);
+        if (max > min)
+        {
+            uint32_t palette[8] = {max, min};
+            for (uint32_t p = 1; p < 7; p++)
+                palette[p + 1] = ((7 - p) * max + p * min) / 7;
+
+            for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+            {
+                int32_t value = pixels[i * 4 + channel];
+                uint64_t best = 0;
+                int32_t best_error = std::numeric_limits<int32_t>::max();
+                for (uint32_t p = 0; p < 8; p++)
+                {
+                    int32_t e = std::abs(value - static_cast<int32_t>(palette[p]));
+                    if (e < best_error)
+                    {
+                        best_error = e;
+                        best = p;
+                    }
+                }
+                bits |= best << (16 + i * 3);
+            }
+        }
+        for (uint32_t i = 0; i < 8; i++)
+            block[i] = (bits >> (i * 8)) & 0xFF;
+    }
+
+    void encode_bc3_block(const unsigned char* pixels, unsigned char* block)
+    {
+        encode_bc4_block(pixels, 3, block);
+        encode_bc1_block(pixels, block + 8);
+    }
+
+    void encode_bc5_block(const unsigned char* pixels, unsigned char* block)
+    {
+        encode_bc4_block(pixels, 0, block);
+        encode_bc4_block(pixels, 1, block + 8);
+    }
+
+    static constexpr uint32_t BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct BC7Endpoint
+    {
+        uint32_t values[4]{}; // 7 bits
+        uint32_t p_bit{};
+    };
+
+    // Rounds to 7 bits with the p-bit that fits the 4 channels best
+    static BC7Endpoint quantize_bc7_endpoint(const float (&color)[4])
+    {
+        BC7Endpoint best{};
+        float best_error = std::numeric_limits<float>::max();
+        for (uint32_t p_bit = 0; p_bit < 2; p_bit++)
+        {
+            BC7Endpoint endpoint{.p_bit = p_bit};
+            float error = 0.0f;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                float quantized = std::round((color[c] - p_bit) / 2.0f);
+                endpoint.values[c] = static_cast<uint32_t>(std::clamp(quantized, 0.0f, 127.0f));
+                float d = color[c] - static_cast<float>(endpoint.values[c] * 2 + p_bit);
+                error += d * d;
+            }
+            if (error < best_error)
+            {
+                best_error = error;
+                best = endpoint;
+            }
+        }
+        return best;
+    }
+
+    static uint64_t find_bc7_indices(const float (&colors)[BLOCK_PIXELS][4], const BC7Endpoint& e0, const BC7Endpoint& e1, uint32_t (&indices)[BLOCK_PIXELS])
+    {
+        int32_t palette[16][4];
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            int32_t a = e0.values[c] * 2 + e0.p_bit;
+            int32_t b = e1.values[c] * 2 + e1.p_bit;
+            for (uint32_t p = 0; p < 16; p++)
+                palette[p][c] = ((64 - BC7_WEIGHTS[p]) * a + BC7_WEIGHTS[p] * b + 32) >> 6;
+        }
+
+        uint64_t error = 0;
+        for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+        {
+            uint32_t best_error = std::numeric_limits<uint32_t>::max();
+            for (uint32_t p = 0; p < 16; p++)
+            {
+                uint32_t e = 0;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    int32_t d = static_cast<int32_t>(colors[i][c]) - palette[p][c];
+                    e += d * d;
+                }
+                if (e < best_error)
+                {
+                    best_error = e;
+                    indices[i] = p;
+                }
+            }
+            error += best_error;
+        }
+        return error;
+    }
+
+    void encode_bc7_block(const unsigned char* pixels, unsigned char* block)
+    {
+        float colors[BLOCK_PIXELS][4];
+        for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+                colors[i][c] = pixels[i * 4 + c];
+        }
+
+        float e0[4], e1[4];
+        find_endpoints(colors, e0, e1);
+        BC7Endpoint q0 = quantize_bc7_endpoint(e0);
+        BC7Endpoint q1 = quantize_bc7_endpoint(e1);
+        uint32_t indices[BLOCK_PIXELS];
+        uint64_t error = find_bc7_indices(colors, q0, q1, indices);
+
+        for (uint32_t iteration = 0; iteration < 2 && error > 0; iteration++)
+        {
+            float weights[BLOCK_PIXELS];
+            for (uint32_t i = 0; i < BLOCK_PIXELS; i++)
+                weights[i] = BC7_WEIGHTS[indices[i]] / 64.0f;
+            if (!refine_endpoints(colors, weights, e0, e1))
+                break;
+
+            BC7Endpoint refined_q0 = quantize_bc7_endpoint(e0);
+            BC7Endpoint refined_q1 = quantize_bc7_endpoint(e1);
+            uint32_t refined_indices[BLOCK_PIXELS];
+            uint64_t refined_error = find_bc7_indices(colors, refined_q0, refined_q1, refined_indices);
+            if (refined_error >= error)
+                break;
+            q0 = refined_q0;
+            q1 = refined_q1;
+            std::copy(std::begin(refined_indices), std::end(refined_indices), std::begin(indices));
+            error = refined_error;
+        }
+
+        // The first index is stored with 3 bits, its top bit is implied zero by swapping the endpoints
+        if (indices[0] & 0x8)
+        {
+            std::swap(q0, q1);
+            for (uint32_t& index : indices)
+                index = 15 - index;
+        }
+
+        uint64_t words[2]{};
+        uint32_t position = 0;
+        auto write = [&](uint64_t value, uint32_t bit_count)
+        {
+            for (uint32_t i = 0; i < bit_count; i++, position++)
+                words[position / 64] |= ((value >> i) & 1) << (position % 64);
+        };
+        write(1 << 6, 7);
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            write(q0.values[c], 7);
+            write(q1.values[c], 7);
+        }
+        write(q0.p_bit, 1);
+        write(q1.p_bit, 1);
+        write(indices[0], 3);
+        for (uint32_t i = 1; i < BLOCK_PIXELS; i++)
+            write(indices[i], 4);
+        assert(position == 128);
+
+        for (uint32_t i = 0; i < 16; i++)
+            block[i] = (words[i / 8] >> ((i % 8) * 8)) & 0xFF;
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace gage::gfx::data
+{
+    // Encoders of one 4x4 block, pixels holds the 16 rgba8 pixels of the block in row order (64 bytes).
+    // Blocks at the edge of an image that is not a multiple of 4 repeat their last row and column
+
+    // 8 bytes, rgb. Always uses the 4 color mode so the block also fits the color part of BC3
+    void encode_bc1_block(const unsigned char* pixels, unsigned char* block);
+    // 8 bytes, one channel (0 to 3) of the pixels
+    void encode_bc4_block(const unsigned char* pixels, uint32_t channel, unsigned char* block);
+    // 16 bytes, BC4 alpha followed by BC1 rgb
+    void encode_bc3_block(const unsigned char* pixels, unsigned char* block);
+    // 16 bytes, BC4 red followed by BC4 green
+    void encode_bc5_block(const unsigned char* pixels, unsigned char* block);
+    // 16 bytes, rgba in mode 6 (one subset, 7 bit endpoints with a p-bit each, 16 weights)
+    void encode_bc7_block(const unsigned char* pixels, unsigned char* block);
+}
@@ -0,0 +1,154 @@
+#include <pch.hpp>
+#include "BufferArena.hpp"
+
+#include "UploadBatch.hpp"
+#include "../Graphics.hpp"
+
+namespace gage::gfx::data
+{
+    BufferArena::BufferArena(const Graphics &gfx, VkBufferUsageFlags flags, std::vector<uint32_t> element_sizes, uint32_t block_element_count) :
+        gfx(gfx),
+        flags(flags),
+        element_sizes(std::move(element_sizes)),
+        block_element_count(block_element_count)
+    {
+        assert(!this->element_sizes.empty() && block_element_count != 0);
+    }
+
+    BufferArena::~BufferArena()
+    {
+        for (const auto &block : blocks)
+        {
+            for (uint32_t i = 0; i < block.buffers.size(); i++)
+            {
+                vmaDestroyBuffer(gfx.allocator.allocator, block.buffers[i], block.allocations[i]);
+            }
+        }
+    }
+
+    void BufferArena::create_block(uint32_t element_count)
+    {
+        Block &block = blocks.emplace_back();
+        block.element_count = element_count;
+        block.free_ranges[0] = element_count;
+        for (uint32_t element_size : element_sizes)
+        {
+            VkBufferCreateInfo buffer_info = {};
+            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            buffer_info.size = uint64_t(element_count) * element_size;
+            buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | flags;
+
+            VmaAllocationCreateInfo alloc_info = {};
+            alloc_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            alloc_info.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+            VkBuffer buffer{};
+            VmaAllocation allocation{};
+            vk_check(vmaCreateBuffer(gfx.allocator.allocator, &buffer_info, &alloc_info, &buffer, &allocation, nullptr));
+            block.buffers.push_back(buffer);
+            block.allocations.push_back(allocation);
+            allocated_bytes += buffer_info.size;
+        }
+        log().trace("Allocating buffer arena block: {} elements, {} buffers, flags: {}", element_count, element_sizes.size(), string_VkBufferUsageFlags(flags));
+    }
+
+    BufferArena::Range BufferArena::allocate(UploadBatch &batch, uint32_t count, std::span<const std::span<const unsigned char>> datas)
+    {
+        assert(count != 0 && datas.size() == element_sizes.size());
+
+        // First fit, a block of at least count elements is added when none has room
+        Range range{};
+        bool found = false;
+        for (uint32_t b = 0; b < blocks.size() && !found; b++)
+        {
+            for (auto it = blocks[b].free_ranges.begin(); it != blocks[b].free_ranges.end(); it++)
+            {
+                if (it->second < count)
+                    continue;
+
+                range = {.block = b, .first = it->first, .count = count};
+                if (it->second > count)
+                    blocks[b].free_ranges[it->first + count] = it->second - count;
+                blocks[b].free_ranges.erase(it);
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            create_block(std::max(count, block_element_count));
+            Block &block = blocks.back();
+            range = {.block = (uint32_t)blocks.size() - 1, .first = 0, .count = count};
+            block.free_ranges.erase(0);
+            if (block.element_count > count)
+                block.free_ranges[count] = block.element_count - count;
+        }
+
+        // Every stream is written straight into one staging buffer
+        size_t total_bytes = 0;
+        for (uint32_t i = 0; i < datas.size(); i++)
+        {
+            assert(datas[i].size() <= uint64_t(count) * element_sizes[i]);
+            total_bytes += datas[i].size();
+        }
+        if (total_bytes == 0)
+            return range;
+
+        void *mapped_data{};
+        VkBuffer staging_buffer = batch.create_staging(total_bytes, &mapped_data);
+        size_t staging_offset = 0;
+        for (uint32_t i = 0; i < datas.size(); i++)
+        {
+            if (datas[i].empty())
+                continue;
+
+            std::memcpy(static_cast<unsigned char *>(mapped_data) + staging_offset, datas[i].data(), datas[i].size());
+            VkBufferCopy copy = {.srcOffset = staging_offset, .dstOffset = uint64_t(range.first) * element_sizes[i], .size = datas[i].size()};
+            vkCmdCopyBuffer(batch.get_cmd(), staging_buffer, blocks[range.block].buffers[i], 1, &copy);
+            staging_offset += datas[i].size();
+        }
+        return range;
+    }
+
+    void BufferArena::free(const Range &range)
+    {
+        assert(range.block < blocks.size() && range.count != 0);
+        auto &free_ranges = blocks[range.block].free_ranges;
+        uint32_t first = range.first;
+        uint32_t count = range.count;
+
+        auto next = free_ranges.lower_bound(first);
+        if (next != free_ranges.begin())
+        {
+            auto previous = std::prev(next);
+            assert(previous->first + previous->second <= first && "Range freed twice");
+            if (previous->first + previous->second == first)
+            {
+                first = previous->first;
+                count += previous->second;
+                free_ranges.erase(previous);
+            }
+        }
+        if (next != free_ranges.end() && next->first == range.first + range.count)
+        {
+            count += next->second;
+            free_ranges.erase(next);
+        }
+        free_ranges[first] = count;
+    }
+
+    uint32_t BufferArena::get_block_count() const
+    {
+        return blocks.size();
+    }
+
+    std::span<const VkBuffer> BufferArena::get_buffers(uint32_t block) const
+    {
+        return blocks.at(block).buffers;
+    }
+
+    size_t BufferArena::get_allocated_bytes() const
+    {
+        return allocated_bytes;
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <span>
+#include <vector>
+#include <vk_mem_alloc.h>
+
+namespace gage::gfx
+{
+    class Graphics;
+}
+
+namespace gage::gfx::data
+{
+    class UploadBatch;
+
+    // A few large device local buffers sub-allocated in ranges, instead of a dedicated allocation per resource.
+    // Every block holds one buffer per element size and a range covers the same elements of all of them,
+    // so parallel vertex streams share one base vertex. Blocks are created when none has room and live until the arena dies
+    class BufferArena
+    {
+    public:
+        struct Range
+        {
+            uint32_t block{};
+            uint32_t first{}; // In elements
+            uint32_t count{};
+        };
+
+        BufferArena(const Graphics& gfx, VkBufferUsageFlags flags, std::vector<uint32_t> element_sizes, uint32_t block_element_count);
+        ~BufferArena();
+
+        BufferArena(const BufferArena&) = delete;
+        BufferArena operator=(const BufferArena&) = delete;
+
+        // Reserves count elements and records the upload of datas (one per buffer, at most count elements each) into batch.
+        // The range can be read once the batch completed
+        Range allocate(UploadBatch& batch, uint32_t count, std::span<const std::span<const unsigned char>> datas);
+        // Gives the range back, the gpu must be done reading it
+        void free(const Range& range);
+
+        uint32_t get_block_count() const;
+        // One buffer per element size
+        std::span<const VkBuffer> get_buffers(uint32_t block) const;
+        size_t get_allocated_bytes() const;
+    private:
+        struct Block
+        {
+            std::vector<VkBuffer> buffers{};
+            std::vector<VmaAllocation> allocations{};
+            uint32_t element_count{};
+            std::map<uint32_t, uint32_t> free_ranges{}; // First element to count, neighbours are merged
+        };
+
+        void create_block(uint32_t element_count);
+    private:
+        const Graphics& gfx;
+        VkBufferUsageFlags flags{};
+        std::vector<uint32_t> element_sizes{};
+        uint32_t block_element_count{};
+        std::vector<Block> blocks{};
+        size_t allocated_bytes{};
+    };
+}
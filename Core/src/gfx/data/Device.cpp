@@ -17,6 +17,8 @@ namespace gage::gfx::data
         // vulkan 1.0 features
         VkPhysicalDeviceFeatures features{};
         features.geometryShader = true;
+        // Cooked textures are uploaded as BC1 / BC3 / BC5 / BC7
+        features.textureCompressionBC = true;
 
         // VkPhysicalDeviceVulkan13Features features13 = {};
         // features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
@@ -9,7 +9,7 @@
 
 namespace gage::gfx::data
 {
-    FrameData::FrameData(const Device &device, const DescriptorPool &desc_pool, const CommandPool& cmd_pool, VmaAllocator allocator, VkDescriptorSetLayout global_set_layout) :
+    FrameData::FrameData(const Device &device, const DescriptorPool &desc_pool, const CommandPool& cmd_pool, VmaAllocator allocator, VkDescriptorSetLayout global_set_layout, uint32_t worker_count) :
         device(device), desc_pool(desc_pool), cmd_pool(cmd_pool), allocator(allocator)
     {
         VkFenceCreateInfo fenceCreateInfo = {};
@@ -34,6 +34,17 @@ namespace gage::gfx::data
         cmd_alloc_info.commandBufferCount = 1;
         vk_check(vkAllocateCommandBuffers(device.device, &cmd_alloc_info, &cmd));
 
+        // Worker command pools, reset as a whole every frame
+        worker_cmd_pools.resize(worker_count);
+        for (auto &worker_cmd_pool : worker_cmd_pools)
+        {
+            VkCommandPoolCreateInfo command_pool_info = {};
+            command_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            command_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            command_pool_info.queueFamilyIndex = device.queue_family;
+            vk_check(vkCreateCommandPool(device.device, &command_pool_info, nullptr, &worker_cmd_pool.pool));
+        }
+
         // Create global uniform buffer
         VkBufferCreateInfo buffer_ci = {};
         buffer_ci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -73,9 +84,54 @@ namespace gage::gfx::data
     {
         vkDestroyFence(device.device, render_fence, nullptr);
         vkFreeCommandBuffers(device.device, cmd_pool.pool, 1, &cmd);
+        for (const auto &worker_cmd_pool : worker_cmd_pools)
+        {
+            vkDestroyCommandPool(device.device, worker_cmd_pool.pool, nullptr);
+        }
         vkDestroySemaphore(device.device, present_semaphore, nullptr);
         vkDestroySemaphore(device.device, render_semaphore, nullptr);
         vmaDestroyBuffer(allocator, global_buffer, global_alloc);
         vkFreeDescriptorSets(device.device, desc_pool.pool, 1, &global_set);
     }
+
+    VkCommandBuffer FrameData::begin_secondary_cmd(uint32_t worker_index, VkRenderPass render_pass, VkFramebuffer framebuffer) const
+    {
+        WorkerCommandPool &worker_cmd_pool = worker_cmd_pools.at(worker_index);
+        if (worker_cmd_pool.used_secondary_cmds == worker_cmd_pool.secondary_cmds.size())
+        {
+            VkCommandBufferAllocateInfo cmd_alloc_info = {};
+            cmd_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            cmd_alloc_info.commandPool = worker_cmd_pool.pool;
+            cmd_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            cmd_alloc_info.commandBufferCount = 1;
+
+            VkCommandBuffer secondary_cmd{};
+            vk_check(vkAllocateCommandBuffers(device.device, &cmd_alloc_info, &secondary_cmd));
+            worker_cmd_pool.secondary_cmds.push_back(secondary_cmd);
+        }
+        VkCommandBuffer secondary_cmd = worker_cmd_pool.secondary_cmds.at(worker_cmd_pool.used_secondary_cmds++);
+
+        VkCommandBufferInheritanceInfo inheritance_info = {};
+        inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.renderPass = render_pass;
+        inheritance_info.subpass = 0;
+        inheritance_info.framebuffer = framebuffer;
+
+        VkCommandBufferBeginInfo cmd_begin_info = {};
+        cmd_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        cmd_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        cmd_begin_info.pInheritanceInfo = &inheritance_info;
+        vk_check(vkBeginCommandBuffer(secondary_cmd, &cmd_begin_info));
+
+        return secondary_cmd;
+    }
+
+    void FrameData::reset_secondary_cmds()
+    {
+        for (auto &worker_cmd_pool : worker_cmd_pools)
+        {
+            vk_check(vkResetCommandPool(device.device, worker_cmd_pool.pool, 0));
+            worker_cmd_pool.used_secondary_cmds = 0;
+        }
+    }
 }
\ No newline at end of file
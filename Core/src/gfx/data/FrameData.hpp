@@ -5,6 +5,8 @@
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
+#include <vector>
+
 namespace gage::gfx::data
 {
     class Device;
@@ -12,10 +14,22 @@ namespace gage::gfx::data
     class CommandPool;
     class FrameData
     {
+        // Command pools are externally synchronized, every recording thread gets its own
+        struct WorkerCommandPool
+        {
+            VkCommandPool pool{};
+            std::vector<VkCommandBuffer> secondary_cmds{};
+            uint32_t used_secondary_cmds{};
+        };
     public:
         FrameData(const Device& device,  const DescriptorPool& desc_pool, const CommandPool& cmd_pool, VmaAllocator allocator,
-            VkDescriptorSetLayout global_set_layout);
+            VkDescriptorSetLayout global_set_layout, uint32_t worker_count);
         ~FrameData();
+
+        // Returns a secondary command buffer in recording state that continues the given render pass
+        VkCommandBuffer begin_secondary_cmd(uint32_t worker_index, VkRenderPass render_pass, VkFramebuffer framebuffer) const;
+        // Only call once the frame's render fence is signaled
+        void reset_secondary_cmds();
     private:
         const Device& device;
         const DescriptorPool& desc_pool;
@@ -30,5 +44,7 @@ namespace gage::gfx::data
         VkBuffer global_buffer{};
         VmaAllocation global_alloc{};
         VmaAllocationInfo global_alloc_info{};
+    private:
+        mutable std::vector<WorkerCommandPool> worker_cmd_pools{};
     };
 }
\ No newline at end of file
@@ -9,10 +9,15 @@ namespace gage::gfx
 
 namespace gage::gfx::data
 {
+    class UploadBatch;
+
     class GPUBuffer
     {
     public:
+        // Uploads and waits for the queue to finish
         GPUBuffer(const Graphics& gfx, VkBufferUsageFlags flags, size_t size_in_bytes, const void* data);
+        // Records the upload into batch, the buffer can be used once the batch completed
+        GPUBuffer(const Graphics& gfx, UploadBatch& batch, VkBufferUsageFlags flags, size_t size_in_bytes, const void* data);
         ~GPUBuffer();
 
         GPUBuffer(const GPUBuffer&) = delete;
@@ -28,6 +33,8 @@ namespace gage::gfx::data
         }
 
         VkBuffer get_buffer_handle() const;
+    private:
+        void create(UploadBatch& batch, VkBufferUsageFlags flags, size_t size_in_bytes, const void* data);
     private:
         const Graphics&           gfx;
         VkBuffer            buffer_handle{};
@@ -1,11 +1,25 @@
 #include <pch.hpp>
 #include "Image.hpp"
 
+#include "UploadBatch.hpp"
 #include "../Graphics.hpp"
 
 namespace gage::gfx::data
 {
     Image::Image(const Graphics &gfx, ImageCreateInfo ci) : gfx(gfx)
+    {
+        UploadBatch batch(gfx);
+        create(batch, ci);
+        batch.submit();
+        batch.wait();
+    }
+
+    Image::Image(const Graphics &gfx, UploadBatch &batch, ImageCreateInfo ci) : gfx(gfx)
+    {
+        create(batch, ci);
+    }
+
+    void Image::create(UploadBatch &batch, const ImageCreateInfo &ci)
     {
         // size_t size_in_bytes = width * height * 4;
         log().trace("Allocating image: width: {}, height: {}, size_in_bytes: {}", ci.width, ci.height, ci.size_in_bytes);
@@ -35,35 +49,8 @@ namespace gage::gfx::data
 
         // Copy to gpu
         {
-            VkBufferCreateInfo staging_buffer_info = {};
-            staging_buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            staging_buffer_info.size = ci.size_in_bytes;
-            staging_buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-            VmaAllocationCreateInfo staging_alloc_info = {};
-            staging_alloc_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
-            staging_alloc_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
-
-            // Copy staging
-            VkBuffer staging_buffer{};
-            VmaAllocation staging_allocation{};
-            VmaAllocationInfo staging_info{};
-            vk_check(vmaCreateBuffer(gfx.allocator.allocator, &staging_buffer_info, &staging_alloc_info, &staging_buffer, &staging_allocation, &staging_info));
-            std::memcpy(staging_info.pMappedData, ci.image_data, ci.size_in_bytes);
-
-            // Allocate cmd buffer
-            VkCommandBufferAllocateInfo cmd_alloc_info{};
-            cmd_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-            cmd_alloc_info.commandPool = gfx.cmd_pool.pool;
-            cmd_alloc_info.commandBufferCount = 1;
-            cmd_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-
-            VkCommandBuffer cmd{};
-            vk_check(vkAllocateCommandBuffers(gfx.device.device, &cmd_alloc_info, &cmd));
-
-            VkCommandBufferBeginInfo transfer_begin_info{};
-            transfer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            transfer_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-            vkBeginCommandBuffer(cmd, &transfer_begin_info);
+            VkBuffer staging_buffer = batch.create_staging(ci.image_data, ci.size_in_bytes);
+            VkCommandBuffer cmd = batch.get_cmd();
 
             // Transition to transfer dst
             {
@@ -94,26 +81,32 @@ namespace gage::gfx::data
 
             // Copy
             {
-                VkBufferImageCopy copy_region{};
-                copy_region.bufferOffset = 0;
-                copy_region.bufferRowLength = 0;
-                copy_region.bufferImageHeight = 0;
-
-                copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                copy_region.imageSubresource.mipLevel = 0;
-                copy_region.imageSubresource.baseArrayLayer = 0;
-                copy_region.imageSubresource.layerCount = 1;
-
-                copy_region.imageOffset = {0, 0, 0};
-                copy_region.imageExtent = {
-                    (uint32_t)ci.width,
-                    (uint32_t)ci.height,
-                    1};
-
-                vkCmdCopyBufferToImage(cmd, staging_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy_region);
+                std::vector<VkBufferImageCopy> copy_regions(ci.mip_offsets ? ci.mip_levels : 1);
+                for (uint32_t i = 0; i < copy_regions.size(); i++)
+                {
+                    VkBufferImageCopy &copy_region = copy_regions[i];
+                    copy_region.bufferOffset = ci.mip_offsets ? ci.mip_offsets[i] : 0;
+                    copy_region.bufferRowLength = 0;
+                    copy_region.bufferImageHeight = 0;
+
+                    copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                    copy_region.imageSubresource.mipLevel = i;
+                    copy_region.imageSubresource.baseArrayLayer = 0;
+                    copy_region.imageSubresource.layerCount = 1;
+
+                    copy_region.imageOffset = {0, 0, 0};
+                    copy_region.imageExtent = {
+                        std::max(ci.width >> i, 1u),
+                        std::max(ci.height >> i, 1u),
+                        1};
+                }
+
+                vkCmdCopyBufferToImage(cmd, staging_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, copy_regions.size(), copy_regions.data());
             }
 
-            if (ci.mip_levels > 1)
+            // Generated levels are transitioned one by one, the last one and uploaded levels are left for the barrier below
+            bool generate_mips = ci.mip_levels > 1 && !ci.mip_offsets;
+            if (generate_mips)
             {
                 generate_mip_maps(cmd, ci.mip_levels, ci.width, ci.height);
             }
@@ -129,8 +122,8 @@ namespace gage::gfx::data
 
                 barrier.image = image;
                 barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                barrier.subresourceRange.baseMipLevel = ci.mip_levels - 1;
-                barrier.subresourceRange.levelCount = 1;
+                barrier.subresourceRange.baseMipLevel = generate_mips ? ci.mip_levels - 1 : 0;
+                barrier.subresourceRange.levelCount = generate_mips ? 1 : ci.mip_levels;
                 barrier.subresourceRange.baseArrayLayer = 0;
                 barrier.subresourceRange.layerCount = 1;
 
@@ -143,20 +136,6 @@ namespace gage::gfx::data
                     0, nullptr,
                     1, &barrier);
             }
-
-            vkEndCommandBuffer(cmd);
-
-            VkSubmitInfo submit_info{};
-            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-            submit_info.commandBufferCount = 1;
-            submit_info.pCommandBuffers = &cmd;
-
-            vkQueueSubmit(gfx.device.queue, 1, &submit_info, nullptr);
-            vkQueueWaitIdle(gfx.device.queue);
-
-            // Cleanup resources
-            vmaDestroyBuffer(gfx.allocator.allocator, staging_buffer, staging_allocation);
-            vkFreeCommandBuffers(gfx.device.device, gfx.cmd_pool.pool, 1, &cmd);
         }
 
         // Create image view
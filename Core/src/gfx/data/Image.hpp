@@ -19,12 +19,19 @@ namespace gage::gfx::data
         VkFilter min_filter{};
         VkFilter mag_filter{};
         VkSamplerAddressMode address_node{};
+        // Offset of every mip level into image_data, the levels are copied as they are instead of blitted from the first
+        const uint64_t* mip_offsets{};
     };
 
+    class UploadBatch;
+
     class Image
     {
     public:
+        // Uploads and waits for the queue to finish
         Image(const Graphics& gfx, ImageCreateInfo ci);
+        // Records the upload into batch, the image can be sampled once the batch completed
+        Image(const Graphics& gfx, UploadBatch& batch, ImageCreateInfo ci);
         Image(Image&& other) : gfx(other.gfx)
         {
             this->image = other.image;
@@ -45,6 +52,7 @@ namespace gage::gfx::data
         VkImageView get_image_view() const;
         VkSampler get_sampler() const;
     private:
+        void create(UploadBatch& batch, const ImageCreateInfo& ci);
         void generate_mip_maps(VkCommandBuffer cmd, uint32_t mip_levels, uint32_t width, uint32_t height);
     private:
         const Graphics& gfx;
@@ -0,0 +1,337 @@
+#include <pch.hpp>
+#include "TextureFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "BlockCompression.hpp"
+#include "../Exception.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#define GAGE_TEXTURE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace gage::gfx::data
+{
+    struct BlockFormat
+    {
+        VkFormat format;
+        uint32_t block_size; // Bytes per 4x4 block
+        void (*encode)(const unsigned char *pixels, unsigned char *block);
+    };
+
+    static constexpr BlockFormat BLOCK_FORMATS[] = {
+        {VK_FORMAT_BC1_RGB_UNORM_BLOCK, 8, encode_bc1_block},
+        {VK_FORMAT_BC3_UNORM_BLOCK, 16, encode_bc3_block},
+        {VK_FORMAT_BC5_UNORM_BLOCK, 16, encode_bc5_block},
+        {VK_FORMAT_BC7_UNORM_BLOCK, 16, encode_bc7_block}};
+
+    static const BlockFormat *find_block_format(uint32_t format)
+    {
+        for (const BlockFormat &block_format : BLOCK_FORMATS)
+        {
+            if (block_format.format == static_cast<VkFormat>(format))
+                return &block_format;
+        }
+        return nullptr;
+    }
+
+    static uint32_t get_level_count(uint32_t width, uint32_t height)
+    {
+        return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+    }
+
+    static uint64_t get_level_size(const BlockFormat &block_format, uint32_t width, uint32_t height)
+    {
+        return uint64_t((width + 3) / 4) * ((height + 3) / 4) * block_format.block_size;
+    }
+
+    static float srgb_to_linear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static float linear_to_srgb(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    // Level of the mip chain as floats: linear color, raw data or a normal in [-1, 1]
+    struct FloatLevel
+    {
+        uint32_t width{}, height{};
+        std::vector<glm::vec4> texels{};
+    };
+
+    static FloatLevel decode_level(const unsigned char *pixels, uint32_t width, uint32_t height, TextureKind kind)
+    {
+        static const std::array<float, 256> SRGB_TO_LINEAR = []
+        {
+            std::array<float, 256> table{};
+            for (uint32_t i = 0; i < 256; i++)
+                table[i] = srgb_to_linear(i / 255.0f);
+            return table;
+        }();
+
+        FloatLevel level{width, height};
+        level.texels.resize(size_t(width) * height);
+        for (size_t i = 0; i < level.texels.size(); i++)
+        {
+            const unsigned char *pixel = pixels + i * 4;
+            glm::vec4 &texel = level.texels[i];
+            switch (kind)
+            {
+            case TextureKind::Color:
+                texel = {SRGB_TO_LINEAR[pixel[0]], SRGB_TO_LINEAR[pixel[1]], SRGB_TO_LINEAR[pixel[2]], pixel[3] / 255.0f};
+                break;
+            case TextureKind::Linear:
+                texel = glm::vec4{pixel[0], pixel[1], pixel[2], pixel[3]} / 255.0f;
+                break;
+            case TextureKind::Normal:
+                texel = glm::vec4{glm::vec3{pixel[0], pixel[1], pixel[2]} / 127.5f - 1.0f, pixel[3] / 255.0f};
+                break;
+            }
+        }
+        return level;
+    }
+
+    static std::vector<unsigned char> encode_level(const FloatLevel &level, TextureKind kind)
+    {
+        // Fine enough that every 8 bit sRGB value has its own entry near black
+        static constexpr uint32_t LINEAR_TO_SRGB_SIZE = 4096;
+        static const std::array<unsigned char, LINEAR_TO_SRGB_SIZE> LINEAR_TO_SRGB = []
+        {
+            std::array<unsigned char, LINEAR_TO_SRGB_SIZE> table{};
+            for (uint32_t i = 0; i < LINEAR_TO_SRGB_SIZE; i++)
+                table[i] = static_cast<unsigned char>(linear_to_srgb(i / float(LINEAR_TO_SRGB_SIZE - 1)) * 255.0f + 0.5f);
+            return table;
+        }();
+        auto to_byte = [](float value)
+        {
+            return static_cast<unsigned char>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+        };
+
+        std::vector<unsigned char> pixels(level.texels.size() * 4);
+        for (size_t i = 0; i < level.texels.size(); i++)
+        {
+            const glm::vec4 &texel = level.texels[i];
+            unsigned char *pixel = pixels.data() + i * 4;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                switch (kind)
+                {
+                case TextureKind::Color:
+                    pixel[c] = LINEAR_TO_SRGB[static_cast<uint32_t>(std::clamp(texel[c], 0.0f, 1.0f) * (LINEAR_TO_SRGB_SIZE - 1) + 0.5f)];
+                    break;
+                case TextureKind::Linear:
+                    pixel[c] = to_byte(texel[c]);
+                    break;
+                case TextureKind::Normal:
+                    pixel[c] = to_byte(texel[c] * 0.5f + 0.5f);
+                    break;
+                }
+            }
+            pixel[3] = to_byte(texel.w);
+        }
+        return pixels;
+    }
+
+    // Box filter to half the size. Odd sizes fold their last row and column into the last texel so no source texel is dropped
+    static FloatLevel downsample(const FloatLevel &source, TextureKind kind)
+    {
+        FloatLevel target{std::max(source.width / 2, 1u), std::max(source.height / 2, 1u)};
+        target.texels.resize(size_t(target.width) * target.height);
+        for (uint32_t y = 0; y < target.height; y++)
+        {
+            uint32_t y_begin = std::min(y * 2, source.height - 1);
+            uint32_t y_end = y == target.height - 1 ? source.height : y_begin + 2;
+            for (uint32_t x = 0; x < target.width; x++)
+            {
+                uint32_t x_begin = std::min(x * 2, source.width - 1);
+                uint32_t x_end = x == target.width - 1 ? source.width : x_begin + 2;
+                float weight = 1.0f / ((y_end - y_begin) * (x_end - x_begin));
+
+                glm::vec4 &texel = target.texels[size_t(y) * target.width + x];
+#ifdef GAGE_TEXTURE_SSE
+                __m128 sum = _mm_setzero_ps();
+                for (uint32_t sy = y_begin; sy < y_end; sy++)
+                {
+                    for (uint32_t sx = x_begin; sx < x_end; sx++)
+                        sum = _mm_add_ps(sum, _mm_loadu_ps(&source.texels[size_t(sy) * source.width + sx].x));
+                }
+                _mm_storeu_ps(&texel.x, _mm_mul_ps(sum, _mm_set1_ps(weight)));
+#else
+                texel = glm::vec4{0.0f};
+                for (uint32_t sy = y_begin; sy < y_end; sy++)
+                {
+                    for (uint32_t sx = x_begin; sx < x_end; sx++)
+                        texel += source.texels[size_t(sy) * source.width + sx];
+                }
+                texel *= weight;
+#endif
+
+                if (kind == TextureKind::Normal)
+                {
+                    glm::vec3 normal{texel};
+                    float length = glm::length(normal);
+                    normal = length > 1e-6f ? normal / length : glm::vec3{0.0f, 0.0f, 1.0f};
+                    texel = glm::vec4{normal, texel.w};
+                }
+            }
+        }
+        return target;
+    }
+
+    static void compress_level(const unsigned char *pixels, uint32_t width, uint32_t height, const BlockFormat &block_format, unsigned char *out)
+    {
+        uint32_t blocks_x = (width + 3) / 4;
+        uint32_t blocks_y = (height + 3) / 4;
+        unsigned char block_pixels[16 * 4];
+        for (uint32_t by = 0; by < blocks_y; by++)
+        {
+            for (uint32_t bx = 0; bx < blocks_x; bx++)
+            {
+                for (uint32_t y = 0; y < 4; y++)
+                {
+                    uint32_t source_y = std::min(by * 4 + y, height - 1);
+                    for (uint32_t x = 0; x < 4; x++)
+                    {
+                        uint32_t source_x = std::min(bx * 4 + x, width - 1);
+                        std::memcpy(block_pixels + (y * 4 + x) * 4, pixels + (size_t(source_y) * width + source_x) * 4, 4);
+                    }
+                }
+                block_format.encode(block_pixels, out);
+                out += block_format.block_size;
+            }
+        }
+    }
+
+    std::vector<unsigned char> cook_texture(const unsigned char *pixels, uint32_t width, uint32_t height, const TextureCookSettings &settings)
+    {
+        assert(width > 0 && height > 0);
+
+        bool has_alpha = false;
+        if (settings.kind == TextureKind::Color)
+        {
+            for (size_t i = 0; i < size_t(width) * height && !has_alpha; i++)
+                has_alpha = pixels[i * 4 + 3] != 255;
+        }
+        const BlockFormat *block_format{};
+        if (settings.kind == TextureKind::Normal)
+            block_format = find_block_format(VK_FORMAT_BC5_UNORM_BLOCK);
+        else if (settings.fast)
+            block_format = find_block_format(has_alpha ? VK_FORMAT_BC3_UNORM_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+        else
+            block_format = find_block_format(VK_FORMAT_BC7_UNORM_BLOCK);
+
+        file::TextureHeader header{};
+        std::memcpy(header.magic, file::TEXTURE_MAGIC, sizeof(header.magic));
+        header.version = file::TEXTURE_VERSION;
+        header.format = block_format->format;
+        header.width = width;
+        header.height = height;
+        header.level_count = get_level_count(width, height);
+
+        std::vector<file::TextureLevel> levels(header.level_count);
+        std::vector<unsigned char> result(sizeof(header) + levels.size() * sizeof(file::TextureLevel));
+
+        // Every level is filtered from the float level above it so rounding does not add up along the chain
+        std::vector<unsigned char> level_pixels(pixels, pixels + size_t(width) * height * 4);
+        FloatLevel level = decode_level(pixels, width, height, settings.kind);
+        for (uint32_t i = 0; i < header.level_count; i++)
+        {
+            if (i > 0)
+            {
+                level = downsample(level, settings.kind);
+                level_pixels = encode_level(level, settings.kind);
+            }
+
+            uint64_t offset = (result.size() + file::TEXTURE_DATA_ALIGNMENT - 1) & ~(file::TEXTURE_DATA_ALIGNMENT - 1);
+            levels[i].offset = offset;
+            levels[i].size = get_level_size(*block_format, level.width, level.height);
+            result.resize(offset + levels[i].size);
+            compress_level(level_pixels.data(), level.width, level.height, *block_format, result.data() + offset);
+        }
+
+        std::memcpy(result.data(), &header, sizeof(header));
+        std::memcpy(result.data() + sizeof(header), levels.data(), levels.size() * sizeof(file::TextureLevel));
+        return result;
+    }
+
+    std::vector<unsigned char> cook_texture(const std::string &image_path, const TextureCookSettings &settings)
+    {
+        int width, height, components;
+        stbi_uc *pixels = stbi_load(image_path.c_str(), &width, &height, &components, 4);
+        if (!pixels)
+        {
+            log().critical("Failed to decode image: {}", image_path);
+            throw GraphicsException{"Failed to decode image: " + image_path};
+        }
+        std::vector<unsigned char> result = cook_texture(pixels, width, height, settings);
+        stbi_image_free(pixels);
+        return result;
+    }
+
+    TextureFile::TextureFile(std::span<const unsigned char> file)
+    {
+        auto fail = [](const char *reason)
+        {
+            log().critical("Invalid texture file: {}", reason);
+            throw GraphicsException{std::string("Invalid texture file: ") + reason};
+        };
+
+        if (file.size() < sizeof(header))
+            fail("File too small");
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, file::TEXTURE_MAGIC, sizeof(header.magic)) != 0)
+            fail("Not a texture file");
+        if (header.version != file::TEXTURE_VERSION)
+            fail("Unsupported version");
+        const BlockFormat *block_format = find_block_format(header.format);
+        if (block_format == nullptr)
+            fail("Unsupported format");
+        if (header.width == 0 || header.height == 0 || header.level_count == 0 || header.level_count > get_level_count(header.width, header.height))
+            fail("Invalid size");
+        if (header.level_count > (file.size() - sizeof(header)) / sizeof(file::TextureLevel))
+            fail("Level index out of range");
+
+        level_offsets.resize(header.level_count);
+        uint64_t first_offset = 0;
+        uint64_t end = sizeof(header) + header.level_count * sizeof(file::TextureLevel);
+        for (uint32_t i = 0; i < header.level_count; i++)
+        {
+            file::TextureLevel level{};
+            std::memcpy(&level, file.data() + sizeof(header) + i * sizeof(file::TextureLevel), sizeof(level));
+            uint32_t level_width = std::max(header.width >> i, 1u);
+            uint32_t level_height = std::max(header.height >> i, 1u);
+            if (level.size != get_level_size(*block_format, level_width, level_height))
+                fail("Level size does not match the format");
+            if (level.offset < end || level.offset % file::TEXTURE_DATA_ALIGNMENT != 0 || level.offset > file.size() || level.size > file.size() - level.offset)
+                fail("Level out of range");
+
+            if (i == 0)
+                first_offset = level.offset;
+            level_offsets[i] = level.offset - first_offset;
+            end = level.offset + level.size;
+        }
+        data = file.subspan(first_offset, end - first_offset);
+    }
+
+    ImageCreateInfo TextureFile::get_image_create_info(VkFilter min_filter, VkFilter mag_filter, VkSamplerAddressMode address_mode) const
+    {
+        ImageCreateInfo ci{};
+        ci.image_data = data.data();
+        ci.width = header.width;
+        ci.height = header.height;
+        ci.mip_levels = header.level_count;
+        ci.size_in_bytes = static_cast<uint32_t>(data.size());
+        ci.format = static_cast<VkFormat>(header.format);
+        ci.min_filter = min_filter;
+        ci.mag_filter = mag_filter;
+        ci.address_node = address_mode;
+        ci.mip_offsets = level_offsets.data();
+        return ci;
+    }
+}
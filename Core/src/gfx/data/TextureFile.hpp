@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Image.hpp"
+
+namespace gage::gfx::data::file
+{
+    // Block compressed texture with its whole mip chain, written by AssetCooker and uploaded by Image as is.
+    // Layout follows KTX2: TextureHeader | TextureLevel[level_count] | level data, largest level first,
+    // every level at an offset aligned to DATA_ALIGNMENT
+    static constexpr char TEXTURE_MAGIC[4] = {'G', 'T', 'E', 'X'};
+    static constexpr uint32_t TEXTURE_VERSION = 1;
+    static constexpr const char* TEXTURE_EXTENSION = ".gtex";
+    static constexpr uint64_t TEXTURE_DATA_ALIGNMENT = 16;
+
+    struct TextureHeader
+    {
+        char magic[4]{};
+        uint32_t version{};
+        uint32_t format{}; // VkFormat
+        uint32_t width{};
+        uint32_t height{};
+        uint32_t level_count{};
+    };
+
+    struct TextureLevel
+    {
+        uint64_t offset{}; // From the start of the file
+        uint64_t size{};
+    };
+
+    static_assert(std::is_trivially_copyable_v<TextureHeader> && sizeof(TextureHeader) == 24);
+    static_assert(std::is_trivially_copyable_v<TextureLevel> && sizeof(TextureLevel) == 16);
+}
+
+namespace gage::gfx::data
+{
+    enum class TextureKind
+    {
+        Color,  // sRGB encoded, the mip chain is filtered in linear space
+        Linear, // Data like metalness and roughness, filtered as stored
+        Normal  // Tangent space normal in rgb, renormalized per level and stored as xy, z is rebuilt in the shader
+    };
+
+    struct TextureCookSettings
+    {
+        TextureKind kind{TextureKind::Color};
+        bool fast{}; // BC1 or BC3 instead of BC7 for color and linear textures
+    };
+
+    // Generates the mip chain of width * height rgba8 pixels and block compresses every level into a texture file
+    std::vector<unsigned char> cook_texture(const unsigned char* pixels, uint32_t width, uint32_t height, const TextureCookSettings& settings);
+    // Decodes an image file (png, jpg, tga...) and cooks it, throws GraphicsException if it can not be decoded
+    std::vector<unsigned char> cook_texture(const std::string& image_path, const TextureCookSettings& settings);
+
+    // Texture file read in place, throws GraphicsException if it is malformed
+    class TextureFile
+    {
+    public:
+        TextureFile(std::span<const unsigned char> file);
+
+        // Uploads every level with one copy, the file must stay alive until the image is created
+        ImageCreateInfo get_image_create_info(VkFilter min_filter, VkFilter mag_filter, VkSamplerAddressMode address_mode) const;
+    private:
+        std::span<const unsigned char> data{}; // From the first level to the end of the last
+        file::TextureHeader header{};
+        std::vector<uint64_t> level_offsets{}; // From the first level
+    };
+}
@@ -0,0 +1,122 @@
+#include <pch.hpp>
+#include "UploadBatch.hpp"
+
+#include "../Graphics.hpp"
+
+namespace gage::gfx::data
+{
+    UploadBatch::UploadBatch(const Graphics &gfx) : gfx(gfx)
+    {
+        VkCommandBufferAllocateInfo cmd_alloc_info{};
+        cmd_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmd_alloc_info.commandPool = gfx.cmd_pool.pool;
+        cmd_alloc_info.commandBufferCount = 1;
+        cmd_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        vk_check(vkAllocateCommandBuffers(gfx.device.device, &cmd_alloc_info, &cmd));
+
+        VkFenceCreateInfo fence_info{};
+        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        vk_check(vkCreateFence(gfx.device.device, &fence_info, nullptr, &fence));
+
+        VkCommandBufferBeginInfo begin_info{};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vk_check(vkBeginCommandBuffer(cmd, &begin_info));
+    }
+
+    UploadBatch::~UploadBatch()
+    {
+        if (submitted)
+        {
+            wait();
+        }
+        else
+        {
+            vkEndCommandBuffer(cmd);
+        }
+
+        log().trace("Freeing upload batch: {} staging buffers, {} bytes", stagings.size(), staging_bytes);
+        for (const auto &staging : stagings)
+        {
+            vmaDestroyBuffer(gfx.allocator.allocator, staging.buffer, staging.allocation);
+        }
+        vkDestroyFence(gfx.device.device, fence, nullptr);
+        vkFreeCommandBuffers(gfx.device.device, gfx.cmd_pool.pool, 1, &cmd);
+    }
+
+    VkBuffer UploadBatch::create_staging(const void *data, size_t size_in_bytes)
+    {
+        assert(data != nullptr);
+        void *mapped_data{};
+        VkBuffer buffer = create_staging(size_in_bytes, &mapped_data);
+        std::memcpy(mapped_data, data, size_in_bytes);
+        return buffer;
+    }
+
+    VkBuffer UploadBatch::create_staging(size_t size_in_bytes, void **mapped_data)
+    {
+        assert(!submitted && size_in_bytes != 0 && mapped_data != nullptr);
+        VkBufferCreateInfo staging_buffer_info = {};
+        staging_buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        staging_buffer_info.size = size_in_bytes;
+        staging_buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        VmaAllocationCreateInfo staging_alloc_info = {};
+        staging_alloc_info.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+        staging_alloc_info.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        Staging staging{};
+        VmaAllocationInfo staging_info{};
+        vk_check(vmaCreateBuffer(gfx.allocator.allocator, &staging_buffer_info, &staging_alloc_info, &staging.buffer, &staging.allocation, &staging_info));
+        *mapped_data = staging_info.pMappedData;
+
+        stagings.push_back(staging);
+        staging_bytes += size_in_bytes;
+        return staging.buffer;
+    }
+
+    VkCommandBuffer UploadBatch::get_cmd() const
+    {
+        assert(!submitted);
+        return cmd;
+    }
+
+    void UploadBatch::submit()
+    {
+        assert(!submitted);
+
+        // Later submissions read the uploaded data as vertices, indices, uniforms or textures
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cmd,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             1, &barrier,
+                             0, nullptr,
+                             0, nullptr);
+        vk_check(vkEndCommandBuffer(cmd));
+
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &cmd;
+        vk_check(vkQueueSubmit(gfx.device.queue, 1, &submit_info, fence));
+        submitted = true;
+    }
+
+    bool UploadBatch::is_complete() const
+    {
+        return submitted && vkGetFenceStatus(gfx.device.device, fence) == VK_SUCCESS;
+    }
+
+    void UploadBatch::wait() const
+    {
+        assert(submitted);
+        vk_check(vkWaitForFences(gfx.device.device, 1, &fence, VK_TRUE, UINT64_MAX));
+    }
+
+    size_t UploadBatch::get_staging_bytes() const
+    {
+        return staging_bytes;
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <vk_mem_alloc.h>
+
+namespace gage::gfx
+{
+    class Graphics;
+}
+
+namespace gage::gfx::data
+{
+    // Records many uploads into one command buffer that is submitted once and tracked by a fence,
+    // instead of a submit and a queue wait per resource. Staging buffers are kept until the batch completed.
+    // Uses gfx.cmd_pool and the graphics queue, only record and submit from the main thread.
+    class UploadBatch
+    {
+        struct Staging
+        {
+            VkBuffer buffer{};
+            VmaAllocation allocation{};
+        };
+    public:
+        UploadBatch(const Graphics& gfx);
+        // Waits for the batch if it was submitted
+        ~UploadBatch();
+
+        UploadBatch(const UploadBatch&) = delete;
+        UploadBatch operator=(const UploadBatch&) = delete;
+
+        // Copy of data that lives until the batch completed
+        VkBuffer create_staging(const void* data, size_t size_in_bytes);
+        // Uninitialized mapped memory that lives until the batch completed, for data written in place before submit()
+        VkBuffer create_staging(size_t size_in_bytes, void** mapped_data);
+        // Recording command buffer, valid until submit()
+        VkCommandBuffer get_cmd() const;
+
+        // Makes the transfers visible to every later submission on the queue
+        void submit();
+        bool is_complete() const;
+        void wait() const;
+
+        size_t get_staging_bytes() const;
+    private:
+        const Graphics& gfx;
+        VkCommandBuffer cmd{};
+        VkFence fence{};
+        std::vector<Staging> stagings{};
+        size_t staging_bytes{};
+        bool submitted{};
+    };
+}
@@ -32,7 +32,7 @@ namespace gage::gfx::data::g_buffer
         shadow_pass.reset();
     }
 
-    void GBuffer::begin_shadowpass(VkCommandBuffer cmd) const
+    void GBuffer::begin_shadowpass(VkCommandBuffer cmd, VkSubpassContents contents) const
     {
         VkRenderPassBeginInfo render_pass_begin_info{};
         render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -44,10 +44,10 @@ namespace gage::gfx::data::g_buffer
         clear_values[0].depthStencil = {1.0, 0};
         render_pass_begin_info.clearValueCount = clear_values.size();
         render_pass_begin_info.pClearValues = clear_values.data();
-        vkCmdBeginRenderPass(cmd, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(cmd, &render_pass_begin_info, contents);
     }
 
-    void GBuffer::begin_mainpass(VkCommandBuffer cmd) const
+    void GBuffer::begin_mainpass(VkCommandBuffer cmd, VkSubpassContents contents) const
     {
         VkRenderPassBeginInfo render_pass_begin_info{};
         render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -63,7 +63,7 @@ namespace gage::gfx::data::g_buffer
         clear_values[3].depthStencil = {1.0f, 0};
         render_pass_begin_info.clearValueCount = clear_values.size();
         render_pass_begin_info.pClearValues = clear_values.data();
-        vkCmdBeginRenderPass(cmd, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(cmd, &render_pass_begin_info, contents);
     }
 
     void GBuffer::begin_lightpass(VkCommandBuffer cmd) const
@@ -120,6 +120,16 @@ namespace gage::gfx::data::g_buffer
     {
         return shadow_pass.shadowpass_renderpass;
     }
+
+    VkFramebuffer GBuffer::get_mainpass_framebuffer() const
+    {
+        return main_pass.framebuffer;
+    }
+
+    VkFramebuffer GBuffer::get_shadowpass_framebuffer() const
+    {
+        return shadow_pass.shadowpass_framebuffer;
+    }
     VkImageView GBuffer::get_depth_view() const
     {
         return main_pass.depth_image_view;
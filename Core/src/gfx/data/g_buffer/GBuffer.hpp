@@ -20,8 +20,9 @@ namespace gage::gfx::data::g_buffer
         GBuffer(const Graphics& gfx);
         ~GBuffer();
 
-        void begin_shadowpass(VkCommandBuffer cmd) const;
-        void begin_mainpass(VkCommandBuffer cmd) const;
+        // Pass VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS when the pass is recorded by worker threads
+        void begin_shadowpass(VkCommandBuffer cmd, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) const;
+        void begin_mainpass(VkCommandBuffer cmd, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) const;
         void begin_lightpass(VkCommandBuffer cmd) const;
         void begin_ssaopass(VkCommandBuffer cmd) const;
         void end(VkCommandBuffer cmd) const;
@@ -31,6 +32,9 @@ namespace gage::gfx::data::g_buffer
         VkRenderPass get_shadowpass_render_pass() const;
         VkRenderPass get_ssao_render_pass() const;
 
+        VkFramebuffer get_mainpass_framebuffer() const;
+        VkFramebuffer get_shadowpass_framebuffer() const;
+
         VkImageView get_depth_view() const;
         VkImageView get_stencil_view() const;
         VkImageView get_normal_view() const;
@@ -1,41 +1,438 @@
 #include <pch.hpp>
 #include "mem.hpp"
 
+#include <Core/src/utils/StackTrace.hpp>
+
 #include <cstdint>
+#include <cinttypes>
+#include <algorithm>
 #include <exception>
+#include <new>
 #include <cstdlib>
-
+#include <atomic>
+#include <cstdio>
 
 namespace gage
 {
-    static size_t allocated_bytes{}; 
+    static constexpr size_t TAG_COUNT = (size_t)MemoryTag::COUNT;
+    static constexpr uint32_t FLUSH_ALLOCATION_COUNT = 64;
+    static constexpr int64_t FLUSH_BYTES = 256 * 1024;
+
+    // Stored in front of every allocation so frees are accounted to the tag that allocated
+    struct alignas(16) AllocationHeader
+    {
+        uint64_t size;
+        MemoryTag tag;
+        uint32_t offset; // From the start of the malloc block to the header, over aligned allocations are padded
+    };
+
+    struct GlobalMemoryStats
+    {
+        std::atomic<int64_t> allocated_bytes{};
+        std::atomic<int64_t> peak_bytes{};
+        std::atomic<int64_t> allocation_count{};
+        std::atomic<int64_t> free_count{};
+    };
+
+    // Must stay trivial, it is used before any constructor runs
+    struct ThreadMemoryStats
+    {
+        int64_t allocated_bytes[TAG_COUNT];
+        int64_t allocation_count[TAG_COUNT];
+        int64_t free_count[TAG_COUNT];
+        int64_t bytes_allocated_since_flush;
+        uint32_t pending_operations;
+        MemoryTag tag;
+        bool reporting_budget;
+        bool excluded_from_budget;
+    };
+
+    static GlobalMemoryStats global_stats[TAG_COUNT]{};
+    static GlobalMemoryStats global_total{};
+    static thread_local ThreadMemoryStats thread_stats{};
+
+    static std::atomic<uint64_t> frame_index{};
+    static int64_t frame_begin_allocation_count{};
+    static int64_t frame_begin_allocation_bytes{};
+    static std::atomic<int64_t> last_frame_allocation_count{};
+    static std::atomic<int64_t> last_frame_allocated_bytes{};
+    static std::atomic<int64_t> total_allocated_bytes_ever{};
+
+    static std::atomic<FrameAllocationBudgetMode> budget_mode{FrameAllocationBudgetMode::DISABLED};
+    static std::atomic<int64_t> budget_max_allocations{};
+    static std::atomic<int64_t> budget_frame_allocations{};
+    static std::atomic<bool> budget_frame_active{};
+    static std::atomic<bool> budget_exceeded_reported{};
+
+    static void update_peak(std::atomic<int64_t> &peak, int64_t value)
+    {
+        int64_t current_peak = peak.load(std::memory_order_relaxed);
+        while (value > current_peak && !peak.compare_exchange_weak(current_peak, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    static void flush(ThreadMemoryStats &stats)
+    {
+        int64_t total_bytes = 0;
+        int64_t total_allocations = 0;
+        int64_t total_frees = 0;
+        for (size_t i = 0; i < TAG_COUNT; i++)
+        {
+            if (stats.allocated_bytes[i] == 0 && stats.allocation_count[i] == 0 && stats.free_count[i] == 0)
+                continue;
+
+            GlobalMemoryStats &global = global_stats[i];
+            int64_t current = global.allocated_bytes.fetch_add(stats.allocated_bytes[i], std::memory_order_relaxed) + stats.allocated_bytes[i];
+            update_peak(global.peak_bytes, current);
+            global.allocation_count.fetch_add(stats.allocation_count[i], std::memory_order_relaxed);
+            global.free_count.fetch_add(stats.free_count[i], std::memory_order_relaxed);
+
+            total_bytes += stats.allocated_bytes[i];
+            total_allocations += stats.allocation_count[i];
+            total_frees += stats.free_count[i];
+
+            stats.allocated_bytes[i] = 0;
+            stats.allocation_count[i] = 0;
+            stats.free_count[i] = 0;
+        }
+
+        int64_t current = global_total.allocated_bytes.fetch_add(total_bytes, std::memory_order_relaxed) + total_bytes;
+        update_peak(global_total.peak_bytes, current);
+        global_total.allocation_count.fetch_add(total_allocations, std::memory_order_relaxed);
+        global_total.free_count.fetch_add(total_frees, std::memory_order_relaxed);
+        total_allocated_bytes_ever.fetch_add(stats.bytes_allocated_since_flush, std::memory_order_relaxed);
+
+        stats.bytes_allocated_since_flush = 0;
+        stats.pending_operations = 0;
+    }
+
+    static void check_frame_budget(ThreadMemoryStats &stats)
+    {
+        FrameAllocationBudgetMode mode = budget_mode.load(std::memory_order_relaxed);
+        if (mode == FrameAllocationBudgetMode::DISABLED || !budget_frame_active.load(std::memory_order_relaxed) || stats.reporting_budget || stats.excluded_from_budget)
+            return;
+
+        int64_t count = budget_frame_allocations.fetch_add(1, std::memory_order_relaxed) + 1;
+        int64_t max_allocations = budget_max_allocations.load(std::memory_order_relaxed);
+        if (count <= max_allocations)
+            return;
+
+        if (mode == FrameAllocationBudgetMode::LOG && budget_exceeded_reported.exchange(true, std::memory_order_relaxed))
+            return;
+
+        // Printing allocates, do not report those allocations again. Loggers are avoided since the allocation could come from inside one
+        stats.reporting_budget = true;
+        std::fprintf(stderr, "Frame %" PRIu64 " exceeded its allocation budget of %" PRId64 " allocations:\n", frame_index.load(std::memory_order_relaxed), max_allocations);
+        utils::StackTrace stack_trace;
+        std::fputs(stack_trace.print().c_str(), stderr);
+        std::fflush(stderr);
+        stats.reporting_budget = false;
+
+        if (mode == FrameAllocationBudgetMode::ABORT)
+        {
+            std::abort();
+        }
+    }
+
+    static void account(MemoryTag tag, int64_t bytes)
+    {
+        ThreadMemoryStats &stats = thread_stats;
+        size_t index = (size_t)tag;
+        stats.allocated_bytes[index] += bytes;
+        if (bytes > 0)
+        {
+            stats.allocation_count[index]++;
+            stats.bytes_allocated_since_flush += bytes;
+            check_frame_budget(stats);
+        }
+        else
+        {
+            stats.free_count[index]++;
+        }
+
+        if (++stats.pending_operations >= FLUSH_ALLOCATION_COUNT || std::abs(stats.allocated_bytes[index]) >= FLUSH_BYTES)
+        {
+            flush(stats);
+        }
+    }
+
+    static void *allocate(std::size_t n, std::size_t alignment = alignof(AllocationHeader)) noexcept
+    {
+        // The header sits right before the returned pointer, bigger alignments pad in front of it
+        alignment = std::max(alignment, alignof(AllocationHeader));
+        size_t padding = alignment - alignof(AllocationHeader);
+        void *ptr = std::malloc(n + sizeof(AllocationHeader) + padding);
+        if (!ptr)
+            return nullptr;
+
+        uintptr_t data = ((uintptr_t)ptr + sizeof(AllocationHeader) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        AllocationHeader *header = (AllocationHeader *)data - 1;
+        header->size = n;
+        header->tag = thread_stats.tag;
+        header->offset = (uint32_t)((uintptr_t)header - (uintptr_t)ptr);
+        account(header->tag, (int64_t)n);
+        return header + 1;
+    }
+
+    static void deallocate(void *p) noexcept
+    {
+        if (!p)
+            return;
+
+        AllocationHeader *header = (AllocationHeader *)p - 1;
+        account(header->tag, -(int64_t)header->size);
+        std::free((unsigned char *)header - header->offset);
+    }
+
+    MemoryTagScope::MemoryTagScope(MemoryTag tag) : previous_tag(thread_stats.tag)
+    {
+        thread_stats.tag = tag;
+    }
+
+    MemoryTagScope::~MemoryTagScope()
+    {
+        thread_stats.tag = previous_tag;
+    }
 
     size_t get_allocated_bytes()
     {
-        return allocated_bytes;
+        return global_total.allocated_bytes.load(std::memory_order_relaxed);
+    }
+
+    const char *get_memory_tag_name(MemoryTag tag)
+    {
+        switch (tag)
+        {
+        case MemoryTag::UNTAGGED:
+            return "Untagged";
+        case MemoryTag::SCENE:
+            return "Scene";
+        case MemoryTag::GFX:
+            return "Gfx";
+        case MemoryTag::PHYSICS:
+            return "Physics";
+        case MemoryTag::ASSETS:
+            return "Assets";
+        default:
+            return "Unknown";
+        }
+    }
+
+    static MemoryStats load_stats(const GlobalMemoryStats &stats)
+    {
+        return MemoryStats{
+            .allocated_bytes = stats.allocated_bytes.load(std::memory_order_relaxed),
+            .peak_bytes = stats.peak_bytes.load(std::memory_order_relaxed),
+            .allocation_count = stats.allocation_count.load(std::memory_order_relaxed),
+            .free_count = stats.free_count.load(std::memory_order_relaxed),
+        };
+    }
+
+    MemorySnapshot take_memory_snapshot()
+    {
+        flush(thread_stats);
+
+        MemorySnapshot snapshot{};
+        for (size_t i = 0; i < TAG_COUNT; i++)
+        {
+            snapshot.tags[i] = load_stats(global_stats[i]);
+        }
+        snapshot.total = load_stats(global_total);
+        snapshot.frame_index = frame_index.load(std::memory_order_relaxed);
+        snapshot.frame_allocation_count = last_frame_allocation_count.load(std::memory_order_relaxed);
+        snapshot.frame_allocated_bytes = last_frame_allocated_bytes.load(std::memory_order_relaxed);
+        return snapshot;
     }
+
+    static MemoryStats diff_stats(const MemoryStats &a, const MemoryStats &b)
+    {
+        return MemoryStats{
+            .allocated_bytes = b.allocated_bytes - a.allocated_bytes,
+            .peak_bytes = b.peak_bytes,
+            .allocation_count = b.allocation_count - a.allocation_count,
+            .free_count = b.free_count - a.free_count,
+        };
+    }
+
+    MemorySnapshot diff_memory_snapshots(const MemorySnapshot &a, const MemorySnapshot &b)
+    {
+        MemorySnapshot diff{};
+        for (size_t i = 0; i < TAG_COUNT; i++)
+        {
+            diff.tags[i] = diff_stats(a.tags[i], b.tags[i]);
+        }
+        diff.total = diff_stats(a.total, b.total);
+        diff.frame_index = b.frame_index - a.frame_index;
+        diff.frame_allocation_count = b.frame_allocation_count;
+        diff.frame_allocated_bytes = b.frame_allocated_bytes;
+        return diff;
+    }
+
+    void flush_thread_memory_stats()
+    {
+        flush(thread_stats);
+    }
+
+    FrameBudgetExclusionScope::FrameBudgetExclusionScope() : previous_excluded(thread_stats.excluded_from_budget)
+    {
+        thread_stats.excluded_from_budget = true;
+    }
+
+    FrameBudgetExclusionScope::~FrameBudgetExclusionScope()
+    {
+        thread_stats.excluded_from_budget = previous_excluded;
+    }
+
+    void memory_begin_frame()
+    {
+        flush(thread_stats);
+        frame_begin_allocation_count = global_total.allocation_count.load(std::memory_order_relaxed);
+        frame_begin_allocation_bytes = total_allocated_bytes_ever.load(std::memory_order_relaxed);
+
+        budget_frame_allocations.store(0, std::memory_order_relaxed);
+        budget_exceeded_reported.store(false, std::memory_order_relaxed);
+        budget_frame_active.store(true, std::memory_order_relaxed);
+    }
+
+    void memory_end_frame()
+    {
+        budget_frame_active.store(false, std::memory_order_relaxed);
+        flush(thread_stats);
+        last_frame_allocation_count.store(global_total.allocation_count.load(std::memory_order_relaxed) - frame_begin_allocation_count, std::memory_order_relaxed);
+        last_frame_allocated_bytes.store(total_allocated_bytes_ever.load(std::memory_order_relaxed) - frame_begin_allocation_bytes, std::memory_order_relaxed);
+        frame_index.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void set_frame_allocation_budget(FrameAllocationBudgetMode mode, int64_t max_allocations)
+    {
+        budget_max_allocations.store(max_allocations, std::memory_order_relaxed);
+        budget_mode.store(mode, std::memory_order_relaxed);
+    }
+
+    FrameAllocationBudgetMode get_frame_allocation_budget_mode()
+    {
+        return budget_mode.load(std::memory_order_relaxed);
+    }
+
+    int64_t get_frame_allocation_budget()
+    {
+        return budget_max_allocations.load(std::memory_order_relaxed);
+    }
+}
+
+void *operator new(std::size_t n)
+{
+    if (n == 0)
+        n++;
+
+    if (void *ptr = gage::allocate(n))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t n)
+{
+    return ::operator new(n);
+}
+
+void *operator new(std::size_t n, const std::nothrow_t &) noexcept
+{
+    return gage::allocate(n == 0 ? 1 : n);
+}
+
+void *operator new[](std::size_t n, const std::nothrow_t &) noexcept
+{
+    return gage::allocate(n == 0 ? 1 : n);
+}
+
+void operator delete(void *p) noexcept
+{
+    gage::deallocate(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    gage::deallocate(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    gage::deallocate(p);
 }
 
- 
-void * operator new(std::size_t n)
+void operator delete[](void *p, std::size_t) noexcept
+{
+    gage::deallocate(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    gage::deallocate(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    gage::deallocate(p);
+}
+
+void *operator new(std::size_t n, std::align_val_t alignment)
 {
     if (n == 0)
         n++;
- 
-    if (void *ptr =std::malloc(n))
+
+    if (void *ptr = gage::allocate(n, (std::size_t)alignment))
     {
-        gage::allocated_bytes += n;
         return ptr;
     }
- 
+
     throw std::bad_alloc{};
 }
 
+void *operator new[](std::size_t n, std::align_val_t alignment)
+{
+    return ::operator new(n, alignment);
+}
 
+void *operator new(std::size_t n, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return gage::allocate(n == 0 ? 1 : n, (std::size_t)alignment);
+}
+
+void *operator new[](std::size_t n, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return gage::allocate(n == 0 ? 1 : n, (std::size_t)alignment);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+    gage::deallocate(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept
+{
+    gage::deallocate(p);
+}
 
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept
+{
+    gage::deallocate(p);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept
+{
+    gage::deallocate(p);
+}
+
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+    gage::deallocate(p);
+}
 
-void operator delete(void * p, std::size_t n)
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept
 {
-    gage::allocated_bytes -= n;
-    std::free(p);
+    gage::deallocate(p);
 }
@@ -1,7 +1,84 @@
+#pragma once
 
 #include <cstdint>
+#include <cstddef>
 
 namespace gage
 {
+    enum class MemoryTag : uint8_t
+    {
+        UNTAGGED,
+        SCENE,
+        GFX,
+        PHYSICS,
+        ASSETS,
+        COUNT
+    };
+
+    // Every allocation made by the current thread while the scope is alive is accounted to tag
+    class MemoryTagScope
+    {
+    public:
+        MemoryTagScope(MemoryTag tag);
+        ~MemoryTagScope();
+
+        MemoryTagScope(const MemoryTagScope &) = delete;
+        MemoryTagScope operator=(const MemoryTagScope &) = delete;
+    private:
+        MemoryTag previous_tag;
+    };
+
+    enum class FrameAllocationBudgetMode
+    {
+        DISABLED,
+        LOG,   // Print the stack of the first allocation over budget each frame
+        ABORT  // Print the stack and abort
+    };
+
+    struct MemoryStats
+    {
+        int64_t allocated_bytes{};
+        int64_t peak_bytes{};
+        int64_t allocation_count{};
+        int64_t free_count{};
+    };
+
+    struct MemorySnapshot
+    {
+        MemoryStats tags[(size_t)MemoryTag::COUNT]{};
+        MemoryStats total{};
+        uint64_t frame_index{};
+        int64_t frame_allocation_count{}; // Of the last finished frame
+        int64_t frame_allocated_bytes{};
+    };
+
     size_t get_allocated_bytes();
-};
\ No newline at end of file
+    const char *get_memory_tag_name(MemoryTag tag);
+
+    // Counters are batched per thread, snapshots can lag behind by a few allocations per thread
+    MemorySnapshot take_memory_snapshot();
+    // Returns b - a, peaks are the ones of b
+    MemorySnapshot diff_memory_snapshots(const MemorySnapshot &a, const MemorySnapshot &b);
+    void flush_thread_memory_stats();
+
+    void memory_begin_frame();
+    void memory_end_frame();
+
+    // Checked on every allocation made between memory_begin_frame and memory_end_frame, from any thread
+    void set_frame_allocation_budget(FrameAllocationBudgetMode mode, int64_t max_allocations);
+    FrameAllocationBudgetMode get_frame_allocation_budget_mode();
+    int64_t get_frame_allocation_budget();
+    // Allocations made by the current thread while the scope is alive do not count towards the frame budget,
+    // for background work running on a job system worker
+    class FrameBudgetExclusionScope
+    {
+    public:
+        FrameBudgetExclusionScope();
+        ~FrameBudgetExclusionScope();
+
+        FrameBudgetExclusionScope(const FrameBudgetExclusionScope &) = delete;
+        FrameBudgetExclusionScope operator=(const FrameBudgetExclusionScope &) = delete;
+    private:
+        bool previous_excluded;
+    };
+};
@@ -0,0 +1,190 @@
+#include <pch.hpp>
+#include "AssetCache.hpp"
+
+#include "scene.hpp"
+
+#include <Core/src/gfx/Graphics.hpp>
+#include <Core/src/gfx/data/TextureFile.hpp>
+#include <Core/src/utils/MappedFile.hpp>
+#include <Core/src/utils/Exception.hpp>
+#include <Core/src/mem.hpp>
+
+namespace gage::scene
+{
+    Texture::Texture(const gfx::Graphics &gfx, const gfx::data::ImageCreateInfo &ci) :
+        image(gfx, ci),
+        width(ci.width),
+        height(ci.height)
+    {
+    }
+
+    AssetCache::AssetCache(const gfx::Graphics &gfx, utils::JobSystem &job_system) : gfx(gfx), job_system(job_system)
+    {
+    }
+
+    AssetCache::~AssetCache()
+    {
+    }
+
+    std::shared_ptr<const tinygltf::Model> AssetCache::get_gltf(const std::string &file_path, data::ModelImportMode mode)
+    {
+        return get_derived<tinygltf::Model>(file_path, "gltf", [this, &file_path, mode]() -> std::shared_ptr<const tinygltf::Model>
+        {
+            MemoryTagScope memory_tag(MemoryTag::ASSETS);
+            return data::load_gltf(job_system, file_path, mode);
+        });
+    }
+
+    std::shared_ptr<const Texture> AssetCache::get_texture(const std::string &file_path, const TextureDesc &desc)
+    {
+        std::string cooked_file_path = std::filesystem::path(file_path).replace_extension(gfx::data::file::TEXTURE_EXTENSION).string();
+        std::error_code error{};
+        std::filesystem::file_time_type cooked_time = std::filesystem::last_write_time(cooked_file_path, error);
+        if (!error && !(cooked_time < std::filesystem::last_write_time(file_path, error)))
+        {
+            try
+            {
+                return get_derived<Texture>(cooked_file_path, "cooked_texture", [this, &cooked_file_path]() -> std::shared_ptr<const Texture>
+                {
+                    MemoryTagScope memory_tag(MemoryTag::ASSETS);
+                    utils::MappedFile file(cooked_file_path);
+                    gfx::data::TextureFile texture_file(std::span(file.get_data(), file.get_size()));
+                    return std::make_shared<Texture>(gfx, texture_file.get_image_create_info(VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_REPEAT));
+                });
+            }
+            catch (const utils::Exception &)
+            {
+                log().warn("Failed to load cooked texture: {}, decoding {}", cooked_file_path, file_path);
+            }
+        }
+
+        std::string kind = std::string("texture") + (desc.mip_maps ? "_mips" : "");
+        return get_derived<Texture>(file_path, kind, [this, &file_path, &desc]() -> std::shared_ptr<const Texture>
+        {
+            MemoryTagScope memory_tag(MemoryTag::ASSETS);
+            int w, h, comp;
+            stbi_uc *data = stbi_load(file_path.c_str(), &w, &h, &comp, 4);
+            if (!data)
+                return nullptr;
+
+            gfx::data::ImageCreateInfo ci{};
+            ci.image_data = data;
+            ci.width = w;
+            ci.height = h;
+            ci.size_in_bytes = w * h * 4;
+            ci.format = VK_FORMAT_R8G8B8A8_UNORM;
+            ci.min_filter = VK_FILTER_NEAREST;
+            ci.mag_filter = VK_FILTER_NEAREST;
+            ci.address_node = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+            ci.mip_levels = desc.mip_maps ? std::floor(std::log2(std::max(w, h))) + 1 : 1;
+            auto texture = std::make_shared<Texture>(gfx, ci);
+            stbi_image_free(data);
+            return texture;
+        });
+    }
+
+    std::shared_ptr<const void> AssetCache::get(const std::string &file_path, std::string_view kind, const std::function<std::shared_ptr<const void>()> &create)
+    {
+        uint64_t content_hash = get_content_hash(file_path);
+        std::string key = std::string(kind) + '|' + file_path;
+
+        std::shared_future<std::shared_ptr<const void>> existing{};
+        std::promise<std::shared_ptr<const void>> promise{};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(key);
+            if (it != entries.end() && it->second.content_hash == content_hash)
+                existing = it->second.asset;
+            else
+                entries[key] = Entry{content_hash, promise.get_future().share()};
+        }
+
+        // Loaded or still being loaded by another thread
+        if (existing.valid())
+            return existing.get();
+
+        try
+        {
+            std::shared_ptr<const void> asset = create();
+            promise.set_value(asset);
+            return asset;
+        }
+        catch (...)
+        {
+            // Not cached so the next request tries again, threads already waiting get the error
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = entries.find(key);
+                if (it != entries.end() && it->second.content_hash == content_hash)
+                    entries.erase(it);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    uint64_t AssetCache::get_content_hash(const std::string &file_path)
+    {
+        std::error_code error{};
+        std::filesystem::file_time_type write_time = std::filesystem::last_write_time(file_path, error);
+        if (error)
+            return 0;
+        uintmax_t size = std::filesystem::file_size(file_path, error);
+        if (error)
+            return 0;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = file_stamps.find(file_path);
+            if (it != file_stamps.end() && it->second.write_time == write_time && it->second.size == size)
+                return it->second.content_hash;
+        }
+
+        // FNV-1a
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file.is_open())
+            return 0;
+        uint64_t hash = 14695981039346656037ull;
+        std::vector<char> chunk(64 * 1024);
+        while (file.read(chunk.data(), chunk.size()) || file.gcount() > 0)
+        {
+            for (std::streamsize i = 0; i < file.gcount(); i++)
+            {
+                hash ^= (unsigned char)chunk[i];
+                hash *= 1099511628211ull;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        file_stamps[file_path] = FileStamp{write_time, size, hash};
+        return hash;
+    }
+
+    uint32_t AssetCache::release_unused()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint32_t released = 0;
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            const auto &asset = it->second.asset;
+            // Failed loads are never left in the map, a ready entry always has a value
+            if (asset.wait_for(std::chrono::seconds(0)) == std::future_status::ready && asset.get().use_count() <= 1)
+            {
+                log().trace("Releasing asset: {}", it->first);
+                it = entries.erase(it);
+                released++;
+            }
+            else
+            {
+                it++;
+            }
+        }
+        return released;
+    }
+
+    uint32_t AssetCache::get_entry_count() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "data/Model.hpp"
+
+#include <Core/src/gfx/data/Image.hpp>
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <functional>
+#include <filesystem>
+#include <unordered_map>
+#include <cstdint>
+
+namespace gage::gfx
+{
+    class Graphics;
+}
+
+namespace gage::utils
+{
+    class JobSystem;
+}
+
+namespace tinygltf
+{
+    class Model;
+}
+
+namespace gage::scene
+{
+    // Images are decoded to 8 bit rgba
+    struct TextureDesc
+    {
+        bool mip_maps{}; // Blitted at upload, cooked textures always have their whole chain
+    };
+
+    class Texture
+    {
+    public:
+        Texture(const gfx::Graphics& gfx, const gfx::data::ImageCreateInfo& ci);
+    public:
+        gfx::data::Image image;
+        uint32_t width{}, height{};
+    };
+
+    // Assets loaded from files, shared by everything that asks for the same file.
+    // Entries are keyed by path and the hash of the file content, a file that changed on disk is loaded again while
+    // the users of the old version keep it alive. release_unused() frees what only the cache still holds.
+    // Lookups are thread safe, loading runs outside the lock and concurrent requests for one asset wait for the first.
+    class AssetCache
+    {
+        struct Entry
+        {
+            uint64_t content_hash{};
+            std::shared_future<std::shared_ptr<const void>> asset{};
+        };
+        struct FileStamp
+        {
+            std::filesystem::file_time_type write_time{};
+            uintmax_t size{};
+            uint64_t content_hash{};
+        };
+    public:
+        AssetCache(const gfx::Graphics& gfx, utils::JobSystem& job_system);
+        ~AssetCache();
+
+        AssetCache(const AssetCache&) = delete;
+        AssetCache operator=(const AssetCache&) = delete;
+
+        // Images are decoded to 8 bit rgba, in jobs. Call it from a job system worker
+        std::shared_ptr<const tinygltf::Model> get_gltf(const std::string& file_path, data::ModelImportMode mode);
+        // Decoded and uploaded, nullptr if the file could not be decoded. Main thread only.
+        // A texture file cooked next to the image (.gtex) is uploaded instead when it is not older than the image
+        std::shared_ptr<const Texture> get_texture(const std::string& file_path, const TextureDesc& desc);
+        // Anything built from a file (vertex buffers, collision shapes...), create() runs on a miss.
+        // kind tells apart the assets built from the same file and always has to come with the same T
+        template<typename T>
+        std::shared_ptr<const T> get_derived(const std::string& file_path, std::string_view kind, const std::function<std::shared_ptr<const T>()>& create)
+        {
+            return std::static_pointer_cast<const T>(get(file_path, kind, [&create]() -> std::shared_ptr<const void> { return create(); }));
+        }
+
+        // Drops the assets nobody else holds anymore, returns how many
+        uint32_t release_unused();
+        uint32_t get_entry_count() const;
+    private:
+        std::shared_ptr<const void> get(const std::string& file_path, std::string_view kind, const std::function<std::shared_ptr<const void>()>& create);
+        // 0 for files that can not be read
+        uint64_t get_content_hash(const std::string& file_path);
+    private:
+        const gfx::Graphics& gfx;
+        utils::JobSystem& job_system;
+        mutable std::mutex mutex{};
+        std::unordered_map<std::string, Entry> entries{}; // kind|path
+        std::unordered_map<std::string, FileStamp> file_stamps{}; // Content hashes are only recomputed when the stamp changed
+    };
+}
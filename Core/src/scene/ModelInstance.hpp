@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Node.hpp"
+
+#include <vector>
+
+namespace gage::scene::data
+{
+    class Model;
+}
+
+namespace gage::scene
+{
+    // Nodes created by SceneGraph::instanciate_model, owned by the root node of the instance
+    struct ModelInstance
+    {
+        const data::Model &model;
+        std::vector<NodeHandle> nodes{}; // Indexed by model node index, which is also the bone id
+    };
+}
@@ -5,35 +5,45 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "SceneGraph.hpp"
+#include "ModelInstance.hpp"
 
 namespace gage::scene
 {
-    Node::Node(SceneGraph &scene, uint64_t id) : scene(scene),
-                                                 id(id)
+    Node::Node(SceneGraph &scene, TransformHierarchy &transforms) : scene(scene),
+                                                                     transforms(transforms),
+                                                                     transform(transforms.create())
     {
     }
     Node::~Node()
     {
+        transforms.destroy(transform);
     }
 
     nlohmann::json Node::to_json() const
     {
         nlohmann::json j;
         j["name"] = name;
-        j["transform_pos_x"] = this->position.x;
-        j["transform_pos_y"] = this->position.y;
-        j["transform_pos_z"] = this->position.z;
-
-        j["transform_scale_x"] = this->scale.x;
-        j["transform_scale_y"] = this->scale.y;
-        j["transform_scale_z"] = this->scale.z;
-
-        j["transform_rotateion_x"] = this->rotation.x;
-        j["transform_rotateion_y"] = this->rotation.y;
-        j["transform_rotateion_z"] = this->rotation.z;
-        j["transform_rotateion_w"] = this->rotation.w;
+        const glm::vec3 &position = get_position();
+        const glm::vec3 &scale = get_scale();
+        const glm::quat &rotation = get_rotation();
+        j["transform_pos_x"] = position.x;
+        j["transform_pos_y"] = position.y;
+        j["transform_pos_z"] = position.z;
+
+        j["transform_scale_x"] = scale.x;
+        j["transform_scale_y"] = scale.y;
+        j["transform_scale_z"] = scale.z;
+
+        j["transform_rotateion_x"] = rotation.x;
+        j["transform_rotateion_y"] = rotation.y;
+        j["transform_rotateion_z"] = rotation.z;
+        j["transform_rotateion_w"] = rotation.w;
 
         j["bone_id"] = this->bone_id;
+        if (model_instance)
+        {
+            j["model_instance"] = model_instance->model.name;
+        }
 
         std::array<float, 16> inverse_bind_matrix;
         for (uint32_t i = 0; i < 4; i++)
@@ -50,7 +60,7 @@ namespace gage::scene
             j["components"].push_back(component->to_json());
         }
         
-        for (const auto &child : children)
+        for (const Node *child : get_children())
         {
             j["children"].push_back(child->to_json());
         }
@@ -65,9 +75,15 @@ namespace gage::scene
             return;
 
         ImGui::Text("Transform");
-        ImGui::DragFloat3("position", &position.x, 0.1f);
-        ImGui::DragFloat3("scale", &scale.x, 0.1f);
-        ImGui::DragFloat4("rotation", glm::value_ptr(rotation), 0.01f, -1.0f, 1.0f);
+        glm::vec3 position = get_position();
+        glm::vec3 scale = get_scale();
+        glm::quat rotation = get_rotation();
+        if (ImGui::DragFloat3("position", &position.x, 0.1f))
+            set_position(position);
+        if (ImGui::DragFloat3("scale", &scale.x, 0.1f))
+            set_scale(scale);
+        if (ImGui::DragFloat4("rotation", glm::value_ptr(rotation), 0.01f, -1.0f, 1.0f))
+            set_rotation(rotation);
 
         ImGui::Separator();
 
@@ -81,57 +97,58 @@ namespace gage::scene
 
     void Node::add_component_ptr(components::IComponent *component)
     {
+        components::ComponentTypeId type_id = component->get_type_id();
+        uint64_t type_bit = uint64_t{1} << type_id;
+        if ((component_mask & type_bit) == 0)
+        {
+            component_mask |= type_bit;
+            component_slots[type_id] = component;
+        }
         component_ptrs.push_back(component);
     }
 
-   
-    
-
-    void *Node::get_requested_component(const char *typeid_name)
+    void Node::detach_from_parent()
     {
-        for (auto &component : component_ptrs)
-        {
-            log().trace("Searching for component: {}", typeid(*component).name());
-            if (typeid(*component).name() == typeid_name)
-            {
-                return component;
-            }
-        }
-        log().error("Unknown requested component: {}", typeid_name);
-        return nullptr;
+        if (parent == nullptr)
+            return;
+
+        if (prev_sibling)
+            prev_sibling->next_sibling = next_sibling;
+        else
+            parent->first_child = next_sibling;
+
+        if (next_sibling)
+            next_sibling->prev_sibling = prev_sibling;
+        else
+            parent->last_child = prev_sibling;
+
+        parent = nullptr;
+        prev_sibling = nullptr;
+        next_sibling = nullptr;
     }
 
-    void *Node::get_requested_component_recursive(const char *typeid_name)
+    void Node::append_child(Node *child)
     {
-        log().trace("get_requested_component_recursive: {}", this->name);
-        auto component = this->get_requested_component(typeid_name);
-        if (component != nullptr)
-        {
-            return component;
-        }
-
-        for (const auto &child : children)
-        {
-            log().trace("Searching for component in child: {}", child->name);
-            return child->get_requested_component_recursive(typeid_name);
-        }
-        return nullptr;
+        assert(child->parent == nullptr && "Detach the child first");
+        child->parent = this;
+        child->prev_sibling = last_child;
+        if (last_child)
+            last_child->next_sibling = child;
+        else
+            first_child = child;
+        last_child = child;
     }
 
-    void Node::get_requested_component_accumulate_recursive(const char *typeid_name, std::vector<void *> &out_components)
+    void Node::leave_instance(NodeHandle root)
     {
-        log().trace("get_requested_component_accumulate_recursive: {}", this->name);
-        for (auto &component : this->component_ptrs)
-        {
-            if (typeid(*component).name() == typeid_name)
-            {
-                out_components.push_back(component);
-            }
-        }
+        // Nested instances keep their own root
+        if (instance_root != root)
+            return;
 
-        for (const auto &child : children)
+        instance_root = {};
+        for (Node *child : get_children())
         {
-            child->get_requested_component_accumulate_recursive(typeid_name, out_components);
+            child->leave_instance(root);
         }
     }
 
@@ -141,7 +158,7 @@ namespace gage::scene
         {
             return this;
         }
-        for (const auto &child : this->children)
+        for (Node *child : get_children())
         {
             auto result = child->search_child_by_name(name);
             if (result)
@@ -151,4 +168,30 @@ namespace gage::scene
         }
         return nullptr;
     }
+
+    Node *Node::search_instance_node_by_name(const std::string &name)
+    {
+        if (model_instance)
+        {
+            std::optional<uint32_t> model_node_index = model_instance->model.find_node(name);
+            if (model_node_index)
+            {
+                Node *node = get_instance_node(*model_node_index);
+                if (node && node->name == name)
+                    return node;
+            }
+        }
+        return search_child_by_name(name);
+    }
+
+    Node *Node::get_instance_node(uint32_t model_node_index)
+    {
+        if (!model_instance)
+            return nullptr;
+
+        Node *node = scene.get_node(model_instance->nodes.at(model_node_index));
+        if (node == nullptr || node->instance_root != handle)
+            return nullptr;
+        return node;
+    }
 }
\ No newline at end of file
@@ -2,8 +2,13 @@
 
 #include "components/IComponent.hpp"
 #include "scene.hpp"
+#include "TransformHierarchy.hpp"
+
+#include <Core/src/utils/LinearArena.hpp>
 
 #include <vector>
+#include <array>
+#include <limits>
 #include <memory>
 
 #include <glm/vec3.hpp>
@@ -13,11 +18,50 @@
 namespace gage::scene
 {
     class SceneGraph;
+    struct ModelInstance;
+
+    // Slot of a node in the scene graph plus the generation of that slot when the node was created,
+    // a handle to a destroyed node never resolves to whatever reuses its slot
+    struct NodeHandle
+    {
+        static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+        uint32_t index{INVALID_INDEX};
+        uint32_t generation{};
+
+        bool operator==(const NodeHandle &other) const = default;
+    };
+
     class Node
     {
         friend class SceneGraph;
     public:
-        Node(SceneGraph& scene, uint64_t id);
+        // Walks the intrusive sibling list
+        class ChildIterator
+        {
+        public:
+            ChildIterator(Node* node) : node(node) {}
+
+            Node* operator*() const { return node; }
+            ChildIterator& operator++()
+            {
+                node = node->next_sibling;
+                return *this;
+            }
+            bool operator!=(const ChildIterator& other) const { return node != other.node; }
+        private:
+            Node* node;
+        };
+
+        struct ChildRange
+        {
+            Node* first{};
+
+            ChildIterator begin() const { return ChildIterator(first); }
+            ChildIterator end() const { return ChildIterator(nullptr); }
+        };
+    public:
+        Node(SceneGraph& scene, TransformHierarchy& transforms);
         ~Node();
 
         nlohmann::json to_json() const;
@@ -26,28 +70,104 @@ namespace gage::scene
 
 
         void add_component_ptr(components::IComponent* component);
-        void* get_requested_component(const char* typeid_name);
-        void* get_requested_component_recursive(const char* typeid_name);
-        void get_requested_component_accumulate_recursive(const char* typeid_name, std::vector<void*>& out_components);
+
+        // First component of type T on this node or nullptr, T has to be listed in components::ComponentTypes
+        template<typename T>
+        T* get_requested_component()
+        {
+            constexpr components::ComponentTypeId type_id = components::component_type_id<T>;
+            if ((component_mask & components::component_type_bit<T>) == 0)
+                return nullptr;
+            return static_cast<T*>(component_slots[type_id]);
+        }
+
+        template<typename T>
+        T* get_requested_component_recursive()
+        {
+            T* component = get_requested_component<T>();
+            if (component != nullptr)
+                return component;
+
+            for (Node* child : get_children())
+            {
+                component = child->get_requested_component_recursive<T>();
+                if (component != nullptr)
+                    return component;
+            }
+            return nullptr;
+        }
+
+        // Every component of type T on this node and its descendants
+        template<typename T>
+        void get_requested_component_accumulate_recursive(utils::ArenaVector<T*>& out_components)
+        {
+            if (component_mask & components::component_type_bit<T>)
+            {
+                for (components::IComponent* component : component_ptrs)
+                {
+                    if (component->get_type_id() == components::component_type_id<T>)
+                        out_components.push_back(static_cast<T*>(component));
+                }
+            }
+
+            for (Node* child : get_children())
+            {
+                child->get_requested_component_accumulate_recursive<T>(out_components);
+            }
+        }
+
+        uint64_t get_component_mask() const { return component_mask; }
 
         
+        // First node named name in this subtree, pre order
         Node* search_child_by_name(const std::string& name);
+        // Looks name up in the model's name index when this node is the root of a model instance, the first model node
+        // in pre order wins. Falls back to search_child_by_name otherwise or when that node is gone from the instance
+        Node* search_instance_node_by_name(const std::string& name);
+        // Node created from the model node at model_node_index when this node is the root of a model instance,
+        // nullptr if it was destroyed or moved out of the instance since
+        Node* get_instance_node(uint32_t model_node_index);
+        const ModelInstance* get_model_instance() const { return model_instance.get(); }
+
+        const glm::vec3& get_position() const { return transforms.get_position(transform); }
+        const glm::vec3& get_scale() const { return transforms.get_scale(transform); }
+        const glm::quat& get_rotation() const { return transforms.get_rotation(transform); }
+        const glm::mat4x4& get_global_transform() const { return transforms.get_global_transform(transform); }
 
+        void set_position(const glm::vec3& position) { transforms.set_position(transform, position); }
+        void set_scale(const glm::vec3& scale) { transforms.set_scale(transform, scale); }
+        void set_rotation(const glm::quat& rotation) { transforms.set_rotation(transform, rotation); }
+
+        TransformHandle get_transform_handle() const { return transform; }
+        NodeHandle get_handle() const { return handle; }
+
+        Node* get_parent() const { return parent; }
+        ChildRange get_children() const { return ChildRange{first_child}; }
+        bool has_children() const { return first_child != nullptr; }
+    private:
+        // O(1), keeps the order of the remaining siblings
+        void detach_from_parent();
+        void append_child(Node* child);
+        // Clears instance_root on the nodes of the instance at root in this subtree
+        void leave_instance(NodeHandle root);
     private:  
         SceneGraph& scene;
+        TransformHierarchy& transforms;
+        TransformHandle transform;
+        NodeHandle handle{};
+        uint64_t component_mask{}; // Bit per components::ComponentTypes entry
+        std::array<components::IComponent*, components::COMPONENT_TYPE_COUNT> component_slots{}; // First component of each type
+        Node* parent = nullptr;
+        Node* first_child = nullptr;
+        Node* last_child = nullptr;
+        Node* prev_sibling = nullptr;
+        Node* next_sibling = nullptr;
+        std::unique_ptr<ModelInstance> model_instance{};
+        NodeHandle instance_root{}; // Root of the model instance that created this node, invalid once moved out of it
     public:
-        uint64_t id;
         std::string name;
         std::vector<components::IComponent*> component_ptrs;
 
-        Node* parent = nullptr;
-        std::vector<Node*> children{};
-
-        glm::vec3 position{0.0f, 0.0f, 0.0f};
-        glm::vec3 scale{1.0f, 1.0f, 1.0f};
-        glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
-        glm::mat4x4 global_transform{0.0f};
-    
         //Animation
         glm::mat4x4 inverse_bind_transform{1.0};
         uint32_t bone_id{};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace gage::scene::file
+{
+    // Binary scene written by SceneGraph::save_binary and memory mapped by SceneGraph::load_binary.
+    // Layout: SceneHeader | SceneNode[node_count] | SceneComponent[component_count] | strings | component blobs.
+    // Nodes are in pre order so a parent always comes before its children. Strings are null terminated and
+    // referenced by their offset into the string table, offset 0 is the empty string.
+    // Component blobs are the CBOR encoding of IComponent::to_json().
+    static constexpr char MAGIC[4] = {'G', 'S', 'C', 'N'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+    struct SceneHeader
+    {
+        char magic[4]{};
+        uint32_t version{};
+        uint32_t node_count{};
+        uint32_t component_count{};
+        uint64_t nodes_offset{};
+        uint64_t components_offset{};
+        uint64_t strings_offset{};
+        uint64_t strings_size{};
+        uint64_t blobs_offset{};
+        uint64_t blobs_size{};
+    };
+
+    struct SceneNode
+    {
+        uint32_t parent{NO_INDEX}; // Index into the node table, NO_INDEX for children of the scene root
+        uint32_t name{};           // String offset
+        uint32_t model_instance{NO_INDEX}; // String offset of the model name if the node is the root of a model instance
+        uint32_t bone_id{};
+        float position[3]{};
+        float scale[3]{};
+        float rotation[4]{}; // x, y, z, w
+        float inverse_bind_transform[16]{}; // Column major
+        uint32_t first_component{};
+        uint32_t component_count{};
+    };
+
+    struct SceneComponent
+    {
+        uint32_t type{}; // components::ComponentTypeId, adding a component type to the list bumps VERSION
+        uint32_t blob_size{};
+        uint64_t blob_offset{}; // Relative to blobs_offset
+    };
+
+    static_assert(std::is_trivially_copyable_v<SceneHeader> && sizeof(SceneHeader) == 64);
+    static_assert(std::is_trivially_copyable_v<SceneNode> && sizeof(SceneNode) == 128);
+    static_assert(std::is_trivially_copyable_v<SceneComponent> && sizeof(SceneComponent) == 16);
+}
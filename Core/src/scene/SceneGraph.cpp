@@ -2,13 +2,22 @@
 #include "SceneGraph.hpp"
 
 #include "scene.hpp"
+#include "ModelInstance.hpp"
+#include "SceneFile.hpp"
+#include "data/ModelFile.hpp"
 
 #include "components/MeshRenderer.hpp"
 #include "components/Animator.hpp"
 #include "components/RigidBody.hpp"
 #include "components/CharacterController.hpp"
+#include "components/Terrain.hpp"
+#include "components/Map.hpp"
 
 #include <Core/src/gfx/Graphics.hpp>
+#include <Core/src/gfx/data/UploadBatch.hpp>
+#include <Core/src/utils/JobSystem.hpp>
+#include <Core/src/utils/MappedFile.hpp>
+#include <glm/gtc/type_ptr.hpp>
 #include <imgui/imgui.h>
 
 #include <Core/src/mem.hpp>
@@ -70,21 +79,35 @@ namespace tinygltf
 
 namespace gage::scene
 {
-    SceneGraph::SceneGraph(const gfx::Graphics &gfx, gfx::data::Camera &camera) : 
+    SceneGraph::SceneGraph(const gfx::Graphics &gfx, gfx::data::Camera &camera, utils::JobSystem &job_system) : 
         gfx(gfx),
-        renderer(gfx),
-        terrain_renderer(gfx, camera),
-        map_renderer(gfx),
-        physics()
+        job_system(job_system),
+        assets(gfx, job_system),
+        renderer(gfx, camera),
+        terrain_renderer(gfx, camera, assets),
+        map_renderer(gfx, assets),
+        physics(assets, job_system)
     {
+        MemoryTagScope memory_tag(MemoryTag::SCENE);
+
         // Create root node
-        auto node = std::make_unique<Node>(*this, id++);
-        node->name = ROOT_NAME;
-        this->root_node = node.get();
-        nodes.push_back(std::move(node));
+        uint32_t slot = nodes.emplace(*this, transforms);
+        this->root_node = &nodes.at(slot);
+        root_node->name = ROOT_NAME;
+        root_node->handle = NodeHandle{slot, nodes.get_generation(slot)};
+
+        register_component_routes();
+        register_system_tasks();
+        import_group = job_system.create_group();
     }
     SceneGraph::~SceneGraph()
     {
+        // Waits for the parse jobs and uploads still in flight
+        job_system.run(import_group);
+        job_system.wait(import_group);
+        pending_instances.clear();
+        pending_imports.clear();
+
         generic.shutdown();
         renderer.shutdown();
         terrain_renderer.shutdown();
@@ -98,61 +121,715 @@ namespace gage::scene
         std::ofstream file(file_path);
         if (file.is_open())
         {
-            file << nodes.at(0).get()->to_json().dump(2);
+            file << root_node->to_json().dump(2);
             file.close();
         }
     }
 
+    void SceneGraph::load(const std::string &file_path)
+    {
+        MemoryTagScope memory_tag(MemoryTag::SCENE);
+        log().info("Loading scene: {}", file_path);
+
+        std::ifstream file(file_path);
+        if (!file.is_open())
+        {
+            log().critical("Failed to open scene: {}", file_path);
+            throw SceneException{"Failed to open scene: " + file_path};
+        }
+
+        try
+        {
+            nlohmann::json scene_json = nlohmann::json::parse(file);
+
+            // Components are added once every node exists, children first so an animator finds the
+            // mesh renderers below it even when the scene is already initialized
+            std::vector<std::pair<Node *, const nlohmann::json *>> loaded_nodes{};
+            std::function<void(Node * parent, const nlohmann::json &j)> load_node_recursive;
+            load_node_recursive = [&](Node *parent, const nlohmann::json &j)
+            {
+                Node *node = create_node();
+                if (parent)
+                    make_parent(parent, node);
+
+                node->name = j.value("name", "");
+                node->set_position({j.at("transform_pos_x").get<float>(), j.at("transform_pos_y").get<float>(), j.at("transform_pos_z").get<float>()});
+                node->set_scale({j.at("transform_scale_x").get<float>(), j.at("transform_scale_y").get<float>(), j.at("transform_scale_z").get<float>()});
+                node->set_rotation(glm::quat{j.at("transform_rotateion_w").get<float>(), j.at("transform_rotateion_x").get<float>(),
+                                             j.at("transform_rotateion_y").get<float>(), j.at("transform_rotateion_z").get<float>()});
+                node->bone_id = j.at("bone_id").get<uint32_t>();
+                const nlohmann::json &inverse_bind_matrix = j.at("inverse_bind_transform");
+                for (uint32_t i = 0; i < 4; i++)
+                {
+                    for (uint32_t k = 0; k < 4; k++)
+                    {
+                        node->inverse_bind_transform[i][k] = inverse_bind_matrix.at(i + 4 * k).get<float>();
+                    }
+                }
+                loaded_nodes.push_back({node, &j});
+
+                if (j.contains("children"))
+                {
+                    for (const auto &child : j["children"])
+                    {
+                        load_node_recursive(node, child);
+                    }
+                }
+            };
+
+            if (scene_json.contains("children"))
+            {
+                for (const auto &child : scene_json["children"])
+                {
+                    load_node_recursive(nullptr, child);
+                }
+            }
+
+            for (auto it = loaded_nodes.rbegin(); it != loaded_nodes.rend(); it++)
+            {
+                auto [node, j] = *it;
+                if (j->contains("model_instance"))
+                {
+                    load_model_instance(node, (*j)["model_instance"].get<std::string>());
+                }
+                if (j->contains("components"))
+                {
+                    for (const auto &component : (*j)["components"])
+                    {
+                        // Components that saved nothing
+                        if (component.is_null())
+                            continue;
+                        load_component(node, get_component_type_id(component.at("type").get<std::string>()), component);
+                    }
+                }
+            }
+        }
+        catch (const nlohmann::json::exception &e)
+        {
+            log().critical("Failed to load scene: {} | {}", file_path, e.what());
+            throw SceneException{"Failed to load scene: " + file_path + "| " + e.what()};
+        }
+    }
+
+    void SceneGraph::save_binary(const std::string &file_path)
+    {
+        std::vector<file::SceneNode> file_nodes{};
+        std::vector<file::SceneComponent> file_components{};
+        std::vector<uint8_t> blobs{};
+        std::string strings(1, '\0');
+        std::unordered_map<std::string, uint32_t> string_offsets{};
+
+        auto add_string = [&](const std::string &string) -> uint32_t
+        {
+            if (string.empty())
+                return 0;
+            auto [it, inserted] = string_offsets.try_emplace(string, (uint32_t)strings.size());
+            if (inserted)
+            {
+                strings.append(string);
+                strings.push_back('\0');
+            }
+            return it->second;
+        };
+
+        // Pre order, parents are written before their children
+        std::function<void(const Node *node, uint32_t parent)> save_node_recursive;
+        save_node_recursive = [&](const Node *node, uint32_t parent)
+        {
+            file::SceneNode file_node{};
+            file_node.parent = parent;
+            file_node.name = add_string(node->name);
+            file_node.model_instance = node->model_instance ? add_string(node->model_instance->model.name) : file::NO_INDEX;
+            file_node.bone_id = node->bone_id;
+            std::memcpy(file_node.position, glm::value_ptr(node->get_position()), sizeof(file_node.position));
+            std::memcpy(file_node.scale, glm::value_ptr(node->get_scale()), sizeof(file_node.scale));
+            std::memcpy(file_node.rotation, glm::value_ptr(node->get_rotation()), sizeof(file_node.rotation));
+            std::memcpy(file_node.inverse_bind_transform, glm::value_ptr(node->inverse_bind_transform), sizeof(file_node.inverse_bind_transform));
+            file_node.first_component = file_components.size();
+            file_node.component_count = node->component_ptrs.size();
+            for (const components::IComponent *component : node->component_ptrs)
+            {
+                std::vector<uint8_t> blob = nlohmann::json::to_cbor(component->to_json());
+                file_components.push_back({.type = component->get_type_id(), .blob_size = (uint32_t)blob.size(), .blob_offset = blobs.size()});
+                blobs.insert(blobs.end(), blob.begin(), blob.end());
+            }
+
+            uint32_t index = file_nodes.size();
+            file_nodes.push_back(file_node);
+            for (const Node *child : node->get_children())
+            {
+                save_node_recursive(child, index);
+            }
+        };
+        for (const Node *child : root_node->get_children())
+        {
+            save_node_recursive(child, file::NO_INDEX);
+        }
+
+        file::SceneHeader header{};
+        std::memcpy(header.magic, file::MAGIC, sizeof(header.magic));
+        header.version = file::VERSION;
+        header.node_count = file_nodes.size();
+        header.component_count = file_components.size();
+        header.nodes_offset = sizeof(file::SceneHeader);
+        header.components_offset = header.nodes_offset + file_nodes.size() * sizeof(file::SceneNode);
+        header.strings_offset = header.components_offset + file_components.size() * sizeof(file::SceneComponent);
+        header.strings_size = strings.size();
+        header.blobs_offset = header.strings_offset + header.strings_size;
+        header.blobs_size = blobs.size();
+
+        std::ofstream stream(file_path, std::ios::binary);
+        if (!stream.is_open())
+        {
+            log().critical("Failed to open scene for writing: {}", file_path);
+            throw SceneException{"Failed to open scene for writing: " + file_path};
+        }
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char *>(file_nodes.data()), file_nodes.size() * sizeof(file::SceneNode));
+        stream.write(reinterpret_cast<const char *>(file_components.data()), file_components.size() * sizeof(file::SceneComponent));
+        stream.write(strings.data(), strings.size());
+        stream.write(reinterpret_cast<const char *>(blobs.data()), blobs.size());
+    }
+
+    void SceneGraph::load_binary(const std::string &file_path)
+    {
+        MemoryTagScope memory_tag(MemoryTag::SCENE);
+        log().info("Loading binary scene: {}", file_path);
+
+        utils::MappedFile mapped_file(file_path);
+        const unsigned char *data = mapped_file.get_data();
+        uint64_t size = mapped_file.get_size();
+
+        auto fail = [&file_path](const char *reason)
+        {
+            log().critical("Invalid binary scene: {} | {}", file_path, reason);
+            throw SceneException{"Invalid binary scene: " + file_path + "| " + reason};
+        };
+        auto check_range = [&](uint64_t offset, uint64_t count, uint64_t element_size, size_t alignment)
+        {
+            if (offset > size || count > (size - offset) / element_size || offset % alignment != 0)
+                fail("Table out of range");
+        };
+
+        if (size < sizeof(file::SceneHeader))
+            fail("File too small");
+        file::SceneHeader header{};
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, file::MAGIC, sizeof(header.magic)) != 0)
+            fail("Not a scene file");
+        if (header.version != file::VERSION)
+            fail("Unsupported version");
+        check_range(header.nodes_offset, header.node_count, sizeof(file::SceneNode), alignof(file::SceneNode));
+        check_range(header.components_offset, header.component_count, sizeof(file::SceneComponent), alignof(file::SceneComponent));
+        check_range(header.strings_offset, header.strings_size, 1, 1);
+        check_range(header.blobs_offset, header.blobs_size, 1, 1);
+        if (header.strings_size == 0 || data[header.strings_offset + header.strings_size - 1] != '\0')
+            fail("String table is not terminated");
+
+        // The mapping is page aligned and the tables are at aligned offsets, they are read in place
+        const auto *file_nodes = reinterpret_cast<const file::SceneNode *>(data + header.nodes_offset);
+        const auto *file_components = reinterpret_cast<const file::SceneComponent *>(data + header.components_offset);
+        const char *strings = reinterpret_cast<const char *>(data + header.strings_offset);
+        const unsigned char *blobs = data + header.blobs_offset;
+
+        auto get_string = [&](uint32_t offset) -> const char *
+        {
+            if (offset >= header.strings_size)
+                fail("String out of range");
+            return strings + offset;
+        };
+
+        std::vector<Node *> loaded_nodes(header.node_count);
+        for (uint32_t i = 0; i < header.node_count; i++)
+        {
+            const file::SceneNode &file_node = file_nodes[i];
+            if (file_node.parent != file::NO_INDEX && file_node.parent >= i)
+                fail("Parent does not come before its child");
+            if (file_node.first_component > header.component_count || file_node.component_count > header.component_count - file_node.first_component)
+                fail("Components out of range");
+
+            Node *node = create_node();
+            if (file_node.parent != file::NO_INDEX)
+                make_parent(loaded_nodes[file_node.parent], node);
+
+            node->name = get_string(file_node.name);
+            node->set_position(glm::make_vec3(file_node.position));
+            node->set_scale(glm::make_vec3(file_node.scale));
+            node->set_rotation(glm::make_quat(file_node.rotation));
+            node->bone_id = file_node.bone_id;
+            node->inverse_bind_transform = glm::make_mat4x4(file_node.inverse_bind_transform);
+            loaded_nodes[i] = node;
+        }
+
+        // Children first, see load()
+        for (uint32_t i = header.node_count; i > 0; i--)
+        {
+            const file::SceneNode &file_node = file_nodes[i - 1];
+            Node *node = loaded_nodes[i - 1];
+            if (file_node.model_instance != file::NO_INDEX)
+            {
+                load_model_instance(node, get_string(file_node.model_instance));
+            }
+
+            for (uint32_t c = file_node.first_component; c < file_node.first_component + file_node.component_count; c++)
+            {
+                const file::SceneComponent &file_component = file_components[c];
+                if (file_component.blob_offset > header.blobs_size || file_component.blob_size > header.blobs_size - file_component.blob_offset)
+                    fail("Component blob out of range");
+
+                const unsigned char *blob = blobs + file_component.blob_offset;
+                nlohmann::json j = nlohmann::json::from_cbor(blob, blob + file_component.blob_size, true, false);
+                if (j.is_discarded())
+                    fail("Component blob is not valid CBOR");
+                try
+                {
+                    load_component(node, file_component.type, j);
+                }
+                catch (const nlohmann::json::exception &e)
+                {
+                    fail(e.what());
+                }
+            }
+        }
+    }
+
+    void SceneGraph::register_script(const std::string &name, ScriptFactory factory)
+    {
+        script_factories[name] = std::move(factory);
+    }
+
+    const data::Model &SceneGraph::find_or_import_model(const std::string &file_path)
+    {
+        std::filesystem::path extension = std::filesystem::path(file_path).extension();
+        if (extension == data::file::EXTENSION)
+            return import_model(file_path, data::ModelImportMode::Cooked);
+        bool binary = extension == ".glb";
+        return import_model(file_path, binary ? data::ModelImportMode::Binary : data::ModelImportMode::ASCII);
+    }
+
+    std::unique_ptr<data::Model> SceneGraph::load_model(const std::string &file_path, data::ModelImportMode mode)
+    {
+        if (mode == data::ModelImportMode::Cooked)
+            return std::make_unique<data::Model>(file_path, file_path);
+
+        std::filesystem::path cooked_path = std::filesystem::path(file_path).replace_extension(data::file::EXTENSION);
+        std::error_code cooked_error{};
+        std::error_code source_error{};
+        std::filesystem::file_time_type cooked_time = std::filesystem::last_write_time(cooked_path, cooked_error);
+        std::filesystem::file_time_type source_time = std::filesystem::last_write_time(file_path, source_error);
+        if (!cooked_error && !source_error && cooked_time >= source_time)
+        {
+            // A sibling cooked by an older version of the format is skipped, the source is still there
+            try
+            {
+                return std::make_unique<data::Model>(file_path, cooked_path.string());
+            }
+            catch (const SceneException &)
+            {
+                log().warn("Ignoring cooked model: {}, importing {}", cooked_path.string(), file_path);
+            }
+        }
+
+        return std::make_unique<data::Model>(job_system, file_path, assets.get_gltf(file_path, mode));
+    }
+
+    void SceneGraph::load_component(Node *node, components::ComponentTypeId type, const nlohmann::json &j)
+    {
+        if (type >= component_routes.size() || !component_routes[type].load)
+        {
+            log().critical("Component type {} can not be loaded", type);
+            throw SceneException{};
+        }
+        component_routes[type].load(node, j);
+    }
+
+    components::ComponentTypeId SceneGraph::get_component_type_id(const std::string &name) const
+    {
+        for (components::ComponentTypeId type = 0; type < component_routes.size(); type++)
+        {
+            if (component_routes[type].name && name == component_routes[type].name)
+                return type;
+        }
+        log().critical("Unknown component type: {}", name);
+        throw SceneException{};
+    }
+
+    // Bone ids of an instance are its model node indices, the first node in pre order wins like in instanciate_model
+    void SceneGraph::load_model_instance(Node *root, const std::string &model_name)
+    {
+        const data::Model &model = find_or_import_model(model_name);
+        auto instance = std::make_unique<ModelInstance>(model);
+        instance->nodes.resize(model.nodes.size());
+
+        // Children are loaded first, nested instances already own their nodes
+        std::function<void(Node * node)> index_node_recursive;
+        index_node_recursive = [&](Node *node)
+        {
+            if (node != root && node->model_instance)
+                return;
+
+            node->instance_root = root->get_handle();
+            if (node->bone_id < instance->nodes.size() && instance->nodes[node->bone_id].index == NodeHandle::INVALID_INDEX)
+            {
+                instance->nodes[node->bone_id] = node->get_handle();
+            }
+            for (Node *child : node->get_children())
+            {
+                index_node_recursive(child);
+            }
+        };
+        index_node_recursive(root);
+        root->model_instance = std::move(instance);
+    }
+
     void SceneGraph::init()
     {
+        MemoryTagScope memory_tag(MemoryTag::SCENE);
         renderer.init();
         terrain_renderer.init();
         map_renderer.init();
-        animation.init();
+        animation.init(job_system.get_frame_arena());
         physics.init();
         generic.init();
+        initialized = true;
+
+        // Systems share what they loaded while initializing, whatever they did not keep goes now
+        assets.release_unused();
     }
 
-    void SceneGraph::build_node_transform()
+    void SceneGraph::register_system_tasks()
     {
-        std::function<void(Node * node, glm::mat4x4 accumulated_transform)> traverse_scene_graph_recursive;
-        traverse_scene_graph_recursive = [&](scene::Node *node, glm::mat4x4 accumulated_transform)
-        {
-            // Build node global transform
-            accumulated_transform = glm::translate(accumulated_transform, node->position);
-            accumulated_transform = glm::scale(accumulated_transform, node->scale);
-            accumulated_transform *= glm::mat4x4(node->rotation);
-            node->global_transform = accumulated_transform;
+        add_task({.name = "physics.step",
+                  .stage = TaskStage::UPDATE,
+                  .reads = TaskResources::NONE,
+                  .writes = TaskResources::PHYSICS_BODIES,
+                  .function = [this](const TickContext &context)
+                  { physics.step(context.delta); }});
+
+        add_task({.name = "physics.sync_transforms",
+                  .stage = TaskStage::UPDATE,
+                  .reads = TaskResources::NONE,
+                  .writes = TaskResources::PHYSICS_BODIES | TaskResources::TRANSFORMS,
+                  .dependencies = {"physics.step"},
+                  .function = [this](const TickContext &)
+                  { physics.sync_transforms(); }});
+
+        // Registered after the physics sync, both write transforms and animation has the last word on a node like before
+        add_task({.name = "animation.update",
+                  .stage = TaskStage::UPDATE,
+                  .reads = TaskResources::NONE,
+                  .writes = TaskResources::TRANSFORMS | TaskResources::ANIMATORS | TaskResources::BONE_PALETTES,
+                  .function = [this](const TickContext &context)
+                  { animation.update(context.delta); }});
+
+        // Scripts can touch anything, so no other task of the tick runs next to them.
+        // They still run on whichever worker picks the task up, see components::Script
+        add_task({.name = "generic.update",
+                  .stage = TaskStage::UPDATE,
+                  .reads = TaskResources::ALL,
+                  .writes = TaskResources::ALL,
+                  .function = [this](const TickContext &context)
+                  { generic.update(context.delta, context.keyboard, context.mouse); }});
 
-            for (const auto &child : node->children)
+        add_task({.name = "scene.build_node_transform",
+                  .stage = TaskStage::TRANSFORM,
+                  .reads = TaskResources::NONE,
+                  .writes = TaskResources::TRANSFORMS,
+                  .function = [this](const TickContext &)
+                  { build_node_transform(); }});
+
+        add_task({.name = "generic.late_update",
+                  .stage = TaskStage::LATE_UPDATE,
+                  .reads = TaskResources::ALL,
+                  .writes = TaskResources::ALL,
+                  .function = [this](const TickContext &context)
+                  { generic.late_update(context.delta, context.keyboard, context.mouse); }});
+
+        add_task({.name = "animation.late_update",
+                  .stage = TaskStage::LATE_UPDATE,
+                  .reads = TaskResources::TRANSFORMS | TaskResources::ANIMATORS,
+                  .writes = TaskResources::BONE_PALETTES,
+                  .function = [this](const TickContext &context)
+                  { animation.late_update(context.delta); }});
+    }
+
+    void SceneGraph::add_task(TaskDesc desc)
+    {
+        task_graph.add_task(std::move(desc));
+    }
+
+    void SceneGraph::tick(float delta, const hid::Keyboard &keyboard, const hid::Mouse &mouse)
+    {
+        TickContext context{
+            .delta = delta,
+            .keyboard = keyboard,
+            .mouse = mouse,
+        };
+        update_imports();
+        task_graph.execute(job_system, context);
+        destroy_pending_nodes();
+        assets.release_unused();
+    }
+
+    void SceneGraph::render_depth(VkCommandBuffer cmd)
+    {
+        const auto &g_buffer = gfx.geometry_buffer;
+        record_secondary_cmds(cmd, g_buffer.get_shadowpass_render_pass(), g_buffer.get_shadowpass_framebuffer(), true);
+    }
+
+    void SceneGraph::render(VkCommandBuffer cmd)
+    {
+        const auto &g_buffer = gfx.geometry_buffer;
+        record_secondary_cmds(cmd, g_buffer.get_mainpass_render_pass(), g_buffer.get_mainpass_framebuffer(), false);
+    }
+
+    void SceneGraph::record_secondary_cmds(VkCommandBuffer cmd, VkRenderPass render_pass, VkFramebuffer framebuffer, bool depth)
+    {
+        const auto &frame_data = gfx.frame_datas[gfx.frame_index];
+
+        // Mesh renderers are split into chunks, terrain and map renderer get one command buffer each
+        uint32_t mesh_renderer_count = renderer.get_mesh_renderer_count();
+        uint32_t mesh_renderers_per_cmd = std::max(MIN_MESH_RENDERERS_PER_CMD, (mesh_renderer_count + MAX_MESH_RENDERER_CMDS - 1) / MAX_MESH_RENDERER_CMDS);
+        uint32_t mesh_renderer_cmd_count = (mesh_renderer_count + mesh_renderers_per_cmd - 1) / mesh_renderers_per_cmd;
+        uint32_t terrain_cmd_index = mesh_renderer_cmd_count;
+        uint32_t map_cmd_index = mesh_renderer_cmd_count + 1;
+        uint32_t cmd_count = mesh_renderer_cmd_count + 2;
+
+        std::array<VkCommandBuffer, MAX_MESH_RENDERER_CMDS + 2> secondary_cmds{};
+        job_system.parallel_for(cmd_count, 1, [&](uint32_t begin, uint32_t end)
+        {
+            MemoryTagScope memory_tag(MemoryTag::GFX);
+            for (uint32_t i = begin; i < end; i++)
             {
-                traverse_scene_graph_recursive(child, accumulated_transform);
+                VkCommandBuffer secondary_cmd = frame_data.begin_secondary_cmd(utils::JobSystem::get_worker_index(), render_pass, framebuffer);
+                if (i == terrain_cmd_index)
+                {
+                    depth ? terrain_renderer.render_depth(secondary_cmd) : terrain_renderer.render(secondary_cmd);
+                }
+                else if (i == map_cmd_index)
+                {
+                    depth ? map_renderer.render_depth(secondary_cmd) : map_renderer.render(secondary_cmd);
+                }
+                else
+                {
+                    uint32_t first = i * mesh_renderers_per_cmd;
+                    uint32_t count = std::min(mesh_renderers_per_cmd, mesh_renderer_count - first);
+                    depth ? renderer.render_depth(secondary_cmd, first, count) : renderer.render(secondary_cmd, first, count);
+                }
+                vk_check(vkEndCommandBuffer(secondary_cmd));
+                secondary_cmds[i] = secondary_cmd;
             }
-        };
+        });
 
-        traverse_scene_graph_recursive(nodes.at(0).get(), glm::mat4x4(1.0f));
+        // Executed in a fixed order regardless of which worker recorded what
+        vkCmdExecuteCommands(cmd, cmd_count, secondary_cmds.data());
+    }
+
+    void SceneGraph::build_node_transform()
+    {
+        transforms.update(job_system);
+    }
+
+    const data::Model *SceneGraph::find_model(const std::string &file_path) const
+    {
+        for (const auto &model : models)
+        {
+            if (model->name == file_path)
+                return model.get();
+        }
+        return nullptr;
     }
 
     const data::Model &SceneGraph::import_model(const std::string &file_path, data::ModelImportMode mode)
     {
-        std::unique_ptr<data::Model> new_model = std::make_unique<data::Model>(gfx, renderer, file_path, mode);
+        const data::Model *existing = find_model(file_path);
+        if (existing)
+            return *existing;
+
+        MemoryTagScope memory_tag(MemoryTag::ASSETS);
+        std::unique_ptr<data::Model> new_model = load_model(file_path, mode);
+        gfx::data::UploadBatch batch(gfx);
+        new_model->upload(gfx, renderer, batch);
+        batch.submit();
+        batch.wait();
+        new_model->release_import_data();
         auto model_ptr = new_model.get();
         models.push_back(std::move(new_model));
         return *model_ptr;
     }
 
+    SceneGraph::ModelFuture SceneGraph::import_model_async(const std::string &file_path, data::ModelImportMode mode)
+    {
+        MemoryTagScope memory_tag(MemoryTag::ASSETS);
+        const data::Model *existing = find_model(file_path);
+        if (existing)
+        {
+            std::promise<const data::Model *> ready{};
+            ready.set_value(existing);
+            return ready.get_future().share();
+        }
+        for (const PendingImport &pending : pending_imports)
+        {
+            if (pending.file_path == file_path)
+                return pending.future;
+        }
+
+        PendingImport &import = pending_imports.emplace_back();
+        import.file_path = file_path;
+        import.future = import.promise.get_future().share();
+        // A background job, the main thread never picks it up while it helps out waiting for a frame
+        auto parse = std::make_shared<std::packaged_task<std::unique_ptr<data::Model>()>>([this, file_path, mode]()
+        {
+            return load_model(file_path, mode);
+        });
+        import.parsed = parse->get_future();
+        job_system.run_background(job_system.create_child_job(import_group, [parse]()
+        {
+            FrameBudgetExclusionScope budget_exclusion;
+            MemoryTagScope memory_tag(MemoryTag::ASSETS);
+            (*parse)();
+        }));
+        return import.future;
+    }
+
+    Node *SceneGraph::instanciate_model_async(ModelFuture model, glm::vec3 initial_position, const data::Model *placeholder, std::function<void(Node *instance)> on_ready)
+    {
+        MemoryTagScope memory_tag(MemoryTag::SCENE);
+        Node *parent = create_node();
+        parent->name = "Loading model";
+        parent->set_position(initial_position);
+
+        PendingInstance &instance = pending_instances.emplace_back();
+        instance.model = std::move(model);
+        instance.parent = parent->get_handle();
+        instance.on_ready = std::move(on_ready);
+        if (placeholder)
+        {
+            Node *placeholder_node = instanciate_model(*placeholder, glm::vec3{0.0f});
+            make_parent(parent, placeholder_node);
+            instance.placeholder = placeholder_node->get_handle();
+        }
+        return parent;
+    }
+
+    void SceneGraph::update_imports()
+    {
+        MemoryTagScope memory_tag(MemoryTag::ASSETS);
+
+        // Recording copies every vertex and texel into staging memory, one model per call keeps that bounded
+        bool upload_started = false;
+        for (auto it = pending_imports.begin(); it != pending_imports.end();)
+        {
+            PendingImport &import = *it;
+            if (!import.batch)
+            {
+                if (upload_started || import.parsed.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                {
+                    it++;
+                    continue;
+                }
+
+                try
+                {
+                    import.model = import.parsed.get();
+                }
+                catch (...)
+                {
+                    log().critical("Failed to import model asynchronously: {}", import.file_path);
+                    import.promise.set_exception(std::current_exception());
+                    it = pending_imports.erase(it);
+                    continue;
+                }
+
+                import.batch = std::make_unique<gfx::data::UploadBatch>(gfx);
+                import.model->upload(gfx, renderer, *import.batch);
+                import.batch->submit();
+                upload_started = true;
+                log().trace("Uploading model: {}, staging bytes: {}", import.file_path, import.batch->get_staging_bytes());
+                it++;
+                continue;
+            }
+
+            if (!import.batch->is_complete())
+            {
+                it++;
+                continue;
+            }
+
+            import.batch.reset();
+            import.model->release_import_data();
+            const data::Model *model = import.model.get();
+            models.push_back(std::move(import.model));
+            import.promise.set_value(model);
+            log().info("Model ready: {}", import.file_path);
+            it = pending_imports.erase(it);
+        }
+
+        // on_ready can queue more instances, take the ready ones out first
+        utils::ArenaVector<PendingInstance> ready_instances(job_system.get_frame_arena());
+        for (auto it = pending_instances.begin(); it != pending_instances.end();)
+        {
+            if (it->model.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                it++;
+                continue;
+            }
+            ready_instances.push_back(std::move(*it));
+            it = pending_instances.erase(it);
+        }
+
+        for (PendingInstance &pending : ready_instances)
+        {
+            // Dropped if the parent was destroyed in the meantime, the placeholder stays if the import failed
+            Node *parent = get_node(pending.parent);
+            if (!parent)
+                continue;
+
+            const data::Model *model = nullptr;
+            try
+            {
+                model = pending.model.get();
+            }
+            catch (...)
+            {
+                continue;
+            }
+
+            Node *placeholder = get_node(pending.placeholder);
+            if (placeholder)
+                destroy_node_immediate(placeholder);
+
+            Node *instance = instanciate_model(*model, glm::vec3{0.0f});
+            make_parent(parent, instance);
+            parent->name = model->name;
+            if (pending.on_ready)
+                pending.on_ready(instance);
+        }
+    }
+
     Node *SceneGraph::instanciate_model(const data::Model &model, glm::vec3 initial_position)
     {
+        MemoryTagScope memory_tag(MemoryTag::SCENE);
         log().info("Instanciating model: {}", model.name);
 
-        std::function<Node *(const data::Model &model, const data::ModelNode &model_node)> instanciate_node_recursive;
-        instanciate_node_recursive = [&](const data::Model &model, const data::ModelNode &model_node) -> Node *
+        auto instance = std::make_unique<ModelInstance>(model);
+        instance->nodes.resize(model.nodes.size());
+        NodeHandle instance_root{};
+
+        std::function<Node *(const data::Model &model, uint32_t model_node_index)> instanciate_node_recursive;
+        instanciate_node_recursive = [&](const data::Model &model, uint32_t model_node_index) -> Node *
         {
+            const data::ModelNode &model_node = model.nodes.at(model_node_index);
             Node *new_node = create_node();
+            instance->nodes[model_node_index] = new_node->get_handle();
+            // The root is created first
+            if (instance_root.index == NodeHandle::INVALID_INDEX)
+                instance_root = new_node->get_handle();
+            new_node->instance_root = instance_root;
             new_node->name = model_node.name;
-            new_node->position = model_node.position;
-            new_node->rotation = model_node.rotation;
-            new_node->scale = model_node.scale;
+            new_node->set_position(model_node.position);
+            new_node->set_rotation(model_node.rotation);
+            new_node->set_scale(model_node.scale);
             new_node->inverse_bind_transform = model_node.inverse_bind_transform;
             new_node->bone_id = model_node.bone_id;
 
@@ -163,20 +840,21 @@ namespace gage::scene
                 {
                     joints = &model.skins.at(model_node.skin_index);
                 }
-                add_component(new_node, std::make_unique<components::MeshRenderer>(*this, *new_node, gfx, model, model.meshes.at(model_node.mesh_index), joints));
+                add_component<components::MeshRenderer>(new_node, gfx, model, model.meshes.at(model_node.mesh_index), joints);
             }
 
             for (const uint32_t &node : model_node.children)
             {
-                Node *child = instanciate_node_recursive(model, model.nodes.at(node));
+                Node *child = instanciate_node_recursive(model, node);
                 make_parent(new_node, child);
             }
 
             return new_node;
         };
 
-        Node *new_node = instanciate_node_recursive(model, model.nodes.at(model.root_node));
-        new_node->position += initial_position;
+        Node *new_node = instanciate_node_recursive(model, model.root_node);
+        new_node->set_position(new_node->get_position() + initial_position);
+        new_node->model_instance = std::move(instance);
 
         return new_node;
     }
@@ -184,126 +862,279 @@ namespace gage::scene
     // Every node created will be the child of the root node
     Node *SceneGraph::create_node()
     {
-        auto node = std::make_unique<Node>(*this, id++);
-        auto node_ptr = node.get();
+        MemoryTagScope memory_tag(MemoryTag::SCENE);
+        uint32_t slot = nodes.emplace(*this, transforms);
+        Node *node_ptr = &nodes.at(slot);
+        node_ptr->handle = NodeHandle{slot, nodes.get_generation(slot)};
 
-        auto root_node = nodes.at(0).get();
-        node_ptr->parent = root_node;
-        root_node->children.push_back(node_ptr);
-
-        nodes.push_back(std::move(node));
+        root_node->append_child(node_ptr);
+        transforms.set_parent(node_ptr->transform, root_node->transform);
 
         return node_ptr;
     }
 
-    void SceneGraph::make_parent(Node *parent, Node *child)
+    void SceneGraph::destroy_node(Node *node)
     {
-        // Make sure to delete current child in the prev child's parent
-        auto child_parent = child->parent;
-        // get rid of children
-        child_parent->children.erase(std::remove_if(child_parent->children.begin(), child_parent->children.end(),
-                                                    [&child](const Node *node)
-                                                    { return node == child; }));
-
-        parent->children.push_back(child);
-        child->parent = parent;
+        std::lock_guard<std::mutex> lock(pending_destroy_mutex);
+        pending_destroys.push_back(node->handle);
     }
 
-    void* SceneGraph::add_component(Node *node, std::unique_ptr<components::IComponent> component)
+    void SceneGraph::destroy_pending_nodes()
     {
-        // Release the ptr
-        components::IComponent *ptr = component.release();
-        node->add_component_ptr(ptr);
-
-        if (std::strcmp(ptr->get_name(), "MeshRenderer") == 0) // Renderer will own this component
         {
-            renderer.add_pbr_mesh_renderer(std::unique_ptr<components::MeshRenderer>(static_cast<components::MeshRenderer *>(ptr)));
+            std::lock_guard<std::mutex> lock(pending_destroy_mutex);
+            destroying.swap(pending_destroys);
         }
-        else if (std::strcmp(ptr->get_name(), "Terrain") == 0) // Terrain will be shared with physics and terrain
-        {
-            auto terrain = std::shared_ptr<components::Terrain>(static_cast<components::Terrain *>(ptr));
-            terrain_renderer.add_terrain(terrain);
-            physics.add_terrain_renderer(terrain);
-        }
-        else if (std::strcmp(ptr->get_name(), "Animator") == 0) // Animator will owned by Animation
+
+        MemoryTagScope memory_tag(MemoryTag::SCENE);
+        for (NodeHandle handle : destroying)
         {
-            animation.add_animator(std::unique_ptr<components::Animator>(static_cast<components::Animator *>(ptr)));
+            // Already gone if an ancestor was queued too
+            Node *node = get_node(handle);
+            if (node)
+                destroy_node_immediate(node);
         }
-        else if (std::strcmp(ptr->get_name(), "CharacterController") == 0) // CharacterController will be owned by physics
+        destroying.clear();
+    }
+
+    void SceneGraph::destroy_node_immediate(Node *node)
+    {
+        if (node == root_node)
         {
-            physics.add_character_controller(std::unique_ptr<components::CharacterController>(static_cast<components::CharacterController *>(ptr)));
+            log().critical("The root node can not be destroyed");
+            throw SceneException{};
         }
-        else if (std::strcmp(ptr->get_name(), "Script") == 0) // Script will be owned by generic
+
+        // Terrain and map are level geometry built once by init(), their nodes are static and skipped.
+        // Such a node keeps its subtree and moves under the root when an ancestor is destroyed
+        constexpr uint64_t LEVEL_GEOMETRY_MASK = components::component_type_bit<components::Terrain> | components::component_type_bit<components::Map>;
+        if (node->get_component_mask() & LEVEL_GEOMETRY_MASK)
         {
-            generic.add_script(std::unique_ptr<components::Script>(static_cast<components::Script *>(ptr)));
+            log().warn("Node \"{}\" holds level geometry and is not destroyed", node->name);
+            if (node->get_parent() != root_node)
+                make_parent(root_node, node);
+            return;
         }
-        else if (std::strcmp(ptr->get_name(), "Map") == 0) //Map will be shared by MapRenderer and Physics
+
+        while (node->first_child)
         {
-            auto map = std::shared_ptr<components::Map>(static_cast<components::Map*>(ptr));
-            map_renderer.add_map(map);
-            physics.add_map(map);
+            destroy_node_immediate(node->first_child);
         }
 
-        else if (std::strcmp(ptr->get_name(), "RigidBody") == 0) //Owned by physics
+        for (auto it = node->component_ptrs.rbegin(); it != node->component_ptrs.rend(); it++)
         {
-            physics.add_rigid_body(std::unique_ptr<components::RigidBody>(static_cast<components::RigidBody*>(ptr)));
+            component_routes.at((*it)->get_type_id()).remove(*it);
         }
-        else
+
+        node->detach_from_parent();
+        nodes.erase(node->handle.index);
+    }
+
+    Node *SceneGraph::get_node(NodeHandle handle)
+    {
+        if (!nodes.is_alive(handle.index) || nodes.get_generation(handle.index) != handle.generation)
+            return nullptr;
+        return &nodes.at(handle.index);
+    }
+
+    void SceneGraph::make_parent(Node *parent, Node *child)
+    {
+        // Throws on a cycle before anything changed
+        child->transforms.set_parent(child->transform, parent->transform);
+
+        child->detach_from_parent();
+        parent->append_child(child);
+
+        // Moved under a node of another instance or none, an instance root takes its instance along
+        if (child->instance_root.index != NodeHandle::INVALID_INDEX && child->instance_root != child->handle &&
+            child->instance_root != parent->instance_root)
+            child->leave_instance(child->instance_root);
+    }
+
+    void SceneGraph::register_component_routes()
+    {
+        using namespace components;
+
+        auto vec3_from_json = [](const nlohmann::json &v)
+        { return glm::vec3{v.at(0).get<float>(), v.at(1).get<float>(), v.at(2).get<float>()}; };
+
+        // Renderer keeps per frame data next to the pooled mesh renderer
+        component_routes[component_type_id<MeshRenderer>] = {
+            .add = [this](IComponent *, uint32_t slot)
+            {
+                renderer.add_pbr_mesh_renderer(slot);
+                if (initialized)
+                    renderer.init_mesh_renderer(slot);
+            },
+            .remove = [this](IComponent *component)
+            {
+                animation.remove_mesh_renderer(static_cast<MeshRenderer *>(component));
+                erase_component<MeshRenderer>(component);
+            },
+            .load = [this](Node *node, const nlohmann::json &j)
+            {
+                const data::Model &model = find_or_import_model(j.at("model").get<std::string>());
+                int32_t skin = j.at("skin").get<int32_t>();
+                const std::vector<uint32_t> *joints = skin >= 0 ? &model.skins.at(skin) : nullptr;
+                add_component<MeshRenderer>(node, gfx, model, model.meshes.at(j.at("mesh").get<uint32_t>()), joints);
+            },
+            .name = "MeshRenderer",
+        };
+
+        component_routes[component_type_id<Animator>] = {
+            .add = [this](IComponent *component, uint32_t)
+            {
+                if (initialized)
+                    animation.init_animator(*static_cast<Animator *>(component), job_system.get_frame_arena());
+            },
+            .remove = [this](IComponent *component)
+            { erase_component<Animator>(component); },
+            .load = [this](Node *node, const nlohmann::json &j)
+            { add_component<Animator>(node, find_or_import_model(j.at("model").get<std::string>())); },
+            .name = "Animator",
+        };
+
+        component_routes[component_type_id<CharacterController>] = {
+            .add = [this](IComponent *component, uint32_t)
+            {
+                if (initialized)
+                    physics.init_character_controller(*static_cast<CharacterController *>(component));
+            },
+            .remove = [this](IComponent *component)
+            {
+                physics.remove_character_controller(*static_cast<CharacterController *>(component));
+                erase_component<CharacterController>(component);
+            },
+            .load = [this](Node *node, const nlohmann::json &)
+            { add_component<CharacterController>(node); },
+            .name = "CharacterController",
+        };
+
+        component_routes[component_type_id<RigidBody>] = {
+            .add = [this](IComponent *component, uint32_t)
+            {
+                if (initialized)
+                    physics.init_rigid_body(*static_cast<RigidBody *>(component));
+            },
+            .remove = [this](IComponent *component)
+            {
+                physics.remove_rigid_body(*static_cast<RigidBody *>(component));
+                erase_component<RigidBody>(component);
+            },
+            .load = [this, vec3_from_json](Node *node, const nlohmann::json &j)
+            {
+                const nlohmann::json &shape = j.at("shape");
+                if (shape.at("type").get<std::string>() != "Box")
+                {
+                    log().critical("Unknown collision shape: {}", shape.at("type").dump());
+                    throw SceneException{};
+                }
+                add_component<RigidBody>(node, std::make_unique<BoxShape>(vec3_from_json(shape.at("center")), vec3_from_json(shape.at("half_width"))));
+            },
+            .name = "RigidBody",
+        };
+
+        // Scripts are owned by generic
+        component_routes[component_type_id<Script>] = {
+            .remove = [this](IComponent *component)
+            { generic.remove_script(static_cast<Script *>(component)); },
+            .load = [this](Node *node, const nlohmann::json &j)
+            {
+                auto it = j.contains("name") ? script_factories.find(j["name"].get<std::string>()) : script_factories.end();
+                if (it == script_factories.end())
+                {
+                    log().critical("Script is not registered: {}", j.dump());
+                    throw SceneException{};
+                }
+                it->second(*this, node, j);
+            },
+            .name = "Script",
+        };
+
+        // Terrain and map are level geometry, owned by their renderers and used by physics.
+        // They are built once by init() and live as long as the scene, destroy_node_immediate() skips their nodes.
+        auto reject_level_geometry = [this](IComponent *component)
         {
-            log().critical("Unknown system for component: {}", ptr->get_name());
+            log().critical("{} can only be added before SceneGraph::init() and can not be removed", component->get_name());
             throw SceneException{};
-        }
-
-        return ptr;
+        };
+        component_routes[component_type_id<Terrain>] = {
+            .add = [this, reject_level_geometry](IComponent *component, uint32_t)
+            {
+                if (initialized)
+                    reject_level_geometry(component);
+                auto terrain = static_cast<Terrain *>(component);
+                terrain_renderer.add_terrain(terrain);
+                physics.add_terrain_renderer(terrain);
+            },
+            .remove = reject_level_geometry,
+            .load = [this](Node *node, const nlohmann::json &j)
+            {
+                uint32_t patch_count = j.at("patch_count").get<uint32_t>();
+                uint32_t patch_size = j.at("patch_size").get<uint32_t>();
+                float scale = j.at("scale").get<float>();
+                if (j.contains("seed"))
+                {
+                    add_component<Terrain>(node, gfx, patch_count, patch_size, j.at("iteration").get<uint32_t>(), scale,
+                                           j.at("min_height").get<float>(), j.at("max_height").get<float>(), j.at("filter").get<float>(), j.at("seed").get<uint32_t>());
+                }
+                else
+                {
+                    add_component<Terrain>(node, gfx, patch_count, patch_size, scale);
+                }
+            },
+            .name = "Terrain",
+        };
+        component_routes[component_type_id<Map>] = {
+            .add = [this, reject_level_geometry](IComponent *component, uint32_t)
+            {
+                if (initialized)
+                    reject_level_geometry(component);
+                physics.add_map(static_cast<Map *>(component));
+            },
+            .remove = reject_level_geometry,
+            .load = [this](Node *node, const nlohmann::json &j)
+            { add_component<Map>(node)->load_json(j); },
+            .name = "Map",
+        };
     }
 
-    const std::vector<std::unique_ptr<Node>> &SceneGraph::get_nodes() const
+    const utils::PagedPool<Node> &SceneGraph::get_nodes() const
     {
         return nodes;
     }
 
 
+    const std::vector<TransformHandle> &SceneGraph::get_changed_transforms() const
+    {
+        return transforms.get_changed();
+    }
+
     void SceneGraph::render_imgui()
     {
-        static Node *selected_node = nullptr;
+        // Handle so a destroyed selection is detected
+        static NodeHandle selected_handle{};
+        Node *selected_node = get_node(selected_handle);
         if (ImGui::Begin("SceneGraph"))
         {
             if (ImGui::Button("Save"))
             {
                 save("res/maps/test.json");
             }
+            ImGui::SameLine();
+            if (ImGui::Button("Save binary"))
+            {
+                save_binary("res/maps/test.gscn");
+            }
+            ImGui::Text("Cached assets: %u, pending imports: %zu", assets.get_entry_count(), pending_imports.size());
 
             if (ImGui::Button("New"))
             {
                 create_node();
             }
 
-            std::function<void(scene::Node * node)> browse_scene_graph_recursive;
-            browse_scene_graph_recursive = [&browse_scene_graph_recursive](scene::Node *node)
-            {
-                const std::string &node_name = node->name;
-                std::string id_string = std::to_string(node->id);
-                std::string name = !node_name.empty() ? node_name + "|" + id_string : id_string;
-
-                ImGuiTreeNodeFlags flags = 0;
-                flags |= selected_node == node ? ImGuiTreeNodeFlags_Selected : 0;
-                flags |= node->children.empty() ? ImGuiTreeNodeFlags_Leaf : 0;
-
-                if (ImGui::TreeNodeEx(name.c_str(), flags))
-                {
-                    if (ImGui::IsItemClicked())
-                    {
-                        selected_node = node;
-                    }
-                    for (const auto &child : node->children)
-                    {
-                        browse_scene_graph_recursive(child);
-                    }
-                    ImGui::TreePop();
-                }
-            };
-
-            browse_scene_graph_recursive(get_nodes().at(0).get());
+            render_imgui_node_recursive(root_node, selected_node);
+            selected_handle = selected_node ? selected_node->get_handle() : NodeHandle{};
         }
         ImGui::End();
 
@@ -312,47 +1143,74 @@ namespace gage::scene
             if (selected_node)
             {
                 selected_node->render_imgui();
+                if (selected_node != root_node && ImGui::Button("Destroy"))
+                {
+                    destroy_node(selected_node);
+                }
             }
         }
         ImGui::End();
 
         if (ImGui::Begin("Scene Graph systems"))
         {
+            ImGui::Text("Task graph");
+            task_graph.render_imgui();
+            ImGui::Text("Transforms updated: %lu / %u", transforms.get_changed().size(), transforms.get_size());
+            ImGui::Separator();
+
             ImGui::Text("Renderer");
-            ImGui::Text("Num mesh renderers: %lu", renderer.mesh_renderers.size());
-            for (const auto &mesh_renderer : renderer.mesh_renderers)
-            {
-                ImGui::Text("unique_ptr: %p", mesh_renderer.mesh_renderer.get());
-            }
+            ImGui::Text("Num mesh renderers: %u / %u slots", renderer.mesh_renderers.size(), renderer.mesh_renderers.get_slot_count());
+            ImGui::Text("Mesh arena: %.2f MiB", renderer.get_mesh_arena().get_allocated_bytes() / (1024.0 * 1024.0));
 
             ImGui::Text("Num terrain renderers: %lu", terrain_renderer.terrains.size());
             for (const auto &terrain : terrain_renderer.terrains)
             {
-                ImGui::Text("shared_ptr: %p", terrain.terrain.get());
+                ImGui::Text("ptr: %p", terrain.terrain);
             }
             ImGui::Separator();
 
             ImGui::Text("Animation");
-            ImGui::Text("Num animators: %lu", animation.animators.size());
-            for (const auto &animator : animation.animators)
-            {
-                ImGui::Text("unique_ptr: %p", animator.get());
-            }
+            ImGui::Text("Num animators: %u / %u slots", animation.animators.size(), animation.animators.get_slot_count());
             ImGui::Separator();
 
             ImGui::Text("Physics");
-            ImGui::Text("Num character: %lu", physics.character_controllers.size());
-            for (const auto &character_controller : physics.character_controllers)
+            int thread_budget = physics.get_thread_budget();
+            if (ImGui::SliderInt("Thread budget", &thread_budget, 1, job_system.get_worker_count()))
             {
-                ImGui::Text("unique_ptr: %p", character_controller.get());
+                physics.set_thread_budget(thread_budget);
             }
+            ImGui::Text("Num character: %u", physics.character_controllers.size());
+            ImGui::Text("Num rigid bodies: %u", physics.rigid_bodies.size());
 
             ImGui::Text("Num terrains: %lu", physics.terrain_renderers.size());
             for (const auto &terrain : physics.terrain_renderers)
             {
-                ImGui::Text("shared_ptr: %p", terrain.terrain_renderer.get());
+                ImGui::Text("ptr: %p", terrain.terrain_renderer);
             }
         }
         ImGui::End();
     }
+
+    void SceneGraph::render_imgui_node_recursive(Node *node, Node *&selected_node)
+    {
+        ImGuiTreeNodeFlags flags = 0;
+        flags |= selected_node == node ? ImGuiTreeNodeFlags_Selected : 0;
+        flags |= !node->has_children() ? ImGuiTreeNodeFlags_Leaf : 0;
+
+        // ImGui formats into its own buffer, no string is built per node
+        bool open = node->name.empty() ? ImGui::TreeNodeEx(node, flags, "%u", node->handle.index)
+                                       : ImGui::TreeNodeEx(node, flags, "%s|%u", node->name.c_str(), node->handle.index);
+        if (open)
+        {
+            if (ImGui::IsItemClicked())
+            {
+                selected_node = node;
+            }
+            for (Node *child : node->get_children())
+            {
+                render_imgui_node_recursive(child, selected_node);
+            }
+            ImGui::TreePop();
+        }
+    }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Node.hpp"
+#include "TaskGraph.hpp"
+#include "AssetCache.hpp"
 
 #include "data/Model.hpp"
 #include "systems/Renderer.hpp"
@@ -10,16 +12,30 @@
 #include "systems/Generic.hpp"
 #include "systems/MapRenderer.hpp"
 
+#include <Core/src/utils/PagedPool.hpp>
+#include <Core/src/utils/JobSystem.hpp>
+#include <Core/src/mem.hpp>
+
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <array>
+#include <functional>
+#include <future>
+#include <mutex>
 #include <string_view>
+#include <type_traits>
+#include <unordered_map>
 
 
 
 namespace gage::gfx
 {
     class Graphics;
+    namespace data
+    {
+        class UploadBatch;
+    }
 }
 
 namespace tinygltf
@@ -31,6 +47,11 @@ namespace tinygltf
     class Material;
 }
 
+namespace gage::utils
+{
+    class JobSystem;
+}
+
 namespace gage::hid
 {
     class Keyboard;
@@ -43,40 +64,193 @@ namespace gage::scene
     {
     public:
         static constexpr std::string_view ROOT_NAME = "ROOT";
+        static constexpr uint32_t MAX_MESH_RENDERER_CMDS = 64;
+        static constexpr uint32_t MIN_MESH_RENDERERS_PER_CMD = 32;
+
+        // Creates a script saved under name, the json is what the script's to_json() returned
+        using ScriptFactory = std::function<void(SceneGraph& scene, Node* node, const nlohmann::json& j)>;
+        // Model of import_model_async, owned by the scene like the ones of import_model. Rethrows the import error
+        using ModelFuture = std::shared_future<const data::Model*>;
     public:
-        SceneGraph(const gfx::Graphics& gfx, gfx::data::Camera& camera);
+        SceneGraph(const gfx::Graphics& gfx, gfx::data::Camera& camera, utils::JobSystem& job_system);
         ~SceneGraph();
 
         void render_imgui();
 
         void save(const std::string& file_path);
+        // Adds the children of the saved root node below the root node, models are imported when not already
+        void load(const std::string& file_path);
+        // Flat node tables that are memory mapped on load, see SceneFile.hpp
+        void save_binary(const std::string& file_path);
+        void load_binary(const std::string& file_path);
+        // Scripts are only known to the application, register them before loading a scene that has them
+        void register_script(const std::string& name, ScriptFactory factory);
         void init();
         void build_node_transform();
 
+        // Systems register their fixed tick work here, tick() runs it on the job system
+        void add_task(TaskDesc desc);
+        // Runs update_imports() first, releases unused assets last
+        void tick(float delta, const hid::Keyboard& keyboard, const hid::Mouse& mouse);
+
+        // Record every renderer in parallel into secondary command buffers and execute them in cmd,
+        // the pass has to be started with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+        void render_depth(VkCommandBuffer cmd);
+        void render(VkCommandBuffer cmd);
+
         Node* create_node();
-        void* add_component(Node* node, std::unique_ptr<components::IComponent> component);
-        
+        // Queues the node and its descendants, they are destroyed with their components at the end of the current tick.
+        // Nodes with a Terrain or Map are static level geometry, they and their subtree are kept and moved under the root.
+        // Safe to call from tasks.
+        void destroy_node(Node* node);
+        // nullptr if the node was destroyed
+        Node* get_node(NodeHandle handle);
 
+        // Constructs T(scene, node, args...) in the pool of the system that owns T and hands it to the systems using it.
+        // Scripts are only known to the application so they are allocated on their own and owned by Generic.
+        template<typename T, typename... Args>
+        T* add_component(Node* node, Args&&... args)
+        {
+            MemoryTagScope memory_tag(MemoryTag::SCENE);
+            T* component{};
+            if constexpr (std::is_base_of_v<components::Script, T>)
+            {
+                auto script = std::make_unique<T>(*this, *node, std::forward<Args>(args)...);
+                component = script.get();
+                generic.add_script(std::move(script));
+                node->add_component_ptr(component);
+                if (initialized)
+                    component->init();
+            }
+            else
+            {
+                auto& pool = get_component_pool<T>();
+                uint32_t slot = pool.emplace(*this, *node, std::forward<Args>(args)...);
+                component = &pool.at(slot);
+                node->add_component_ptr(component);
 
+                const auto& add = component_routes[components::component_type_id<T>].add;
+                if (add)
+                    add(component, slot);
+            }
+            return component;
+        }
+
+
+        // Returns the model already imported from file_path if there is one.
+        // A gltf is loaded from the .gmdl AssetCooker wrote next to it when that file is up to date
         const data::Model& import_model(const std::string& file_path, data::ModelImportMode mode);
+        // nullptr if file_path was not imported (or is still importing)
+        const data::Model* find_model(const std::string& file_path) const;
+        // The file is parsed and its images decoded in a background job, then the meshes and materials are uploaded
+        // in one batch. Nothing waits on either, update_imports() polls them.
+        ModelFuture import_model_async(const std::string& file_path, data::ModelImportMode mode);
         Node* instanciate_model(const data::Model& model, glm::vec3 initial_position);
+        // Returns an empty node the model is instanciated below once it is ready. placeholder (e.g. a low detail model)
+        // is instanciated below it in the meantime, on_ready gets the root of the instance
+        Node* instanciate_model_async(ModelFuture model, glm::vec3 initial_position, const data::Model* placeholder = nullptr,
+            std::function<void(Node* instance)> on_ready = {});
+        // Starts the upload of at most one parsed model, finishes completed uploads and instanciates what became ready.
+        // Main thread only
+        void update_imports();
 
 
         static void make_parent(Node* parent, Node* child);
 
-        const std::vector<std::unique_ptr<Node>>& get_nodes() const;
+        const utils::PagedPool<Node>& get_nodes() const;
+        // Nodes whose global transform changed during the last tick, match them with Node::get_transform_handle()
+        const std::vector<TransformHandle>& get_changed_transforms() const;
     private:
+        void register_system_tasks();
+        void register_component_routes();
+        void record_secondary_cmds(VkCommandBuffer cmd, VkRenderPass render_pass, VkFramebuffer framebuffer, bool depth);
+        void render_imgui_node_recursive(Node* node, Node*& selected_node);
+        void destroy_pending_nodes();
+        void destroy_node_immediate(Node* node);
+        const data::Model& find_or_import_model(const std::string& file_path);
+        // Cpu part of the model, from the cooked file next to a gltf if it is not older than the gltf. Any job system worker
+        std::unique_ptr<data::Model> load_model(const std::string& file_path, data::ModelImportMode mode);
+        void load_component(Node* node, components::ComponentTypeId type, const nlohmann::json& j);
+        components::ComponentTypeId get_component_type_id(const std::string& name) const;
+        void load_model_instance(Node* root, const std::string& model_name);
+
+        template<typename T>
+        utils::PagedPool<T>& get_component_pool()
+        {
+            if constexpr (std::is_same_v<T, components::MeshRenderer>)
+                return renderer.mesh_renderers;
+            else if constexpr (std::is_same_v<T, components::Terrain>)
+                return terrain_renderer.terrain_components;
+            else if constexpr (std::is_same_v<T, components::Map>)
+                return map_renderer.maps;
+            else if constexpr (std::is_same_v<T, components::Animator>)
+                return animation.animators;
+            else if constexpr (std::is_same_v<T, components::CharacterController>)
+                return physics.character_controllers;
+            else if constexpr (std::is_same_v<T, components::RigidBody>)
+                return physics.rigid_bodies;
+            else
+                static_assert(!std::is_same_v<T, T>, "No system stores this component type");
+        }
+
+        template<typename T>
+        void erase_component(components::IComponent* component)
+        {
+            auto& pool = get_component_pool<T>();
+            pool.erase(pool.get_slot(static_cast<T*>(component)));
+        }
+    private:
+        struct ComponentRoute
+        {
+            // Registers a component just constructed in its pool with the systems that use it
+            std::function<void(components::IComponent*, uint32_t slot)> add{};
+            // Unregisters the component from every system and destroys it
+            std::function<void(components::IComponent*)> remove{};
+            // Adds the component described by a to_json() object to the node
+            std::function<void(Node*, const nlohmann::json&)> load{};
+            const char* name{}; // IComponent::get_name()
+        };
+
+        struct PendingImport
+        {
+            std::string file_path{};
+            std::future<std::unique_ptr<data::Model>> parsed{}; // Cpu part, from the background job
+            std::unique_ptr<data::Model> model{};
+            std::unique_ptr<gfx::data::UploadBatch> batch{}; // Set once the upload was submitted
+            std::promise<const data::Model*> promise{};
+            ModelFuture future{}; // Of promise, handed to every request of the same file
+        };
+        struct PendingInstance
+        {
+            ModelFuture model{};
+            NodeHandle parent{};
+            NodeHandle placeholder{};
+            std::function<void(Node*)> on_ready{};
+        };
+
         const gfx::Graphics& gfx;
-        uint64_t id{0};
+        bool initialized{};
+        std::vector<PendingImport> pending_imports{};
+        utils::JobSystem::Job* import_group{}; // Parent of the background parse jobs, waited on at destruction
+        std::vector<PendingInstance> pending_instances{};
+        std::array<ComponentRoute, components::COMPONENT_TYPE_COUNT> component_routes{}; // Indexed by component type id
+        std::mutex pending_destroy_mutex{};
+        std::vector<NodeHandle> pending_destroys{};
+        std::vector<NodeHandle> destroying{};
+        std::unordered_map<std::string, ScriptFactory> script_factories{};
     public:
+        TransformHierarchy transforms{};
+        utils::JobSystem& job_system;
+        AssetCache assets; // Before the systems, they keep references to it
         systems::Renderer renderer;
         systems::TerrainRenderer terrain_renderer;
         systems::MapRenderer map_renderer;
         systems::Animation animation;
         systems::Physics physics;
         systems::Generic generic;
+        TaskGraph task_graph;
         Node* root_node{};
-        std::vector<std::unique_ptr<Node>> nodes{};
+        utils::PagedPool<Node> nodes{};
         std::vector<std::unique_ptr<data::Model>> models{};
     };
 }
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include <pch.hpp>
+#include "TaskGraph.hpp"
+
+#include "scene.hpp"
+
+#include <Core/src/mem.hpp>
+
+#include <imgui/imgui.h>
+
+namespace gage::scene
+{
+    void TaskGraph::add_task(TaskDesc desc)
+    {
+        for (const auto &task : tasks)
+        {
+            if (task->desc.name.compare(desc.name) == 0)
+            {
+                log().critical("Task already registered: {}", desc.name);
+                throw SceneException{};
+            }
+        }
+
+        auto task = std::make_unique<Task>();
+        task->desc = std::move(desc);
+        task->registration_index = tasks.size();
+        tasks.push_back(std::move(task));
+        compiled = false;
+    }
+
+    void TaskGraph::compile()
+    {
+        // A fixed order makes every conflicting pair of tasks run in the same order each tick
+        std::sort(tasks.begin(), tasks.end(), [](const std::unique_ptr<Task> &a, const std::unique_ptr<Task> &b)
+                         {
+                             if (a->desc.stage != b->desc.stage)
+                                 return a->desc.stage < b->desc.stage;
+                             return a->registration_index < b->registration_index; });
+
+        for (auto &task : tasks)
+        {
+            task->successors.clear();
+            task->num_predecessors = 0;
+        }
+
+        for (uint32_t j = 0; j < tasks.size(); j++)
+        {
+            Task &after = *tasks.at(j);
+            for (const auto &dependency : after.desc.dependencies)
+            {
+                auto it = std::find_if(tasks.begin(), tasks.end(), [&dependency](const std::unique_ptr<Task> &task)
+                                       { return task->desc.name.compare(dependency) == 0; });
+                if (it == tasks.end() || (uint32_t)std::distance(tasks.begin(), it) >= j)
+                {
+                    log().critical("Task {} depends on {} which is not scheduled before it", after.desc.name, dependency);
+                    throw SceneException{};
+                }
+            }
+
+            for (uint32_t i = 0; i < j; i++)
+            {
+                Task &before = *tasks.at(i);
+                bool stage_barrier = before.desc.stage != after.desc.stage;
+                bool conflict = (before.desc.writes & (after.desc.reads | after.desc.writes)) || (after.desc.writes & before.desc.reads);
+                bool explicit_dependency = std::find(after.desc.dependencies.begin(), after.desc.dependencies.end(), before.desc.name) != after.desc.dependencies.end();
+
+                if (stage_barrier || conflict || explicit_dependency)
+                {
+                    before.successors.push_back(j);
+                    after.num_predecessors++;
+                }
+            }
+        }
+
+        compiled = true;
+    }
+
+    void TaskGraph::execute(utils::JobSystem &job_system, const TickContext &context)
+    {
+        if (!compiled)
+        {
+            compile();
+        }
+
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        for (auto &task : tasks)
+        {
+            task->remaining_predecessors.store(task->num_predecessors, std::memory_order_relaxed);
+        }
+
+        utils::JobSystem::Job *group = job_system.create_group();
+        for (uint32_t i = 0; i < tasks.size(); i++)
+        {
+            if (tasks.at(i)->num_predecessors == 0)
+            {
+                job_system.run(job_system.create_child_job(group, [this, &job_system, &context, group, i]()
+                                                           { run_task(job_system, context, group, i); }));
+            }
+        }
+        job_system.run(group);
+        job_system.wait(group);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        execution_ms = std::chrono::duration<double, std::milli>(end - begin).count();
+
+        // Longest chain of dependent tasks, tasks are already in topological order
+        critical_path_ms = 0.0;
+        total_task_ms = 0.0;
+        for (auto &task : tasks)
+        {
+            task->path_ms = task->time_ms;
+        }
+        for (auto &task : tasks)
+        {
+            for (uint32_t successor : task->successors)
+            {
+                Task &next = *tasks.at(successor);
+                next.path_ms = std::max(next.path_ms, task->path_ms + next.time_ms);
+            }
+            critical_path_ms = std::max(critical_path_ms, task->path_ms);
+            total_task_ms += task->time_ms;
+        }
+    }
+
+    void TaskGraph::run_task(utils::JobSystem &job_system, const TickContext &context, utils::JobSystem::Job *group, uint32_t task_index)
+    {
+        Task &task = *tasks.at(task_index);
+        MemoryTagScope memory_tag(MemoryTag::SCENE);
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        task.desc.function(context);
+        auto end = std::chrono::high_resolution_clock::now();
+        task.time_ms = std::chrono::duration<double, std::milli>(end - begin).count();
+
+        for (uint32_t successor : task.successors)
+        {
+            if (tasks.at(successor)->remaining_predecessors.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                job_system.run(job_system.create_child_job(group, [this, &job_system, &context, group, successor]()
+                                                           { run_task(job_system, context, group, successor); }));
+            }
+        }
+    }
+
+    void TaskGraph::render_imgui() const
+    {
+        ImGui::Text("Tick: %.3f ms | critical path: %.3f ms | task sum: %.3f ms", execution_ms, critical_path_ms, total_task_ms);
+        for (const auto &task : tasks)
+        {
+            ImGui::Text("%s: %.3f ms", task->desc.name.c_str(), task->time_ms);
+        }
+    }
+
+    double TaskGraph::get_critical_path_ms() const
+    {
+        return critical_path_ms;
+    }
+
+    double TaskGraph::get_total_task_ms() const
+    {
+        return total_task_ms;
+    }
+
+    double TaskGraph::get_execution_ms() const
+    {
+        return execution_ms;
+    }
+}
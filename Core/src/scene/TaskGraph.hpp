@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+#include <Core/src/utils/JobSystem.hpp>
+
+namespace gage::hid
+{
+    class Keyboard;
+    class Mouse;
+}
+
+namespace gage::scene
+{
+    // Tasks of a stage start only after every task of the previous stages finished
+    enum class TaskStage
+    {
+        UPDATE,
+        TRANSFORM,
+        LATE_UPDATE
+    };
+
+    // Data a task reads or writes, tasks touching the same data are ordered by stage then registration order
+    namespace TaskResources
+    {
+        static constexpr uint32_t NONE = 0;
+        static constexpr uint32_t TRANSFORMS = 1 << 0;
+        static constexpr uint32_t BONE_PALETTES = 1 << 1;
+        static constexpr uint32_t PHYSICS_BODIES = 1 << 2;
+        static constexpr uint32_t ANIMATORS = 1 << 3;
+        static constexpr uint32_t LIGHTING = 1 << 4; // Lights and ambient state read when the frame is recorded
+        static constexpr uint32_t ALL = ~0u;
+    };
+
+    struct TickContext
+    {
+        float delta{};
+        const hid::Keyboard &keyboard;
+        const hid::Mouse &mouse;
+    };
+
+    struct TaskDesc
+    {
+        std::string name{};
+        TaskStage stage{};
+        uint32_t reads{};
+        uint32_t writes{};
+        std::vector<std::string> dependencies{}; // Names of previously registered tasks
+        std::function<void(const TickContext &context)> function{};
+    };
+
+    class TaskGraph
+    {
+        struct Task
+        {
+            TaskDesc desc{};
+            uint32_t registration_index{};
+            std::vector<uint32_t> successors{};
+            uint32_t num_predecessors{};
+            std::atomic<uint32_t> remaining_predecessors{};
+            double time_ms{};
+            double path_ms{};
+        };
+    public:
+        TaskGraph() = default;
+        ~TaskGraph() = default;
+
+        TaskGraph(const TaskGraph &) = delete;
+        TaskGraph operator=(const TaskGraph &) = delete;
+
+        void add_task(TaskDesc desc);
+        void execute(utils::JobSystem &job_system, const TickContext &context);
+
+        void render_imgui() const;
+
+        double get_critical_path_ms() const;
+        double get_total_task_ms() const;
+        double get_execution_ms() const;
+    private:
+        void compile();
+        void run_task(utils::JobSystem &job_system, const TickContext &context, utils::JobSystem::Job *group, uint32_t task_index);
+    private:
+        std::vector<std::unique_ptr<Task>> tasks{}; // Sorted by stage then registration order once compiled
+        bool compiled{};
+
+        double critical_path_ms{};
+        double total_task_ms{};
+        double execution_ms{};
+    };
+}
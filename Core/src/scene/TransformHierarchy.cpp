@@ -0,0 +1,358 @@
+#include <pch.hpp>
+#include "TransformHierarchy.hpp"
+
+#include "scene.hpp"
+
+#include <Core/src/utils/JobSystem.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+#define GAGE_TRANSFORM_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace gage::scene
+{
+    // Column major out = a * b, out must not alias a or b
+    static inline void multiply(const glm::mat4x4 &a, const glm::mat4x4 &b, glm::mat4x4 &out)
+    {
+#ifdef GAGE_TRANSFORM_SSE
+        __m128 a0 = _mm_loadu_ps(&a[0].x);
+        __m128 a1 = _mm_loadu_ps(&a[1].x);
+        __m128 a2 = _mm_loadu_ps(&a[2].x);
+        __m128 a3 = _mm_loadu_ps(&a[3].x);
+        for (uint32_t j = 0; j < 4; j++)
+        {
+            __m128 column = _mm_mul_ps(a0, _mm_set1_ps(b[j].x));
+            column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(b[j].y)));
+            column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(b[j].z)));
+            column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(b[j].w)));
+            _mm_storeu_ps(&out[j].x, column);
+        }
+#else
+        out = a * b;
+#endif
+    }
+
+    // translate * scale * rotate, same order the scene graph always used
+    static inline glm::mat4x4 compose(const glm::vec3 &position, const glm::vec3 &scale, const glm::quat &rotation)
+    {
+        glm::mat3x3 r = glm::mat3_cast(rotation);
+        return glm::mat4x4(
+            glm::vec4(r[0] * scale, 0.0f),
+            glm::vec4(r[1] * scale, 0.0f),
+            glm::vec4(r[2] * scale, 0.0f),
+            glm::vec4(position, 1.0f));
+    }
+
+    TransformHandle TransformHierarchy::create(TransformHandle parent)
+    {
+        uint32_t slot = positions.size();
+        TransformHandle handle{};
+        if (free_handles.empty())
+        {
+            handle = handle_to_slot.size();
+            handle_to_slot.push_back(slot);
+        }
+        else
+        {
+            handle = free_handles.back();
+            free_handles.pop_back();
+            handle_to_slot[handle] = slot;
+        }
+
+        positions.push_back(glm::vec3{0.0f, 0.0f, 0.0f});
+        scales.push_back(glm::vec3{1.0f, 1.0f, 1.0f});
+        rotations.push_back(glm::quat{1.0f, 0.0f, 0.0f, 0.0f});
+        global_transforms.push_back(glm::mat4x4{1.0f});
+        parents.push_back(parent != INVALID_TRANSFORM ? handle_to_slot.at(parent) : INVALID_TRANSFORM);
+        subtree_sizes.push_back(1);
+        dirty.push_back(false);
+        slot_to_handle.push_back(handle);
+
+        uint32_t parent_slot = parents.back();
+        if (parent_slot != INVALID_TRANSFORM)
+        {
+            if (parent_slot + subtree_sizes[parent_slot] == slot)
+            {
+                // Parent subtree ends at the back, appending keeps it contiguous
+                for (uint32_t ancestor = parent_slot; ancestor < DESTROYED_TRANSFORM; ancestor = parents[ancestor])
+                {
+                    subtree_sizes[ancestor]++;
+                }
+            }
+            else
+            {
+                order_dirty = true;
+            }
+        }
+
+        mark_dirty(slot);
+        return handle;
+    }
+
+    void TransformHierarchy::destroy(TransformHandle handle)
+    {
+        uint32_t slot = handle_to_slot.at(handle);
+
+        // The slot stays in the arrays until the next sort, nothing reaches it through its handle anymore.
+        // Children still pointing at it become roots in that sort
+        parents[slot] = DESTROYED_TRANSFORM;
+        handle_to_slot[handle] = INVALID_TRANSFORM;
+        free_handles.push_back(handle);
+        order_dirty = true;
+    }
+
+    void TransformHierarchy::set_parent(TransformHandle handle, TransformHandle parent)
+    {
+        uint32_t slot = handle_to_slot.at(handle);
+        uint32_t parent_slot = parent != INVALID_TRANSFORM ? handle_to_slot.at(parent) : INVALID_TRANSFORM;
+
+        for (uint32_t ancestor = parent_slot; ancestor < DESTROYED_TRANSFORM; ancestor = parents[ancestor])
+        {
+            if (ancestor == slot)
+            {
+                log().critical("Transform {} can not become a child of its own descendant {}", handle, parent);
+                throw SceneException{};
+            }
+        }
+
+        if (parents[slot] == parent_slot)
+            return;
+
+        parents[slot] = parent_slot;
+        order_dirty = true;
+        mark_dirty(slot);
+    }
+
+    void TransformHierarchy::update(utils::JobSystem &job_system)
+    {
+        changed.clear();
+        if (order_dirty)
+        {
+            sort(job_system.get_frame_arena());
+        }
+
+        dirty_slots.clear();
+        for (TransformHandle handle : dirty_handles)
+        {
+            // Destroyed since it was marked
+            if (handle_to_slot[handle] != INVALID_TRANSFORM)
+                dirty_slots.push_back(handle_to_slot[handle]);
+        }
+        dirty_handles.clear();
+        std::sort(dirty_slots.begin(), dirty_slots.end());
+
+        // Ancestors come first, a dirty slot inside an already dirty subtree is skipped
+        dirty_ranges.clear();
+        uint32_t dirty_count = 0;
+        for (uint32_t slot : dirty_slots)
+        {
+            dirty[slot] = false;
+            if (!dirty_ranges.empty() && slot < dirty_ranges.back().end)
+                continue;
+
+            dirty_ranges.push_back({slot, slot + subtree_sizes[slot]});
+            dirty_count += subtree_sizes[slot];
+        }
+
+        // Big subtrees are split at their children (e.g. the root into every instanciated model),
+        // the nodes they are split at are updated first on this thread
+        uint32_t batch_size = std::max(MIN_TRANSFORMS_PER_BATCH, dirty_count / (job_system.get_worker_count() * 4));
+        work_ranges.clear();
+        serial_slots.clear();
+        for (const Range &range : dirty_ranges)
+        {
+            split_range(range.begin, range.end, batch_size);
+        }
+        for (uint32_t slot : serial_slots)
+        {
+            update_range(slot, slot + 1);
+        }
+
+        // Group neighbouring work ranges so every batch has roughly batch_size nodes
+        batches.clear();
+        uint32_t batch_node_count = batch_size;
+        for (uint32_t i = 0; i < work_ranges.size(); i++)
+        {
+            if (batch_node_count >= batch_size)
+            {
+                batches.push_back({i, i});
+                batch_node_count = 0;
+            }
+            batches.back().end = i + 1;
+            batch_node_count += work_ranges[i].end - work_ranges[i].begin;
+        }
+
+        job_system.parallel_for(batches.size(), 1, [this](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                for (uint32_t range = batches[i].begin; range < batches[i].end; range++)
+                {
+                    update_range(work_ranges[range].begin, work_ranges[range].end);
+                }
+            }
+        });
+
+        for (uint32_t slot : serial_slots)
+        {
+            changed.push_back(slot_to_handle[slot]);
+        }
+        for (const Range &range : work_ranges)
+        {
+            for (uint32_t slot = range.begin; slot < range.end; slot++)
+            {
+                changed.push_back(slot_to_handle[slot]);
+            }
+        }
+    }
+
+    void TransformHierarchy::split_range(uint32_t begin, uint32_t end, uint32_t max_batch_size)
+    {
+        if (end - begin <= max_batch_size)
+        {
+            work_ranges.push_back({begin, end});
+            return;
+        }
+
+        serial_slots.push_back(begin);
+        for (uint32_t child = begin + 1; child < end; child += subtree_sizes[child])
+        {
+            split_range(child, child + subtree_sizes[child], max_batch_size);
+        }
+    }
+
+    const std::vector<TransformHandle> &TransformHierarchy::get_changed() const
+    {
+        return changed;
+    }
+
+    uint32_t TransformHierarchy::get_size() const
+    {
+        return positions.size();
+    }
+
+    void TransformHierarchy::update_range(uint32_t begin, uint32_t end)
+    {
+        for (uint32_t slot = begin; slot < end; slot++)
+        {
+            glm::mat4x4 local = compose(positions[slot], scales[slot], rotations[slot]);
+            uint32_t parent = parents[slot];
+            if (parent == INVALID_TRANSFORM)
+            {
+                global_transforms[slot] = local;
+            }
+            else
+            {
+                multiply(global_transforms[parent], local, global_transforms[slot]);
+            }
+        }
+    }
+
+    void TransformHierarchy::sort(utils::LinearArena &scratch_arena)
+    {
+        uint32_t count = positions.size();
+
+        // Live children of a destroyed transform become roots, their global transform is recomputed from the local one
+        for (uint32_t slot = 0; slot < count; slot++)
+        {
+            if (parents[slot] < DESTROYED_TRANSFORM && parents[parents[slot]] == DESTROYED_TRANSFORM)
+            {
+                parents[slot] = INVALID_TRANSFORM;
+                mark_dirty(slot);
+            }
+        }
+
+        // Children of every slot, siblings keep their relative order
+        utils::ArenaVector<uint32_t> child_offsets(count + 1, 0, scratch_arena);
+        uint32_t live_count = 0;
+        for (uint32_t slot = 0; slot < count; slot++)
+        {
+            if (parents[slot] == DESTROYED_TRANSFORM)
+                continue;
+            live_count++;
+            if (parents[slot] != INVALID_TRANSFORM)
+                child_offsets[parents[slot] + 1]++;
+        }
+        for (uint32_t slot = 0; slot < count; slot++)
+        {
+            child_offsets[slot + 1] += child_offsets[slot];
+        }
+        utils::ArenaVector<uint32_t> children(child_offsets[count], scratch_arena);
+        utils::ArenaVector<uint32_t> cursors(child_offsets.begin(), child_offsets.end() - 1, scratch_arena);
+        for (uint32_t slot = 0; slot < count; slot++)
+        {
+            if (parents[slot] != INVALID_TRANSFORM && parents[slot] != DESTROYED_TRANSFORM)
+                children[cursors[parents[slot]]++] = slot;
+        }
+
+        // Depth first pre order, destroyed slots are left out
+        utils::ArenaVector<uint32_t> order(scratch_arena);
+        utils::ArenaVector<uint32_t> stack(scratch_arena);
+        order.reserve(live_count);
+        stack.reserve(live_count);
+        for (uint32_t root = 0; root < count; root++)
+        {
+            if (parents[root] != INVALID_TRANSFORM)
+                continue;
+
+            stack.push_back(root);
+            while (!stack.empty())
+            {
+                uint32_t slot = stack.back();
+                stack.pop_back();
+                order.push_back(slot);
+                for (uint32_t i = child_offsets[slot + 1]; i > child_offsets[slot]; i--)
+                {
+                    stack.push_back(children[i - 1]);
+                }
+            }
+        }
+        assert(order.size() == live_count && "Cycle in the transform hierarchy");
+
+        utils::ArenaVector<uint32_t> new_slots(count, scratch_arena);
+        for (uint32_t i = 0; i < order.size(); i++)
+        {
+            new_slots[order[i]] = i;
+        }
+
+        // Sorted in scratch memory and copied back, the arrays only shrink so they keep their capacity
+        auto permute = [&order, &scratch_arena](auto &values)
+        {
+            using Value = typename std::remove_reference_t<decltype(values)>::value_type;
+            utils::ArenaVector<Value> sorted(scratch_arena);
+            sorted.reserve(order.size());
+            for (uint32_t slot : order)
+            {
+                sorted.push_back(values[slot]);
+            }
+            values.assign(sorted.begin(), sorted.end());
+        };
+        permute(positions);
+        permute(scales);
+        permute(rotations);
+        permute(global_transforms);
+        permute(parents);
+        permute(dirty);
+        permute(slot_to_handle);
+
+        count = order.size();
+        for (uint32_t slot = 0; slot < count; slot++)
+        {
+            if (parents[slot] != INVALID_TRANSFORM)
+                parents[slot] = new_slots[parents[slot]];
+            handle_to_slot[slot_to_handle[slot]] = slot;
+        }
+
+        // Children come after their parent, accumulate from the back
+        subtree_sizes.assign(count, 1);
+        for (uint32_t slot = count; slot > 0; slot--)
+        {
+            uint32_t parent = parents[slot - 1];
+            if (parent != INVALID_TRANSFORM)
+                subtree_sizes[parent] += subtree_sizes[slot - 1];
+        }
+
+        order_dirty = false;
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace gage::utils
+{
+    class JobSystem;
+    class LinearArena;
+}
+
+namespace gage::scene
+{
+    // Stable id of a transform, slots move around when the hierarchy is re-sorted
+    using TransformHandle = uint32_t;
+    static constexpr TransformHandle INVALID_TRANSFORM = std::numeric_limits<uint32_t>::max();
+
+    // Local and global transforms of every node in SoA arrays.
+    // Slots are kept in depth first pre order so a parent always comes before its children
+    // and every subtree is a contiguous range of slots.
+    // Setters mark the transform dirty, update() only recomputes dirty subtrees.
+    // Destroyed slots are dropped by the next re-sort and their handles are reused. Not thread safe.
+    class TransformHierarchy
+    {
+        struct Range
+        {
+            uint32_t begin{};
+            uint32_t end{};
+        };
+    public:
+        // Dirty subtrees smaller than this are never split, batches are at least this big
+        static constexpr uint32_t MIN_TRANSFORMS_PER_BATCH = 256;
+    public:
+        TransformHierarchy() = default;
+        ~TransformHierarchy() = default;
+
+        TransformHierarchy(const TransformHierarchy &) = delete;
+        TransformHierarchy operator=(const TransformHierarchy &) = delete;
+
+        TransformHandle create(TransformHandle parent = INVALID_TRANSFORM);
+        // Children left behind become roots with the next update(), keeping their local transform
+        void destroy(TransformHandle handle);
+        void set_parent(TransformHandle handle, TransformHandle parent);
+
+        // Recompute the global transform of dirty subtrees, re-sorts the slots first if the hierarchy changed.
+        // Independent subtrees are batched by node count and updated in parallel.
+        void update(utils::JobSystem &job_system);
+        // Transforms whose global transform was recomputed by the last update()
+        const std::vector<TransformHandle> &get_changed() const;
+
+        const glm::vec3 &get_position(TransformHandle handle) const { return positions[handle_to_slot[handle]]; }
+        const glm::vec3 &get_scale(TransformHandle handle) const { return scales[handle_to_slot[handle]]; }
+        const glm::quat &get_rotation(TransformHandle handle) const { return rotations[handle_to_slot[handle]]; }
+        const glm::mat4x4 &get_global_transform(TransformHandle handle) const { return global_transforms[handle_to_slot[handle]]; }
+
+        void set_position(TransformHandle handle, const glm::vec3 &position)
+        {
+            uint32_t slot = handle_to_slot[handle];
+            if (positions[slot] != position)
+            {
+                positions[slot] = position;
+                mark_dirty(slot);
+            }
+        }
+        void set_scale(TransformHandle handle, const glm::vec3 &scale)
+        {
+            uint32_t slot = handle_to_slot[handle];
+            if (scales[slot] != scale)
+            {
+                scales[slot] = scale;
+                mark_dirty(slot);
+            }
+        }
+        void set_rotation(TransformHandle handle, const glm::quat &rotation)
+        {
+            uint32_t slot = handle_to_slot[handle];
+            if (rotations[slot] != rotation)
+            {
+                rotations[slot] = rotation;
+                mark_dirty(slot);
+            }
+        }
+
+        uint32_t get_size() const;
+    private:
+        // Parent of a destroyed slot until the next sort() removes it
+        static constexpr uint32_t DESTROYED_TRANSFORM = INVALID_TRANSFORM - 1;
+
+        void mark_dirty(uint32_t slot)
+        {
+            if (!dirty[slot])
+            {
+                dirty[slot] = true;
+                dirty_handles.push_back(slot_to_handle[slot]);
+            }
+        }
+        // Temporaries come from scratch_arena
+        void sort(utils::LinearArena &scratch_arena);
+        void update_range(uint32_t begin, uint32_t end);
+        void split_range(uint32_t begin, uint32_t end, uint32_t max_batch_size);
+    private:
+        // Indexed by slot
+        std::vector<glm::vec3> positions{};
+        std::vector<glm::vec3> scales{};
+        std::vector<glm::quat> rotations{};
+        std::vector<glm::mat4x4> global_transforms{};
+        std::vector<uint32_t> parents{}; // Parent slot, INVALID_TRANSFORM for roots
+        std::vector<uint32_t> subtree_sizes{}; // Itself + descendants
+        std::vector<uint8_t> dirty{};
+        std::vector<TransformHandle> slot_to_handle{};
+
+        // Indexed by handle
+        std::vector<uint32_t> handle_to_slot{}; // INVALID_TRANSFORM for destroyed handles
+        std::vector<TransformHandle> free_handles{};
+
+        std::vector<TransformHandle> dirty_handles{};
+        std::vector<uint32_t> dirty_slots{};
+        std::vector<Range> dirty_ranges{};
+        std::vector<Range> work_ranges{}; // Disjoint subtrees whose parents are already up to date
+        std::vector<Range> batches{};     // Indices into work_ranges
+        std::vector<uint32_t> serial_slots{};
+        std::vector<TransformHandle> changed{};
+        bool order_dirty{};
+    };
+}
@@ -29,6 +29,7 @@ namespace gage::scene::components
         nlohmann::json to_json() const final;
         void render_imgui() final;
         inline const char* get_name() const final { return "Animator"; };
+        inline ComponentTypeId get_type_id() const final { return component_type_id<Animator>; }
 
 
     private:
@@ -32,6 +32,7 @@ namespace gage::scene::components
         nlohmann::json to_json() const final;
         void render_imgui() override;
         inline const char* get_name() const override { return "CharacterController"; };
+        inline ComponentTypeId get_type_id() const final { return component_type_id<CharacterController>; }
 
     public:
         std::unique_ptr<JPH::Character> character;
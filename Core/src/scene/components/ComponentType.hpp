@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace gage::scene::components
+{
+    class MeshRenderer;
+    class Terrain;
+    class Animator;
+    class CharacterController;
+    class Script;
+    class Map;
+    class RigidBody;
+
+    using ComponentTypeId = uint32_t;
+
+    template <typename... Ts>
+    struct ComponentTypeList
+    {
+        static constexpr uint32_t size = sizeof...(Ts);
+    };
+
+    // Every component type the scene graph knows about, the position in the list is the type id.
+    // Scripts written outside of Core all share the Script id.
+    using ComponentTypes = ComponentTypeList<MeshRenderer, Terrain, Animator, CharacterController, Script, Map, RigidBody>;
+
+    static constexpr uint32_t COMPONENT_TYPE_COUNT = ComponentTypes::size;
+    static_assert(COMPONENT_TYPE_COUNT <= 64, "Node component mask is 64 bits");
+
+    namespace detail
+    {
+        template <typename T, typename List>
+        struct ComponentTypeIndex;
+
+        template <typename T, typename... Ts>
+        struct ComponentTypeIndex<T, ComponentTypeList<T, Ts...>>
+        {
+            static constexpr ComponentTypeId value = 0;
+        };
+
+        template <typename T, typename U, typename... Ts>
+        struct ComponentTypeIndex<T, ComponentTypeList<U, Ts...>>
+        {
+            static constexpr ComponentTypeId value = 1 + ComponentTypeIndex<T, ComponentTypeList<Ts...>>::value;
+        };
+
+        template <typename T>
+        struct ComponentTypeIndex<T, ComponentTypeList<>>
+        {
+            static_assert(!std::is_same_v<T, T>, "Component type is not registered in ComponentTypes");
+        };
+    }
+
+    template <typename T>
+    inline constexpr ComponentTypeId component_type_id = detail::ComponentTypeIndex<std::remove_cv_t<T>, ComponentTypes>::value;
+
+    template <typename T>
+    inline constexpr uint64_t component_type_bit = uint64_t{1} << component_type_id<T>;
+}
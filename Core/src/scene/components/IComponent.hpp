@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ComponentType.hpp"
+
 #include <nlohmann/json.hpp>
 
 namespace gage::gfx
@@ -28,6 +30,8 @@ namespace gage::scene::components
         //Debug
         virtual void render_imgui() = 0;
         virtual const char* get_name() const = 0;
+        // Index into ComponentTypes, used by Node lookups and SceneGraph routing
+        virtual ComponentTypeId get_type_id() const = 0;
 
     protected:
         SceneGraph& scene;
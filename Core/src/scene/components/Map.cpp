@@ -21,4 +21,59 @@ namespace gage::scene::components
     {
         static_models.push_back(model);
     }
+
+    nlohmann::json Map::to_json() const
+    {
+        auto wall_data_to_json = [](const AABBWallData &data) -> nlohmann::json
+        {
+            return {{"texture", data.texture},
+                    {"uv_scale", {data.uv_scale.x, data.uv_scale.y}},
+                    {"uv_offset", {data.uv_offset.x, data.uv_offset.y}}};
+        };
+
+        nlohmann::json j = {{"type", get_name()}, {"aabb_walls", nlohmann::json::array()}, {"static_models", nlohmann::json::array()}};
+        for (const auto &wall : aabb_walls)
+        {
+            j["aabb_walls"].push_back({{"a", {wall.a.x, wall.a.y, wall.a.z}},
+                                       {"b", {wall.b.x, wall.b.y, wall.b.z}},
+                                       {"front", wall_data_to_json(wall.front)},
+                                       {"back", wall_data_to_json(wall.back)},
+                                       {"left", wall_data_to_json(wall.left)},
+                                       {"right", wall_data_to_json(wall.right)},
+                                       {"top", wall_data_to_json(wall.top)},
+                                       {"bottom", wall_data_to_json(wall.bottom)}});
+        }
+        for (const auto &model : static_models)
+        {
+            j["static_models"].push_back({{"model_path", model.model_path},
+                                          {"offset", {model.offset.x, model.offset.y, model.offset.z}},
+                                          {"rotation", {model.rotation.x, model.rotation.y, model.rotation.z, model.rotation.w}}});
+        }
+        return j;
+    }
+
+    void Map::load_json(const nlohmann::json &j)
+    {
+        auto vec3_from_json = [](const nlohmann::json &v)
+        { return glm::vec3{v.at(0).get<float>(), v.at(1).get<float>(), v.at(2).get<float>()}; };
+        auto vec2_from_json = [](const nlohmann::json &v)
+        { return glm::vec2{v.at(0).get<float>(), v.at(1).get<float>()}; };
+        auto wall_data_from_json = [&](const nlohmann::json &data)
+        { return AABBWallData{data.at("texture").get<std::string>(), vec2_from_json(data.at("uv_scale")), vec2_from_json(data.at("uv_offset"))}; };
+
+        for (const auto &wall : j.at("aabb_walls"))
+        {
+            add_aabb_wall({vec3_from_json(wall.at("a")), vec3_from_json(wall.at("b")),
+                           wall_data_from_json(wall.at("front")), wall_data_from_json(wall.at("back")),
+                           wall_data_from_json(wall.at("left")), wall_data_from_json(wall.at("right")),
+                           wall_data_from_json(wall.at("top")), wall_data_from_json(wall.at("bottom"))});
+        }
+        for (const auto &model : j.at("static_models"))
+        {
+            const auto &rotation = model.at("rotation");
+            // glm::quat takes w first
+            add_static_model({model.at("model_path").get<std::string>(), vec3_from_json(model.at("offset")),
+                              glm::quat{rotation.at(3).get<float>(), rotation.at(0).get<float>(), rotation.at(1).get<float>(), rotation.at(2).get<float>()}});
+        }
+    }
 }
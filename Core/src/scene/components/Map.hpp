@@ -39,13 +39,16 @@ namespace gage::scene::components
         Map(SceneGraph& scene, Node& node);
         ~Map();
 
-        nlohmann::json to_json() const final { return {{"type", get_name()}}; };
+        nlohmann::json to_json() const final;
+        // Adds the walls and static models of a to_json() object
+        void load_json(const nlohmann::json& j);
         
         void add_aabb_wall(AABBWall wall);
         void add_static_model(StaticModel model);
         //Debug
         void render_imgui() {};
         const char* get_name() const { return "Map"; };
+        ComponentTypeId get_type_id() const final { return component_type_id<Map>; }
     public:
         std::vector<AABBWall> aabb_walls{};
         std::vector<StaticModel> static_models{};
@@ -25,7 +25,9 @@ namespace gage::scene::components
 
     nlohmann::json MeshRenderer::to_json() const
     {
-        return { {"type", get_name()}, {"model", model.name} };
+        // Indices into the model so SceneGraph::load can find the same mesh and skin again
+        int32_t skin = joints ? (int32_t)(joints - model.skins.data()) : -1;
+        return { {"type", get_name()}, {"model", model.name}, {"mesh", &model_mesh - model.meshes.data()}, {"skin", skin} };
     }
 
 
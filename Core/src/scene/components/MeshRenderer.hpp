@@ -38,6 +38,7 @@ namespace gage::scene::components
 
         inline void render_imgui() final {};
         inline const char* get_name() const final { return "MeshRenderer"; };
+        inline ComponentTypeId get_type_id() const final { return component_type_id<MeshRenderer>; }
 
         AnimationBuffer& get_animation_buffer();
         const data::ModelSkin* get_skin();
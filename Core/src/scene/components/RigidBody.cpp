@@ -14,6 +14,10 @@ namespace gage::scene::components
         JPH::OffsetCenterOfMassShapeSettings settings(JPH::Vec3(center.x, center.y, center.z), &box_shape);
         return settings.Create();
     }
+    nlohmann::json BoxShape::to_json() const
+    {
+        return {{"type", "Box"}, {"center", {center.x, center.y, center.z}}, {"half_width", {half_width.x, half_width.y, half_width.z}}};
+    }
 
     RigidBody::RigidBody(SceneGraph &scene, Node &node, std::unique_ptr<CollisionShape> shape) : IComponent(scene, node),
                                                                                                  shape(std::move(shape))
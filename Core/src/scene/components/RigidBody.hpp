@@ -24,6 +24,7 @@ namespace gage::scene::components
         virtual ~CollisionShape() = default;
 
         virtual JPH::ShapeSettings::ShapeResult generate_shape() const = 0;
+        virtual nlohmann::json to_json() const = 0;
     };
 
     class BoxShape final : public CollisionShape
@@ -32,6 +33,7 @@ namespace gage::scene::components
         BoxShape(const glm::vec3& center, const glm::vec3& half_width);
 
         JPH::ShapeSettings::ShapeResult generate_shape() const override;
+        nlohmann::json to_json() const override;
     private:
         glm::vec3 center;
         glm::vec3 half_width;
@@ -42,9 +44,10 @@ namespace gage::scene::components
     public:
         RigidBody(SceneGraph& scene, Node& node, std::unique_ptr<CollisionShape> shape);
 
-        nlohmann::json to_json() const final { return {}; };
+        nlohmann::json to_json() const final { return {{"type", get_name()}, {"shape", shape->to_json()}}; };
         void render_imgui() override {};
         inline const char* get_name() const override { return "RigidBody"; };
+        inline ComponentTypeId get_type_id() const final { return component_type_id<RigidBody>; }
     public:
         std::unique_ptr<CollisionShape> shape;
         JPH::BodyID body;
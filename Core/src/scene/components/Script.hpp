@@ -16,6 +16,10 @@ namespace gage::hid
 
 namespace gage::scene::components
 {
+    // update() and late_update() run as task graph jobs on any job system worker, not necessarily the main thread.
+    // No other task of the tick runs at the same time, but scripts must not rely on thread local state
+    // or call main thread only apis (window, ImGui) from them. shutdown() and render_imgui() run on the main thread,
+    // init() on the thread that adds the script once the scene is initialized
     class Script : public IComponent
     {
         friend class systems::Scriptor;
@@ -33,5 +37,6 @@ namespace gage::scene::components
 
         inline virtual void render_imgui()  {};
         inline const char* get_name() const final { return "Script"; };
+        inline ComponentTypeId get_type_id() const final { return component_type_id<Script>; }
     };
 }
\ No newline at end of file
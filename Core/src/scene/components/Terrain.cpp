@@ -4,6 +4,8 @@
 #include "../scene.hpp"
 #include <glm/gtc/integer.hpp>
 
+#include <random>
+
 #include <Core/src/gfx/Graphics.hpp>
 
 #include <imgui/imgui.h>
@@ -18,13 +20,32 @@ namespace gage::scene::components
                                      float scale,
                                      float min_height, float max_height,
                                      float filter) :
+                                                     Terrain(scene, node, gfx, patch_count, patch_size, iteration, scale, min_height, max_height, filter, std::random_device{}())
+    {
+    }
+
+    Terrain::Terrain(SceneGraph &scene, Node &node,
+                                     const gfx::Graphics &gfx,
+                                     uint32_t patch_count,
+                                     uint32_t patch_size,
+                                     uint32_t iteration,
+                                     float scale,
+                                     float min_height, float max_height,
+                                     float filter,
+                                     uint32_t seed) :
 
                                                      IComponent(scene, node),
                                                      gfx(gfx),
                                                      size(0),
                                                      patch_count(patch_count),
                                                      patch_size(patch_size),
-                                                     scale(scale)
+                                                     scale(scale),
+                                                     generated(true),
+                                                     iteration(iteration),
+                                                     min_height(min_height),
+                                                     max_height(max_height),
+                                                     filter(filter),
+                                                     seed(seed)
     {
         // calculate size
         {
@@ -48,8 +69,7 @@ namespace gage::scene::components
 
         // Fault formation
         {
-            std::random_device dev;
-            std::mt19937 rng(dev());
+            std::mt19937 rng(seed);
             std::uniform_int_distribution<uint32_t> dist(0, size);
 
             float delta_height = max_height - min_height;
@@ -294,7 +314,16 @@ namespace gage::scene::components
 
     nlohmann::json Terrain::to_json() const
     {
-        return {};
+        nlohmann::json j = {{"type", get_name()}, {"patch_count", patch_count}, {"patch_size", patch_size}, {"scale", scale}};
+        if (generated)
+        {
+            j["iteration"] = iteration;
+            j["min_height"] = min_height;
+            j["max_height"] = max_height;
+            j["filter"] = filter;
+            j["seed"] = seed;
+        }
+        return j;
     }
 
     bool Terrain::is_inside_frustum(uint32_t x, uint32_t y, const glm::mat4x4 &view, const glm::mat4x4 &proj)
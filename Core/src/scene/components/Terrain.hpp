@@ -37,6 +37,8 @@ namespace gage::scene::components
 
     public:
         Terrain(SceneGraph &scene, Node &node, const gfx::Graphics &gfx, uint32_t patch_count, uint32_t patch_size, uint32_t iteration, float scale, float min_height, float max_height, float filter);
+        // Same seed and parameters generate the same height map, used to load saved scenes
+        Terrain(SceneGraph &scene, Node &node, const gfx::Graphics &gfx, uint32_t patch_count, uint32_t patch_size, uint32_t iteration, float scale, float min_height, float max_height, float filter, uint32_t seed);
         Terrain(SceneGraph &scene, Node &node, const gfx::Graphics &gfx, uint32_t patch_count, uint32_t patch_size, float scale);
         
 
@@ -49,6 +51,7 @@ namespace gage::scene::components
 
         void render_imgui() final;
         inline const char *get_name() const final { return "Terrain"; };
+        inline ComponentTypeId get_type_id() const final { return component_type_id<Terrain>; }
 
     private:
         void generate_vertex_datas();
@@ -65,5 +68,13 @@ namespace gage::scene::components
         std::vector<float> height_map{};
         std::vector<Vertex> vertex_data;
         std::vector<uint32_t> indices_data;
+
+        // Fault formation parameters, the height map is flat when it was not generated
+        bool generated{};
+        uint32_t iteration{};
+        float min_height{};
+        float max_height{};
+        float filter{};
+        uint32_t seed{};
     };
 }
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include <pch.hpp>
+#include "AccessorView.hpp"
+
+#include "../scene.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace gage::scene::data
+{
+    static void widen_u16_to_u32(const unsigned char *source, uint32_t *destination, size_t count)
+    {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * sizeof(uint16_t)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), _mm_unpacklo_epi16(values, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i + 4), _mm_unpackhi_epi16(values, zero));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            uint16_t value;
+            std::memcpy(&value, source + i * sizeof(uint16_t), sizeof(uint16_t));
+            destination[i] = value;
+        }
+    }
+
+    static void widen_u8_to_u16(const unsigned char *source, uint16_t *destination, size_t count)
+    {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), _mm_unpacklo_epi8(values, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i + 8), _mm_unpackhi_epi8(values, zero));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            destination[i] = source[i];
+        }
+    }
+
+    static void normalize_u8_to_float(const unsigned char *source, float *destination, size_t count)
+    {
+        constexpr float scale = 1.0f / 255.0f;
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale4 = _mm_set1_ps(scale);
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+            __m128i low = _mm_unpacklo_epi8(values, zero);
+            __m128i high = _mm_unpackhi_epi8(values, zero);
+            _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale4));
+            _mm_storeu_ps(destination + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale4));
+            _mm_storeu_ps(destination + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale4));
+            _mm_storeu_ps(destination + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale4));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            destination[i] = source[i] * scale;
+        }
+    }
+
+    static void normalize_u16_to_float(const unsigned char *source, float *destination, size_t count)
+    {
+        constexpr float scale = 1.0f / 65535.0f;
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale4 = _mm_set1_ps(scale);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * sizeof(uint16_t)));
+            _mm_storeu_ps(destination + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(values, zero)), scale4));
+            _mm_storeu_ps(destination + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(values, zero)), scale4));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            uint16_t value;
+            std::memcpy(&value, source + i * sizeof(uint16_t), sizeof(uint16_t));
+            destination[i] = value * scale;
+        }
+    }
+
+    AccessorView::AccessorView(const tinygltf::Model &model, const tinygltf::Accessor &accessor) :
+        count(accessor.count),
+        component_type(accessor.componentType),
+        normalized(accessor.normalized)
+    {
+        auto fail = [](const char *reason)
+        {
+            log().critical("Invalid gltf accessor: {}", reason);
+            throw SceneException{std::string("Invalid gltf accessor: ") + reason};
+        };
+
+        int size = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+        int components = tinygltf::GetNumComponentsInType(accessor.type);
+        if (size <= 0 || components <= 0)
+            fail("Unknown component type");
+        component_size = size;
+        component_count = components;
+        stride = component_size * component_count;
+
+        if (accessor.sparse.isSparse)
+            fail("Sparse accessors are not supported");
+        if (accessor.bufferView < 0)
+            return;
+
+        const auto &buffer_view = model.bufferViews.at(accessor.bufferView);
+        const auto &buffer = model.buffers.at(buffer_view.buffer);
+        int byte_stride = accessor.ByteStride(buffer_view);
+        if (byte_stride <= 0)
+            fail("Invalid byte stride");
+        stride = byte_stride;
+
+        uint64_t accessed_bytes = count == 0 ? 0 : uint64_t(stride) * (count - 1) + component_size * component_count;
+        if (uint64_t(buffer_view.byteOffset) + buffer_view.byteLength > buffer.data.size() ||
+            uint64_t(accessor.byteOffset) + accessed_bytes > buffer_view.byteLength)
+            fail("Out of buffer range");
+        data = buffer.data.data() + buffer_view.byteOffset + accessor.byteOffset;
+    }
+
+    void AccessorView::read(std::span<uint32_t> out) const
+    {
+        check_components(1);
+        assert(out.size() == count);
+        if (data && is_tightly_packed() && component_type == UNSIGNED_INT)
+            std::memcpy(out.data(), data, out.size_bytes());
+        else if (data && is_tightly_packed() && component_type == UNSIGNED_SHORT)
+            widen_u16_to_u32(data, out.data(), count);
+        else
+            read_elements(out);
+    }
+
+    void AccessorView::read(std::span<glm::vec<4, uint16_t>> out) const
+    {
+        check_components(4);
+        assert(out.size() == count);
+        if (data && is_tightly_packed() && component_type == UNSIGNED_SHORT)
+            std::memcpy(out.data(), data, out.size_bytes());
+        else if (data && is_tightly_packed() && component_type == UNSIGNED_BYTE)
+            widen_u8_to_u16(data, reinterpret_cast<uint16_t *>(out.data()), size_t(count) * 4);
+        else
+            read_elements(out);
+    }
+
+    void AccessorView::read(std::span<float> out) const
+    {
+        check_components(1);
+        assert(out.size() == count);
+        read_floats(out.data());
+    }
+
+    void AccessorView::read(std::span<glm::vec2> out) const
+    {
+        static_assert(sizeof(glm::vec2) == sizeof(float) * 2);
+        check_components(2);
+        assert(out.size() == count);
+        read_floats(reinterpret_cast<float *>(out.data()));
+    }
+
+    void AccessorView::read(std::span<glm::vec3> out) const
+    {
+        static_assert(sizeof(glm::vec3) == sizeof(float) * 3);
+        check_components(3);
+        assert(out.size() == count);
+        read_floats(reinterpret_cast<float *>(out.data()));
+    }
+
+    void AccessorView::read(std::span<glm::vec4> out) const
+    {
+        static_assert(sizeof(glm::vec4) == sizeof(float) * 4);
+        check_components(4);
+        assert(out.size() == count);
+        read_floats(reinterpret_cast<float *>(out.data()));
+    }
+
+    void AccessorView::read_floats(float *out) const
+    {
+        size_t float_count = size_t(count) * component_count;
+        if (!data)
+        {
+            std::fill(out, out + float_count, 0.0f);
+        }
+        else if (is_tightly_packed() && component_type == FLOAT)
+        {
+            std::memcpy(out, data, float_count * sizeof(float));
+        }
+        else if (is_tightly_packed() && normalized && component_type == UNSIGNED_BYTE)
+        {
+            normalize_u8_to_float(data, out, float_count);
+        }
+        else if (is_tightly_packed() && normalized && component_type == UNSIGNED_SHORT)
+        {
+            normalize_u16_to_float(data, out, float_count);
+        }
+        else
+        {
+            // Strided or signed data, the components are converted one by one
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const unsigned char *element = data + size_t(i) * stride;
+                for (uint32_t c = 0; c < component_count; c++)
+                {
+                    out[size_t(i) * component_count + c] = get_component<float>(element, c);
+                }
+            }
+        }
+    }
+
+    void AccessorView::check_components(uint32_t expected) const
+    {
+        if (component_count != expected)
+        {
+            log().critical("Gltf accessor has {} components, {} expected", component_count, expected);
+            throw SceneException{"Gltf accessor has an unexpected type"};
+        }
+    }
+}
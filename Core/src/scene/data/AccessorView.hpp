@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace tinygltf
+{
+    class Model;
+    struct Accessor;
+}
+
+namespace gage::scene::data
+{
+    // Elements of a gltf accessor read in place from the buffer, honouring the accessor and buffer view offsets
+    // and the byte stride. Elements are converted to the requested type (a scalar or a glm vector) component by
+    // component, normalized integers become floats in [0, 1] or [-1, 1]. Views are only valid while the model is alive.
+    class AccessorView
+    {
+        enum ComponentType : int
+        {
+            BYTE = 5120,
+            UNSIGNED_BYTE = 5121,
+            SHORT = 5122,
+            UNSIGNED_SHORT = 5123,
+            UNSIGNED_INT = 5125,
+            FLOAT = 5126
+        };
+    public:
+        template <typename T>
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = T;
+
+            Iterator() = default;
+            Iterator(const AccessorView *view, uint32_t index) : view(view), index(index) {}
+
+            T operator*() const { return view->get<T>(index); }
+            Iterator &operator++()
+            {
+                index++;
+                return *this;
+            }
+            Iterator operator++(int)
+            {
+                Iterator previous = *this;
+                index++;
+                return previous;
+            }
+            bool operator==(const Iterator &other) const = default;
+        private:
+            const AccessorView *view{};
+            uint32_t index{};
+        };
+
+        template <typename T>
+        struct Range
+        {
+            Iterator<T> first{};
+            Iterator<T> last{};
+            Iterator<T> begin() const { return first; }
+            Iterator<T> end() const { return last; }
+        };
+    public:
+        // Throws SceneException if the accessor is sparse, has an unknown type or does not fit in its buffer view.
+        // Accessors without a buffer view read as zeroes
+        AccessorView(const tinygltf::Model &model, const tinygltf::Accessor &accessor);
+
+        uint32_t size() const { return count; }
+        uint32_t get_component_count() const { return component_count; }
+
+        template <typename T>
+        T get(uint32_t index) const
+        {
+            T value{};
+            if (!data)
+                return value;
+            const unsigned char *element = data + size_t(index) * stride;
+            if constexpr (std::is_arithmetic_v<T>)
+            {
+                value = get_component<T>(element, 0);
+            }
+            else
+            {
+                for (int c = 0; c < T::length(); c++)
+                {
+                    value[c] = get_component<typename T::value_type>(element, c);
+                }
+            }
+            return value;
+        }
+
+        // Converting range over every element, T must have as many components as the accessor
+        template <typename T>
+        Range<T> as() const
+        {
+            check_components(get_length<T>());
+            return Range<T>{Iterator<T>(this, 0), Iterator<T>(this, count)};
+        }
+
+        // Converts every element into out, out.size() must be size() and T must have as many components as the accessor.
+        // Tightly packed data is copied or converted in bulk (SSE2) for the common cases:
+        // 16 bit indices, 8 bit joints, normalized 8 and 16 bit attributes
+        void read(std::span<uint32_t> out) const;
+        void read(std::span<glm::vec<4, uint16_t>> out) const;
+        void read(std::span<float> out) const;
+        void read(std::span<glm::vec2> out) const;
+        void read(std::span<glm::vec3> out) const;
+        void read(std::span<glm::vec4> out) const;
+    private:
+        template <typename T>
+        static constexpr uint32_t get_length()
+        {
+            if constexpr (std::is_arithmetic_v<T>)
+                return 1;
+            else
+                return T::length();
+        }
+
+        template <typename S>
+        static S load(const unsigned char *source)
+        {
+            S value;
+            std::memcpy(&value, source, sizeof(S));
+            return value;
+        }
+
+        template <typename C, typename S>
+        C convert(S value) const
+        {
+            if constexpr (std::is_floating_point_v<C> && std::is_integral_v<S>)
+            {
+                if (normalized)
+                {
+                    C normalized_value = C(value) / C(std::numeric_limits<S>::max());
+                    return std::is_signed_v<S> && normalized_value < C(-1) ? C(-1) : normalized_value;
+                }
+            }
+            return static_cast<C>(value);
+        }
+
+        // Components the accessor does not have read as zero
+        template <typename C>
+        C get_component(const unsigned char *element, uint32_t component) const
+        {
+            if (component >= component_count)
+                return C{};
+            const unsigned char *source = element + component * component_size;
+            switch (component_type)
+            {
+            case BYTE:
+                return convert<C>(load<int8_t>(source));
+            case UNSIGNED_BYTE:
+                return convert<C>(load<uint8_t>(source));
+            case SHORT:
+                return convert<C>(load<int16_t>(source));
+            case UNSIGNED_SHORT:
+                return convert<C>(load<uint16_t>(source));
+            case UNSIGNED_INT:
+                return convert<C>(load<uint32_t>(source));
+            case FLOAT:
+                return convert<C>(load<float>(source));
+            }
+            return C{};
+        }
+
+        template <typename T>
+        void read_elements(std::span<T> out) const
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                out[i] = get<T>(i);
+            }
+        }
+
+        // size() * component_count floats
+        void read_floats(float *out) const;
+        void check_components(uint32_t expected) const;
+        bool is_tightly_packed() const { return stride == component_size * component_count; }
+    private:
+        const unsigned char *data{};
+        uint32_t count{};
+        uint32_t stride{};
+        uint32_t component_size{};
+        uint32_t component_count{};
+        int component_type{};
+        bool normalized{};
+    };
+}
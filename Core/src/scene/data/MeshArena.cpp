@@ -0,0 +1,107 @@
+#include <pch.hpp>
+#include "MeshArena.hpp"
+
+#include <Core/src/gfx/Graphics.hpp>
+
+namespace gage::scene::data
+{
+    MeshAllocation::MeshAllocation(MeshArena &arena, VertexLayout vertex_layout, VkIndexType index_type,
+        gfx::data::BufferArena::Range vertices, gfx::data::BufferArena::Range indices) :
+        arena(&arena),
+        vertex_layout(vertex_layout),
+        index_type(index_type),
+        vertices(vertices),
+        indices(indices)
+    {
+    }
+
+    MeshAllocation::~MeshAllocation()
+    {
+        release();
+    }
+
+    MeshAllocation::MeshAllocation(MeshAllocation &&other) :
+        arena(other.arena),
+        vertex_layout(other.vertex_layout),
+        index_type(other.index_type),
+        vertices(other.vertices),
+        indices(other.indices)
+    {
+        other.arena = nullptr;
+    }
+
+    MeshAllocation &MeshAllocation::operator=(MeshAllocation &&other)
+    {
+        if (this != &other)
+        {
+            release();
+            arena = other.arena;
+            vertex_layout = other.vertex_layout;
+            index_type = other.index_type;
+            vertices = other.vertices;
+            indices = other.indices;
+            other.arena = nullptr;
+        }
+        return *this;
+    }
+
+    void MeshAllocation::release()
+    {
+        if (!arena)
+            return;
+        arena->vertex_arenas[(uint32_t)vertex_layout]->free(vertices);
+        arena->index_arena->free(indices);
+        arena = nullptr;
+    }
+
+    MeshArena::MeshArena(const gfx::Graphics &gfx)
+    {
+        for (uint32_t layout = 0; layout < VERTEX_LAYOUT_COUNT; layout++)
+        {
+            std::vector<uint32_t> strides{};
+            for (const auto &format : get_vertex_attribute_formats((VertexLayout)layout))
+            {
+                strides.push_back(format.stride);
+            }
+            vertex_arenas[layout] = std::make_unique<gfx::data::BufferArena>(gfx, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, std::move(strides), VERTEX_BLOCK_SIZE);
+        }
+        index_arena = std::make_unique<gfx::data::BufferArena>(gfx, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, std::vector<uint32_t>{sizeof(uint32_t)}, INDEX_BLOCK_SIZE);
+    }
+
+    MeshArena::~MeshArena()
+    {
+
+    }
+
+    MeshAllocation MeshArena::allocate(gfx::data::UploadBatch &batch, VertexLayout vertex_layout, uint32_t vertex_count,
+        std::span<const std::span<const unsigned char>, VERTEX_ATTRIBUTE_COUNT> streams,
+        std::span<const unsigned char> indices, VkIndexType index_type)
+    {
+        assert(vertex_count != 0 && !indices.empty());
+        // Index ranges are counted in 32 bit words so the first index of either type lands on a whole index
+        uint32_t index_words = (indices.size() + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+        auto vertex_range = vertex_arenas[(uint32_t)vertex_layout]->allocate(batch, vertex_count, streams);
+        auto index_range = index_arena->allocate(batch, index_words, std::span(&indices, 1));
+        return MeshAllocation(*this, vertex_layout, index_type, vertex_range, index_range);
+    }
+
+    std::span<const VkBuffer> MeshArena::get_vertex_buffers(VertexLayout vertex_layout, uint32_t block) const
+    {
+        return vertex_arenas[(uint32_t)vertex_layout]->get_buffers(block);
+    }
+
+    VkBuffer MeshArena::get_index_buffer(uint32_t block) const
+    {
+        return index_arena->get_buffers(block)[0];
+    }
+
+    size_t MeshArena::get_allocated_bytes() const
+    {
+        size_t bytes = index_arena->get_allocated_bytes();
+        for (const auto &vertex_arena : vertex_arenas)
+        {
+            bytes += vertex_arena->get_allocated_bytes();
+        }
+        return bytes;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <span>
+
+#include <Core/src/gfx/data/BufferArena.hpp>
+
+#include "VertexQuantization.hpp"
+
+namespace gage::gfx
+{
+    class Graphics;
+}
+
+namespace gage::scene::data
+{
+    class MeshArena;
+
+    // Ranges of one primitive in the mesh arena, given back when it is destroyed
+    class MeshAllocation
+    {
+    public:
+        MeshAllocation() = default;
+        MeshAllocation(MeshArena& arena, VertexLayout vertex_layout, VkIndexType index_type,
+            gfx::data::BufferArena::Range vertices, gfx::data::BufferArena::Range indices);
+        ~MeshAllocation();
+
+        MeshAllocation(MeshAllocation&& other);
+        MeshAllocation& operator=(MeshAllocation&& other);
+        MeshAllocation(const MeshAllocation&) = delete;
+        MeshAllocation operator=(const MeshAllocation&) = delete;
+
+        uint32_t get_vertex_block() const { return vertices.block; }
+        int32_t get_base_vertex() const { return vertices.first; }
+        uint32_t get_index_block() const { return indices.block; }
+        // In indices of index_type, the index buffer of every block holds both types
+        uint32_t get_first_index() const { return indices.first * (index_type == VK_INDEX_TYPE_UINT16 ? 2 : 1); }
+    private:
+        void release();
+    private:
+        MeshArena* arena{};
+        VertexLayout vertex_layout{};
+        VkIndexType index_type{VK_INDEX_TYPE_UINT32};
+        gfx::data::BufferArena::Range vertices{};
+        gfx::data::BufferArena::Range indices{};
+    };
+
+    // Vertex and index data of every loaded model primitive, sub-allocated from a few large buffers so draws address
+    // their primitive by base vertex and first index and buffers are only rebound between blocks.
+    // Each vertex layout has its own arena with one buffer per attribute stream
+    class MeshArena
+    {
+        friend class MeshAllocation;
+    public:
+        MeshArena(const gfx::Graphics& gfx);
+        ~MeshArena();
+
+        MeshArena(const MeshArena&) = delete;
+        MeshArena operator=(const MeshArena&) = delete;
+
+        // Streams are position, normal, texcoord, bone id and bone weight in the formats of vertex_layout.
+        // Records the upload into batch, the primitive can be drawn once the batch completed
+        MeshAllocation allocate(gfx::data::UploadBatch& batch, VertexLayout vertex_layout, uint32_t vertex_count,
+            std::span<const std::span<const unsigned char>, VERTEX_ATTRIBUTE_COUNT> streams,
+            std::span<const unsigned char> indices, VkIndexType index_type);
+
+        // One buffer per vertex attribute
+        std::span<const VkBuffer> get_vertex_buffers(VertexLayout vertex_layout, uint32_t block) const;
+        VkBuffer get_index_buffer(uint32_t block) const;
+        size_t get_allocated_bytes() const;
+    private:
+        static constexpr uint32_t VERTEX_BLOCK_SIZE = 1 << 18;       // Vertices
+        static constexpr uint32_t INDEX_BLOCK_SIZE = 1 << 20;        // 32 bit words, two 16 bit indices each
+        std::array<std::unique_ptr<gfx::data::BufferArena>, VERTEX_LAYOUT_COUNT> vertex_arenas{};
+        std::unique_ptr<gfx::data::BufferArena> index_arena{};
+    };
+}
@@ -0,0 +1,745 @@
+#include <pch.hpp>
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
+namespace gage::scene::data
+{
+    static constexpr uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+
+    // FNV-1a
+    static uint64_t hash_bytes(const unsigned char *bytes, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static glm::vec3 load_position(const VertexStream &positions, uint32_t vertex)
+    {
+        glm::vec3 position;
+        std::memcpy(&position, positions.data + size_t(vertex) * positions.stride, sizeof(glm::vec3));
+        return position;
+    }
+
+    static float compute_acmr(std::span<const uint32_t> indices, uint32_t vertex_count)
+    {
+        constexpr uint32_t CACHE_SIZE = 16;
+        if (indices.size() < 3)
+            return 0.0f;
+
+        // FIFO cache, a vertex is in the cache while its insertion time is less than CACHE_SIZE misses ago
+        std::vector<uint32_t> insertion_time(vertex_count, 0);
+        uint32_t misses = 0;
+        for (uint32_t index : indices)
+        {
+            if (insertion_time[index] == 0 || misses + 1 - insertion_time[index] > CACHE_SIZE)
+            {
+                misses++;
+                insertion_time[index] = misses;
+            }
+        }
+        return float(misses) / float(indices.size() / 3);
+    }
+
+    static uint32_t weld_vertices(std::span<uint32_t> indices, std::span<const VertexStream> streams, uint32_t vertex_count)
+    {
+        auto hash_vertex = [&](uint32_t vertex) -> uint64_t
+        {
+            uint64_t hash = 14695981039346656037ull;
+            for (const VertexStream &stream : streams)
+            {
+                hash = hash_bytes(stream.data + vertex * stream.stride, stream.stride, hash);
+            }
+            return hash;
+        };
+        auto equal_vertices = [&](uint32_t a, uint32_t b) -> bool
+        {
+            for (const VertexStream &stream : streams)
+            {
+                if (std::memcmp(stream.data + a * stream.stride, stream.data + b * stream.stride, stream.stride) != 0)
+                    return false;
+            }
+            return true;
+        };
+
+        // Open addressing, the table holds the compacted index of every unique value. Compacted vertices are
+        // written at or before the one being read, so unique values already seen are never overwritten
+        size_t table_size = 1;
+        while (table_size < size_t(vertex_count) * 2)
+            table_size *= 2;
+        std::vector<uint32_t> table(table_size, NO_VERTEX);
+        std::vector<uint32_t> remap(vertex_count);
+        uint32_t unique_count = 0;
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            size_t slot = hash_vertex(vertex) & (table_size - 1);
+            while (table[slot] != NO_VERTEX && !equal_vertices(table[slot], vertex))
+                slot = (slot + 1) & (table_size - 1);
+
+            if (table[slot] == NO_VERTEX)
+            {
+                table[slot] = unique_count;
+                for (const VertexStream &stream : streams)
+                {
+                    std::memmove(stream.data + unique_count * stream.stride, stream.data + vertex * stream.stride, stream.stride);
+                }
+                remap[vertex] = unique_count++;
+            }
+            else
+            {
+                remap[vertex] = table[slot];
+            }
+        }
+
+        for (uint32_t &index : indices)
+        {
+            index = remap[index];
+        }
+        return unique_count;
+    }
+
+    // Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+    static void optimize_vertex_cache(std::span<uint32_t> indices, uint32_t vertex_count)
+    {
+        constexpr uint32_t CACHE_SIZE = 32;
+        constexpr float CACHE_DECAY_POWER = 1.5f;
+        constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+        constexpr float VALENCE_BOOST_SCALE = 2.0f;
+        constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+        uint32_t triangle_count = indices.size() / 3;
+        if (triangle_count == 0)
+            return;
+
+        // Triangles of every vertex
+        std::vector<uint32_t> first_triangle(vertex_count + 1, 0);
+        for (uint32_t index : indices)
+            first_triangle[index + 1]++;
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            first_triangle[vertex + 1] += first_triangle[vertex];
+        std::vector<uint32_t> vertex_triangles(indices.size());
+        {
+            std::vector<uint32_t> fill(first_triangle.begin(), first_triangle.end() - 1);
+            for (uint32_t i = 0; i < indices.size(); i++)
+                vertex_triangles[fill[indices[i]]++] = i / 3;
+        }
+
+        std::vector<uint32_t> active_triangles(vertex_count);
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            active_triangles[vertex] = first_triangle[vertex + 1] - first_triangle[vertex];
+        std::vector<int32_t> cache_position(vertex_count, -1);
+
+        auto vertex_score = [&](uint32_t vertex) -> float
+        {
+            if (active_triangles[vertex] == 0)
+                return -1.0f;
+            float score = 0.0f;
+            int32_t position = cache_position[vertex];
+            if (position >= 0)
+            {
+                if (position < 3)
+                {
+                    score = LAST_TRIANGLE_SCORE;
+                }
+                else
+                {
+                    float scaler = 1.0f / (CACHE_SIZE - 3);
+                    score = std::pow(1.0f - (position - 3) * scaler, CACHE_DECAY_POWER);
+                }
+            }
+            return score + VALENCE_BOOST_SCALE * std::pow(float(active_triangles[vertex]), -VALENCE_BOOST_POWER);
+        };
+
+        std::vector<float> vertex_scores(vertex_count);
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            vertex_scores[vertex] = vertex_score(vertex);
+        std::vector<float> triangle_scores(triangle_count);
+        for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+        {
+            triangle_scores[triangle] = vertex_scores[indices[triangle * 3]] + vertex_scores[indices[triangle * 3 + 1]] + vertex_scores[indices[triangle * 3 + 2]];
+        }
+
+        std::vector<bool> emitted(triangle_count, false);
+        std::vector<uint32_t> output{};
+        output.reserve(indices.size());
+        std::vector<uint32_t> cache{};
+        std::vector<uint32_t> new_cache{};
+        cache.reserve(CACHE_SIZE + 3);
+        new_cache.reserve(CACHE_SIZE + 3);
+
+        uint32_t best_triangle = 0;
+        uint32_t next_unemitted = 0;
+        for (uint32_t emitted_count = 0; emitted_count < triangle_count; emitted_count++)
+        {
+            emitted[best_triangle] = true;
+            const uint32_t *triangle = &indices[best_triangle * 3];
+            output.insert(output.end(), triangle, triangle + 3);
+
+            // The triangle's vertices move to the front of the LRU cache
+            new_cache.assign(triangle, triangle + 3);
+            for (uint32_t vertex : cache)
+            {
+                if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                    new_cache.push_back(vertex);
+            }
+            for (uint32_t v = 0; v < 3; v++)
+            {
+                uint32_t vertex = triangle[v];
+                uint32_t begin = first_triangle[vertex];
+                uint32_t end = begin + active_triangles[vertex];
+                for (uint32_t t = begin; t < end; t++)
+                {
+                    if (vertex_triangles[t] == best_triangle)
+                    {
+                        std::swap(vertex_triangles[t], vertex_triangles[end - 1]);
+                        break;
+                    }
+                }
+                active_triangles[vertex]--;
+            }
+
+            // Rescore what is or was in the cache, only their triangles can change score
+            for (uint32_t i = 0; i < new_cache.size(); i++)
+            {
+                uint32_t vertex = new_cache[i];
+                cache_position[vertex] = i < CACHE_SIZE ? int32_t(i) : -1;
+            }
+            float best_score = -1.0f;
+            for (uint32_t vertex : new_cache)
+            {
+                float delta = vertex_score(vertex) - vertex_scores[vertex];
+                vertex_scores[vertex] += delta;
+                uint32_t begin = first_triangle[vertex];
+                for (uint32_t t = begin; t < begin + active_triangles[vertex]; t++)
+                {
+                    uint32_t candidate = vertex_triangles[t];
+                    triangle_scores[candidate] += delta;
+                    if (triangle_scores[candidate] > best_score)
+                    {
+                        best_score = triangle_scores[candidate];
+                        best_triangle = candidate;
+                    }
+                }
+            }
+            if (new_cache.size() > CACHE_SIZE)
+                new_cache.resize(CACHE_SIZE);
+            std::swap(cache, new_cache);
+
+            // Nothing in the cache has triangles left, continue with the next unemitted one
+            if (best_score < 0.0f && emitted_count + 1 < triangle_count)
+            {
+                while (emitted[next_unemitted])
+                    next_unemitted++;
+                best_triangle = next_unemitted;
+            }
+        }
+
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    // Sander, Nehab, Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+    // The cache optimized order is cut into clusters where the cache restarts (a triangle misses all three vertices),
+    // clusters facing away from the mesh centre are drawn first so they occlude the inner ones
+    static void optimize_overdraw(std::span<uint32_t> indices, const VertexStream &positions, uint32_t vertex_count)
+    {
+        uint32_t triangle_count = indices.size() / 3;
+        if (triangle_count < 2)
+            return;
+
+        std::vector<uint32_t> cluster_starts{0};
+        {
+            constexpr uint32_t CACHE_SIZE = 16;
+            std::vector<uint32_t> insertion_time(vertex_count, 0);
+            uint32_t misses = 0;
+            for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+            {
+                uint32_t triangle_misses = 0;
+                for (uint32_t v = 0; v < 3; v++)
+                {
+                    uint32_t index = indices[triangle * 3 + v];
+                    if (insertion_time[index] == 0 || misses + 1 - insertion_time[index] > CACHE_SIZE)
+                    {
+                        misses++;
+                        triangle_misses++;
+                        insertion_time[index] = misses;
+                    }
+                }
+                if (triangle_misses == 3 && triangle != 0)
+                    cluster_starts.push_back(triangle);
+            }
+        }
+        if (cluster_starts.size() < 2)
+            return;
+        cluster_starts.push_back(triangle_count);
+
+        glm::vec3 mesh_centroid{0.0f};
+        float mesh_area = 0.0f;
+        struct Cluster
+        {
+            uint32_t first_triangle{};
+            uint32_t triangle_count{};
+            glm::vec3 centroid{};
+            glm::vec3 normal{};
+            float sort_key{};
+        };
+        std::vector<Cluster> clusters(cluster_starts.size() - 1);
+        for (uint32_t i = 0; i < clusters.size(); i++)
+        {
+            Cluster &cluster = clusters[i];
+            cluster.first_triangle = cluster_starts[i];
+            cluster.triangle_count = cluster_starts[i + 1] - cluster_starts[i];
+            float cluster_area = 0.0f;
+            for (uint32_t triangle = cluster.first_triangle; triangle < cluster.first_triangle + cluster.triangle_count; triangle++)
+            {
+                glm::vec3 a = load_position(positions, indices[triangle * 3]);
+                glm::vec3 b = load_position(positions, indices[triangle * 3 + 1]);
+                glm::vec3 c = load_position(positions, indices[triangle * 3 + 2]);
+                glm::vec3 normal = glm::cross(b - a, c - a); // Length is twice the area
+                float area = glm::length(normal);
+                glm::vec3 centroid = (a + b + c) / 3.0f;
+                cluster.centroid += centroid * area;
+                cluster.normal += normal;
+                cluster_area += area;
+            }
+            mesh_centroid += cluster.centroid;
+            mesh_area += cluster_area;
+            cluster.centroid = cluster_area > 0.0f ? cluster.centroid / cluster_area : glm::vec3{0.0f};
+        }
+        mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : glm::vec3{0.0f};
+
+        for (Cluster &cluster : clusters)
+        {
+            float length = glm::length(cluster.normal);
+            glm::vec3 normal = length > 0.0f ? cluster.normal / length : glm::vec3{0.0f};
+            cluster.sort_key = glm::dot(cluster.centroid - mesh_centroid, normal);
+        }
+        std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b)
+                         { return a.sort_key > b.sort_key; });
+
+        std::vector<uint32_t> output{};
+        output.reserve(indices.size());
+        for (const Cluster &cluster : clusters)
+        {
+            auto first = indices.begin() + cluster.first_triangle * 3;
+            output.insert(output.end(), first, first + cluster.triangle_count * 3);
+        }
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    static void optimize_vertex_fetch(std::span<uint32_t> indices, std::span<const VertexStream> streams, uint32_t vertex_count)
+    {
+        std::vector<uint32_t> remap(vertex_count, NO_VERTEX);
+        uint32_t next_vertex = 0;
+        for (uint32_t &index : indices)
+        {
+            if (remap[index] == NO_VERTEX)
+                remap[index] = next_vertex++;
+            index = remap[index];
+        }
+
+        // Vertices no triangle uses go last
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            if (remap[vertex] == NO_VERTEX)
+                remap[vertex] = next_vertex++;
+        }
+
+        std::vector<unsigned char> scratch{};
+        for (const VertexStream &stream : streams)
+        {
+            scratch.resize(vertex_count * stream.stride);
+            for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            {
+                std::memcpy(scratch.data() + remap[vertex] * stream.stride, stream.data + vertex * stream.stride, stream.stride);
+            }
+            std::memcpy(stream.data, scratch.data(), scratch.size());
+        }
+    }
+
+    static void optimize_triangle_order(std::span<uint32_t> indices, const VertexStream &positions, uint32_t vertex_count)
+    {
+        optimize_vertex_cache(indices, vertex_count);
+        optimize_overdraw(indices, positions, vertex_count);
+    }
+
+    // Garland, Heckbert, "Surface Simplification Using Quadric Error Metrics".
+    // Sum of weighted squared distances to planes: p^T A p + 2 b^T p + c, A is symmetric
+    struct Quadric
+    {
+        double a00{}, a11{}, a22{}, a01{}, a02{}, a12{};
+        double b0{}, b1{}, b2{};
+        double c{};
+        double weight{};
+
+        // Plane dot(normal, p) + distance = 0, normal has unit length
+        static Quadric from_plane(glm::vec3 normal, float distance, float weight)
+        {
+            Quadric q{};
+            q.a00 = weight * normal.x * normal.x;
+            q.a11 = weight * normal.y * normal.y;
+            q.a22 = weight * normal.z * normal.z;
+            q.a01 = weight * normal.x * normal.y;
+            q.a02 = weight * normal.x * normal.z;
+            q.a12 = weight * normal.y * normal.z;
+            q.b0 = weight * normal.x * distance;
+            q.b1 = weight * normal.y * distance;
+            q.b2 = weight * normal.z * distance;
+            q.c = weight * double(distance) * distance;
+            q.weight = weight;
+            return q;
+        }
+
+        Quadric &operator+=(const Quadric &other)
+        {
+            a00 += other.a00;
+            a11 += other.a11;
+            a22 += other.a22;
+            a01 += other.a01;
+            a02 += other.a02;
+            a12 += other.a12;
+            b0 += other.b0;
+            b1 += other.b1;
+            b2 += other.b2;
+            c += other.c;
+            weight += other.weight;
+            return *this;
+        }
+
+        // Weighted mean of the squared distances
+        double error(glm::vec3 p) const
+        {
+            if (weight <= 0.0)
+                return 0.0;
+            double x = p.x, y = p.y, z = p.z;
+            double sum = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                         2.0 * (b0 * x + b1 * y + b2 * z) + c;
+            return std::max(sum / weight, 0.0);
+        }
+    };
+
+    enum class VertexKind : uint8_t
+    {
+        Manifold, // Can collapse onto any neighbour
+        Border,   // On one open edge loop, can only collapse along it
+        Locked    // Attribute seams and non manifold vertices stay
+    };
+
+    std::vector<uint32_t> simplify_mesh(std::span<const uint32_t> indices, const VertexStream &positions, uint32_t vertex_count,
+                                        size_t target_index_count, float target_error, std::span<const uint32_t> vertex_groups, float &result_error)
+    {
+        constexpr float BORDER_WEIGHT = 10.0f;
+        constexpr float MAX_FLIP_COSINE = 0.25f; // Triangles may turn up to about 75 degrees
+        assert(indices.size() % 3 == 0);
+        assert(vertex_groups.empty() || vertex_groups.size() == vertex_count);
+
+        std::vector<uint32_t> result(indices.begin(), indices.end());
+        result_error = 0.0f;
+        if (result.size() <= target_index_count || vertex_count == 0)
+            return result;
+
+        // Vertices at the same position (attribute seams) share the id of the first one for the topology
+        std::vector<uint32_t> position_ids(vertex_count);
+        std::vector<uint32_t> wedge_counts(vertex_count, 0);
+        {
+            size_t table_size = 1;
+            while (table_size < size_t(vertex_count) * 2)
+                table_size *= 2;
+            std::vector<uint32_t> table(table_size, NO_VERTEX);
+            for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+            {
+                const unsigned char *position = positions.data + size_t(vertex) * positions.stride;
+                size_t slot = hash_bytes(position, sizeof(glm::vec3)) & (table_size - 1);
+                while (table[slot] != NO_VERTEX && std::memcmp(positions.data + size_t(table[slot]) * positions.stride, position, sizeof(glm::vec3)) != 0)
+                    slot = (slot + 1) & (table_size - 1);
+                if (table[slot] == NO_VERTEX)
+                    table[slot] = vertex;
+                position_ids[vertex] = table[slot];
+                wedge_counts[table[slot]]++;
+            }
+        }
+
+        // An edge is open when no triangle has it the other way around
+        std::unordered_set<uint64_t> edges{};
+        edges.reserve(result.size());
+        auto edge_key = [](uint32_t from, uint32_t to) -> uint64_t
+        {
+            return (uint64_t(from) << 32) | to;
+        };
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                edges.insert(edge_key(position_ids[result[i + e]], position_ids[result[i + (e + 1) % 3]]));
+            }
+        }
+        auto is_open = [&](uint32_t from, uint32_t to) -> bool
+        {
+            return edges.find(edge_key(to, from)) == edges.end();
+        };
+        auto is_border_edge = [&](uint32_t a, uint32_t b) -> bool
+        {
+            // At least one of the directions is used
+            return edges.find(edge_key(a, b)) == edges.end() || edges.find(edge_key(b, a)) == edges.end();
+        };
+
+        std::vector<uint32_t> open_out(vertex_count, 0);
+        std::vector<uint32_t> open_in(vertex_count, 0);
+        std::vector<Quadric> quadrics(vertex_count);
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            uint32_t ids[3] = {position_ids[result[i]], position_ids[result[i + 1]], position_ids[result[i + 2]]};
+            glm::vec3 p[3] = {load_position(positions, ids[0]), load_position(positions, ids[1]), load_position(positions, ids[2])};
+            glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+            float double_area = glm::length(normal);
+            if (double_area == 0.0f)
+                continue;
+            normal /= double_area;
+
+            Quadric plane = Quadric::from_plane(normal, -glm::dot(normal, p[0]), double_area * 0.5f);
+            for (uint32_t v = 0; v < 3; v++)
+            {
+                quadrics[ids[v]] += plane;
+            }
+
+            // Planes perpendicular to open edges keep the outline in place
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                uint32_t from = ids[e];
+                uint32_t to = ids[(e + 1) % 3];
+                if (!is_open(from, to))
+                    continue;
+                open_out[from]++;
+                open_in[to]++;
+
+                glm::vec3 edge = p[(e + 1) % 3] - p[e];
+                glm::vec3 edge_normal = glm::cross(edge, normal);
+                float length = glm::length(edge_normal);
+                if (length == 0.0f)
+                    continue;
+                edge_normal /= length;
+                Quadric border = Quadric::from_plane(edge_normal, -glm::dot(edge_normal, p[e]), glm::dot(edge, edge) * BORDER_WEIGHT);
+                quadrics[from] += border;
+                quadrics[to] += border;
+            }
+        }
+
+        std::vector<VertexKind> kinds(vertex_count, VertexKind::Locked);
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            uint32_t id = position_ids[vertex];
+            if (wedge_counts[id] > 1)
+                continue;
+            if (open_out[id] == 0 && open_in[id] == 0)
+                kinds[vertex] = VertexKind::Manifold;
+            else if (open_out[id] == 1 && open_in[id] == 1)
+                kinds[vertex] = VertexKind::Border;
+        }
+
+        struct Collapse
+        {
+            uint32_t from{};
+            uint32_t to{};
+            double error{}; // Squared distance
+        };
+        std::vector<Collapse> collapses{};
+        std::vector<uint32_t> collapse_targets(vertex_count);
+        std::vector<bool> frozen(vertex_count);
+        std::vector<uint32_t> first_triangle(vertex_count + 1);
+        std::vector<uint32_t> vertex_triangles{};
+        const double error_limit = double(target_error) * target_error;
+        double max_error = 0.0;
+
+        // Every pass collapses the cheapest edges it can without touching a triangle twice
+        while (result.size() > target_index_count)
+        {
+            std::fill(first_triangle.begin(), first_triangle.end(), 0);
+            for (uint32_t index : result)
+                first_triangle[index + 1]++;
+            for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+                first_triangle[vertex + 1] += first_triangle[vertex];
+            vertex_triangles.resize(result.size());
+            {
+                std::vector<uint32_t> fill(first_triangle.begin(), first_triangle.end() - 1);
+                for (uint32_t i = 0; i < result.size(); i++)
+                    vertex_triangles[fill[result[i]]++] = i / 3;
+            }
+
+            collapses.clear();
+            auto add_collapse = [&](uint32_t from, uint32_t to)
+            {
+                if (kinds[from] == VertexKind::Locked)
+                    return;
+                if (!vertex_groups.empty() && vertex_groups[from] != vertex_groups[to])
+                    return;
+                if (kinds[from] == VertexKind::Border && !is_border_edge(position_ids[from], position_ids[to]))
+                    return;
+                collapses.push_back({from, to, quadrics[position_ids[from]].error(load_position(positions, to))});
+            };
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (uint32_t e = 0; e < 3; e++)
+                {
+                    uint32_t a = result[i + e];
+                    uint32_t b = result[i + (e + 1) % 3];
+                    add_collapse(a, b);
+                    add_collapse(b, a);
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b)
+                      { return a.error < b.error || (a.error == b.error && (a.from < b.from || (a.from == b.from && a.to < b.to))); });
+
+            // Rejects collapses that turn a remaining triangle of from around or stand it on its edge
+            auto flips = [&](uint32_t from, uint32_t to) -> bool
+            {
+                glm::vec3 target = load_position(positions, to);
+                for (uint32_t t = first_triangle[from]; t < first_triangle[from + 1]; t++)
+                {
+                    const uint32_t *triangle = &result[vertex_triangles[t] * 3];
+                    if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+                        continue;
+                    glm::vec3 before[3];
+                    glm::vec3 after[3];
+                    for (uint32_t v = 0; v < 3; v++)
+                    {
+                        before[v] = load_position(positions, triangle[v]);
+                        after[v] = triangle[v] == from ? target : before[v];
+                    }
+                    glm::vec3 normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    glm::vec3 normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+                    float cosine_limit = MAX_FLIP_COSINE * glm::length(normal_before) * glm::length(normal_after);
+                    if (glm::dot(normal_before, normal_after) <= cosine_limit)
+                        return true;
+                }
+                return false;
+            };
+
+            std::iota(collapse_targets.begin(), collapse_targets.end(), 0);
+            std::fill(frozen.begin(), frozen.end(), false);
+            size_t triangle_count = result.size() / 3;
+            size_t target_triangle_count = target_index_count / 3;
+            // Cheap collapses skipped because a neighbour moved are picked up by the next pass, the pass stops near the
+            // error of the collapse that would reach the target instead of settling for expensive ones
+            size_t collapse_goal = (triangle_count - target_triangle_count) / 2;
+            double pass_error_limit = collapse_goal < collapses.size() ? collapses[collapse_goal].error * 1.5 : error_limit;
+            uint32_t collapsed = 0;
+            for (const Collapse &collapse : collapses)
+            {
+                if (collapse.error > error_limit || (collapse.error > pass_error_limit && collapsed > 0) || triangle_count <= target_triangle_count)
+                    break;
+                if (frozen[collapse.from] || frozen[collapse.to] || flips(collapse.from, collapse.to))
+                    continue;
+
+                collapse_targets[collapse.from] = collapse.to;
+                quadrics[position_ids[collapse.to]] += quadrics[position_ids[collapse.from]];
+                max_error = std::max(max_error, collapse.error);
+                collapsed++;
+                for (uint32_t t = first_triangle[collapse.from]; t < first_triangle[collapse.from + 1]; t++)
+                {
+                    const uint32_t *triangle = &result[vertex_triangles[t] * 3];
+                    frozen[triangle[0]] = frozen[triangle[1]] = frozen[triangle[2]] = true;
+                    if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                        triangle_count--;
+                }
+            }
+            if (collapsed == 0)
+                break;
+
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                uint32_t a = collapse_targets[result[i]];
+                uint32_t b = collapse_targets[result[i + 1]];
+                uint32_t c = collapse_targets[result[i + 2]];
+                if (a == b || b == c || a == c)
+                    continue;
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        result_error = float(std::sqrt(max_error));
+        return result;
+    }
+
+    std::vector<MeshLod> build_lod_chain(std::vector<uint32_t> &indices, const VertexStream &positions, uint32_t vertex_count,
+                                         std::span<const uint32_t> vertex_groups, const MeshLodSettings &settings)
+    {
+        std::vector<MeshLod> lods{{0, uint32_t(indices.size()), 0.0f}};
+        if (indices.empty() || settings.max_lod_count <= 1)
+            return lods;
+
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{std::numeric_limits<float>::lowest()};
+        for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        {
+            glm::vec3 position = load_position(positions, vertex);
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+        float target_error = settings.max_error * glm::length(max - min) * 0.5f;
+
+        // Every level is simplified from the full detail one
+        const std::vector<uint32_t> full_detail(indices);
+        float triangle_ratio = 1.0f;
+        for (uint32_t lod = 1; lod < settings.max_lod_count; lod++)
+        {
+            triangle_ratio *= settings.triangle_ratio;
+            size_t target_index_count = size_t(full_detail.size() / 3 * triangle_ratio) * 3;
+            if (target_index_count / 3 < settings.min_triangle_count)
+                break;
+
+            float error = 0.0f;
+            std::vector<uint32_t> simplified = simplify_mesh(full_detail, positions, vertex_count, target_index_count, target_error, vertex_groups, error);
+            // The error bound stopped the simplifier, coarser levels would look the same
+            if (simplified.empty() || simplified.size() > lods.back().count * 9 / 10)
+                break;
+
+            optimize_triangle_order(simplified, positions, vertex_count);
+            lods.push_back({uint32_t(indices.size()), uint32_t(simplified.size()), std::max(error, lods.back().error)});
+            indices.insert(indices.end(), simplified.begin(), simplified.end());
+        }
+        return lods;
+    }
+
+    MeshOptimizeResult optimize_mesh(std::span<uint32_t> indices, std::span<const VertexStream> streams, uint32_t position_stream, uint32_t vertex_count)
+    {
+        assert(position_stream < streams.size() && streams[position_stream].stride >= sizeof(glm::vec3));
+        assert(indices.size() % 3 == 0);
+
+        MeshOptimizeResult result{};
+        result.input_vertex_count = vertex_count;
+        result.input_acmr = compute_acmr(indices, vertex_count);
+
+        vertex_count = weld_vertices(indices, streams, vertex_count);
+        optimize_triangle_order(indices, streams[position_stream], vertex_count);
+        optimize_vertex_fetch(indices, streams, vertex_count);
+
+        result.vertex_count = vertex_count;
+        result.acmr = compute_acmr(indices, vertex_count);
+        return result;
+    }
+
+    bool fits_16_bit_indices(uint32_t vertex_count)
+    {
+        return vertex_count <= std::numeric_limits<uint16_t>::max() + 1u;
+    }
+
+    std::vector<uint16_t> narrow_indices(std::span<const uint32_t> indices)
+    {
+        std::vector<uint16_t> narrowed(indices.size());
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            assert(indices[i] <= std::numeric_limits<uint16_t>::max());
+            narrowed[i] = uint16_t(indices[i]);
+        }
+        return narrowed;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace gage::scene::data
+{
+    // One attribute stream of a mesh, vertex i is the stride bytes at data + i * stride
+    struct VertexStream
+    {
+        unsigned char* data{};
+        size_t stride{};
+    };
+
+    struct MeshOptimizeResult
+    {
+        uint32_t vertex_count{};        // Streams past it can be dropped
+        uint32_t input_vertex_count{};
+        float input_acmr{};             // Average cache misses per triangle of a 16 entry FIFO cache
+        float acmr{};
+    };
+
+    // Import time optimization of an indexed triangle list, the streams are rewritten in place:
+    // - vertices that are bitwise equal across every stream are welded
+    // - triangles are reordered for the post transform cache (Forsyth's linear speed optimizer)
+    // - runs of triangles are sorted to draw outward facing clusters first (Sander et al., reduces overdraw)
+    // - vertices are renumbered in order of first use for fetch locality
+    // The first 12 bytes of a vertex of position_stream have to be its float x, y, z position, indices have to be in range
+    MeshOptimizeResult optimize_mesh(std::span<uint32_t> indices, std::span<const VertexStream> streams, uint32_t position_stream, uint32_t vertex_count);
+
+    // Levels of detail share the vertices of the full detail level, each is a range of the index buffer
+    struct MeshLod
+    {
+        uint32_t start{};
+        uint32_t count{};
+        float error{}; // Largest distance of the simplified surface from the full detail one, in mesh units
+    };
+
+    struct MeshLodSettings
+    {
+        uint32_t max_lod_count{4};      // Including the full detail level
+        float triangle_ratio{0.5f};     // Triangles of a level relative to the previous one
+        float max_error{0.05f};         // Relative to the bounding radius of the mesh
+        uint32_t min_triangle_count{32};
+    };
+
+    // Quadric error edge collapse onto existing vertices, so every attribute (skin weights included) of the kept vertices stays
+    // as it is. Attribute seams are locked and open borders only collapse along themselves. When vertex_groups is not empty
+    // only vertices of the same group collapse together. Stops at target_index_count or when the next collapse would move
+    // the surface further than target_error, result_error is the distance reached
+    std::vector<uint32_t> simplify_mesh(std::span<const uint32_t> indices, const VertexStream& positions, uint32_t vertex_count,
+                                        size_t target_index_count, float target_error, std::span<const uint32_t> vertex_groups, float& result_error);
+
+    // Appends the coarser levels to indices, the first level is the one indices already holds. Levels are optimized like
+    // optimize_mesh orders triangles. The chain ends early once the simplifier can not reach the next level within the error
+    std::vector<MeshLod> build_lod_chain(std::vector<uint32_t>& indices, const VertexStream& positions, uint32_t vertex_count,
+                                         std::span<const uint32_t> vertex_groups, const MeshLodSettings& settings);
+
+    // 16 bit indices are enough below 65536 vertices
+    bool fits_16_bit_indices(uint32_t vertex_count);
+    std::vector<uint16_t> narrow_indices(std::span<const uint32_t> indices);
+}
@@ -1,30 +1,104 @@
 #include <pch.hpp>
 #include "Model.hpp"
 
+#include "ModelFile.hpp"
 #include "../scene.hpp"
+#include "../systems/Renderer.hpp"
+
+#include <Core/src/utils/MappedFile.hpp>
+#include <Core/src/utils/JobSystem.hpp>
+#include <Core/src/utils/Exception.hpp>
+#include <Core/src/gfx/data/UploadBatch.hpp>
+#include <Core/src/gfx/data/TextureFile.hpp>
+#include <Core/src/gfx/Exception.hpp>
+#include <Core/src/mem.hpp>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <numeric>
 
 namespace gage::scene::data
 {
-    Model::Model(const gfx::Graphics& gfx, const systems::Renderer& renderer, const std::string &file_path, ModelImportMode mode)
+    // Calls function(index) for every index in [0, count) on the job system, one job per index since images and meshes
+    // differ a lot in size. The work is not part of a frame, wherever it runs. Errors are rethrown in index order
+    static void parallel_import(utils::JobSystem &job_system, uint32_t count, const std::function<void(uint32_t index)> &function)
     {
-        log().info("Importing scene: {}", file_path);
-        this->name = file_path;
+        std::vector<std::exception_ptr> errors(count);
+        job_system.parallel_for(count, 1, [&](uint32_t begin, uint32_t end)
+        {
+            FrameBudgetExclusionScope budget_exclusion;
+            MemoryTagScope memory_tag(MemoryTag::ASSETS);
+            for (uint32_t index = begin; index < end; index++)
+            {
+                try
+                {
+                    function(index);
+                }
+                catch (...)
+                {
+                    errors[index] = std::current_exception();
+                }
+            }
+        });
 
-        tinygltf::Model gltf_model;
+        for (const auto &error : errors)
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+    }
+
+    // The walks over the nodes recurse, their child links have to form a tree below the root. Child indices are in range
+    static bool is_node_tree(const std::vector<ModelNode> &nodes, uint32_t root_node)
+    {
+        std::vector<bool> visited(nodes.size());
+        std::vector<uint32_t> stack{root_node};
+        while (!stack.empty())
+        {
+            uint32_t node_index = stack.back();
+            stack.pop_back();
+            if (visited.at(node_index))
+                return false;
+            visited[node_index] = true;
+            stack.insert(stack.end(), nodes[node_index].children.begin(), nodes[node_index].children.end());
+        }
+        return true;
+    }
+
+    // Keeps the encoded bytes, the images are decoded in parallel once the whole file is parsed
+    static bool defer_image_decode(tinygltf::Image *, const int image_index, std::string *, std::string *, int, int,
+                                   const unsigned char *bytes, int size, void *user_data)
+    {
+        auto &encoded_images = *static_cast<std::vector<std::vector<unsigned char>> *>(user_data);
+        if (encoded_images.size() <= (size_t)image_index)
+            encoded_images.resize(image_index + 1);
+        encoded_images[image_index].assign(bytes, bytes + size);
+        return true;
+    }
+
+    std::shared_ptr<const tinygltf::Model> load_gltf(utils::JobSystem &job_system, const std::string &file_path, ModelImportMode mode)
+    {
+        log().info("Parsing gltf: {}", file_path);
+
+        auto gltf_model = std::make_shared<tinygltf::Model>();
         tinygltf::TinyGLTF loader;
         std::string err;
         std::string warn;
-        loader.SetImageLoader(tinygltf::LoadImageData, nullptr);
+        std::vector<std::vector<unsigned char>> encoded_images{};
+        loader.SetImageLoader(defer_image_decode, &encoded_images);
         loader.SetImageWriter(tinygltf::WriteImageData, nullptr);
 
         bool ret = false;
         switch (mode)
         {
         case ModelImportMode::Binary:
-            ret = loader.LoadBinaryFromFile(&gltf_model, &err, &warn, file_path);
+            ret = loader.LoadBinaryFromFile(gltf_model.get(), &err, &warn, file_path);
             break;
         case ModelImportMode::ASCII:
-            ret = loader.LoadASCIIFromFile(&gltf_model, &err, &warn, file_path);
+            ret = loader.LoadASCIIFromFile(gltf_model.get(), &err, &warn, file_path);
+            break;
+        case ModelImportMode::Cooked:
+            err = "Cooked models are not gltf";
             break;
         }
 
@@ -33,6 +107,57 @@ namespace gage::scene::data
             log().critical("Failed to import scene: {} | {} | {}", file_path, warn, err);
             throw SceneException{"Failed to import scene: " + file_path + "| " + warn + "| " + err};
         }
+
+        // Largest first so a big texture does not end up decoded alone at the end
+        std::vector<uint32_t> decode_order(encoded_images.size());
+        std::iota(decode_order.begin(), decode_order.end(), 0);
+        std::stable_sort(decode_order.begin(), decode_order.end(), [&](uint32_t a, uint32_t b)
+                         { return encoded_images[a].size() > encoded_images[b].size(); });
+        parallel_import(job_system, decode_order.size(), [&](uint32_t index)
+        {
+            uint32_t image_index = decode_order[index];
+            const std::vector<unsigned char> &bytes = encoded_images[image_index];
+            if (bytes.empty())
+                return;
+
+            // 8 bit rgba like tinygltf::LoadImageData, what the materials upload
+            int width, height, components;
+            stbi_uc *pixels = stbi_load_from_memory(bytes.data(), (int)bytes.size(), &width, &height, &components, 4);
+            if (!pixels)
+            {
+                log().critical("Failed to decode image {} of: {}", image_index, file_path);
+                throw SceneException{"Failed to decode image " + std::to_string(image_index) + " of: " + file_path};
+            }
+
+            tinygltf::Image &image = gltf_model->images.at(image_index);
+            image.width = width;
+            image.height = height;
+            image.component = 4;
+            image.bits = 8;
+            image.pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+            image.image.assign(pixels, pixels + size_t(width) * height * 4);
+            stbi_image_free(pixels);
+        });
+        return gltf_model;
+    }
+
+    Model::Model(const gfx::Graphics& gfx, systems::Renderer& renderer, utils::JobSystem &job_system, const std::string &name, std::shared_ptr<const tinygltf::Model> gltf_model) :
+        Model(job_system, name, std::move(gltf_model))
+    {
+        gfx::data::UploadBatch batch(gfx);
+        upload(gfx, renderer, batch);
+        batch.submit();
+        batch.wait();
+        release_import_data();
+    }
+
+    Model::Model(utils::JobSystem &job_system, const std::string &name, std::shared_ptr<const tinygltf::Model> gltf_model_ptr, const MeshLodSettings &lod_settings, VertexLayout vertex_layout) :
+        gltf_model(std::move(gltf_model_ptr))
+    {
+        log().info("Importing scene: {}", name);
+        this->name = name;
+
+        const tinygltf::Model &gltf_model = *this->gltf_model;
         this->root_node = gltf_model.scenes.at(gltf_model.defaultScene).nodes.at(0);
 
         // Import nodes
@@ -40,20 +165,46 @@ namespace gage::scene::data
         for (uint32_t i = 0; i < gltf_model.nodes.size(); i++)
         {
             this->nodes.emplace_back(gltf_model.nodes.at(i), i);
+            for (uint32_t child : this->nodes.back().children)
+            {
+                if (child >= gltf_model.nodes.size())
+                {
+                    log().critical("Node {} has a child out of range in: {}", i, name);
+                    throw SceneException{"Node child out of range in: " + name};
+                }
+            }
+        }
+        if (!is_node_tree(this->nodes, this->root_node))
+        {
+            log().critical("Node linked more than once in: {}", name);
+            throw SceneException{"Node linked more than once in: " + name};
         }
 
-        // Process mesh
-        this->meshes.reserve(gltf_model.meshes.size());
-        for (const auto &gltf_mesh : gltf_model.meshes)
+        // Extract mesh data in parallel, meshes are stored by index so the result does not depend on which thread got which mesh
+        {
+            std::vector<std::optional<ModelMeshData>> extracted(gltf_model.meshes.size());
+            parallel_import(job_system, gltf_model.meshes.size(), [&](uint32_t index)
+            {
+                extracted[index].emplace(gltf_model, gltf_model.meshes[index], lod_settings, vertex_layout);
+            });
+
+            this->mesh_datas.reserve(extracted.size());
+            for (auto &mesh_data : extracted)
+            {
+                this->mesh_datas.push_back(std::move(*mesh_data));
+            }
+        }
+        this->mesh_views.reserve(mesh_datas.size());
+        for (const auto &mesh_data : mesh_datas)
         {
-            this->meshes.emplace_back(gfx, gltf_model, gltf_mesh);
+            this->mesh_views.push_back(mesh_data.get_views());
         }
 
-        // Process material
-        this->materials.reserve(gltf_model.materials.size());
+        // Materials point into the decoded images
+        this->material_datas.reserve(gltf_model.materials.size());
         for (const auto &gltf_material : gltf_model.materials)
         {
-            this->materials.emplace_back(gfx, renderer, gltf_model, gltf_material);
+            this->material_datas.emplace_back(gltf_model, gltf_material);
         }
 
         // Process animations
@@ -94,9 +245,595 @@ namespace gage::scene::data
 
             traverse_scene_graph_recursive(this->nodes.at(this->root_node), glm::mat4x4(1.0f));
         }
+
+        build_node_name_index();
+    }
+
+    Model::Model(const std::string &name, const std::string &cooked_file_path)
+    {
+        log().info("Loading cooked model: {} from {}", name, cooked_file_path);
+        this->name = name;
+
+        try
+        {
+            cooked_file = std::make_unique<utils::MappedFile>(cooked_file_path);
+        }
+        catch (const utils::FileLoaderException &)
+        {
+            log().critical("Failed to map cooked model: {}", cooked_file_path);
+            throw SceneException{"Failed to map cooked model: " + cooked_file_path};
+        }
+        const unsigned char *data = cooked_file->get_data();
+        uint64_t size = cooked_file->get_size();
+
+        auto fail = [&cooked_file_path](const char *reason)
+        {
+            log().critical("Invalid cooked model: {} | {}", cooked_file_path, reason);
+            throw SceneException{"Invalid cooked model: " + cooked_file_path + "| " + reason};
+        };
+        auto check_table = [&](const file::Table &table, uint64_t element_size, size_t alignment)
+        {
+            if (table.offset > size || table.count > (size - table.offset) / element_size || table.offset % alignment != 0)
+                fail("Table out of range");
+        };
+        auto check_range = [&](uint64_t first, uint64_t count, uint64_t table_count)
+        {
+            if (first > table_count || count > table_count - first)
+                fail("Range out of table");
+        };
+
+        if (size < sizeof(file::ModelHeader))
+            fail("File too small");
+        file::ModelHeader header{};
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, file::MAGIC, sizeof(header.magic)) != 0)
+            fail("Not a cooked model");
+        if (header.version != file::VERSION)
+            fail("Unsupported version");
+        check_table(header.nodes, sizeof(file::ModelNode), alignof(file::ModelNode));
+        check_table(header.meshes, sizeof(file::ModelMesh), alignof(file::ModelMesh));
+        check_table(header.primitives, sizeof(file::ModelPrimitive), alignof(file::ModelPrimitive));
+        check_table(header.lods, sizeof(file::ModelLod), alignof(file::ModelLod));
+        check_table(header.materials, sizeof(file::ModelMaterial), alignof(file::ModelMaterial));
+        check_table(header.textures, sizeof(file::ModelTexture), alignof(file::ModelTexture));
+        check_table(header.animations, sizeof(file::ModelAnimation), alignof(file::ModelAnimation));
+        check_table(header.channels, sizeof(file::ModelChannel), alignof(file::ModelChannel));
+        check_table(header.skins, sizeof(file::ModelSkin), alignof(file::ModelSkin));
+        check_table(header.links, sizeof(uint32_t), alignof(uint32_t));
+        check_table(header.strings, 1, 1);
+        check_table(header.data, 1, file::DATA_ALIGNMENT);
+        if (header.strings.count == 0 || data[header.strings.offset + header.strings.count - 1] != '\0')
+            fail("String table is not terminated");
+        if (header.root_node >= header.nodes.count)
+            fail("Root node out of range");
+
+        // The mapping is page aligned and the tables are at aligned offsets, they are read in place
+        const auto *file_nodes = reinterpret_cast<const file::ModelNode *>(data + header.nodes.offset);
+        const auto *file_meshes = reinterpret_cast<const file::ModelMesh *>(data + header.meshes.offset);
+        const auto *file_primitives = reinterpret_cast<const file::ModelPrimitive *>(data + header.primitives.offset);
+        const auto *file_lods = reinterpret_cast<const file::ModelLod *>(data + header.lods.offset);
+        const auto *file_materials = reinterpret_cast<const file::ModelMaterial *>(data + header.materials.offset);
+        const auto *file_textures = reinterpret_cast<const file::ModelTexture *>(data + header.textures.offset);
+        const auto *file_animations = reinterpret_cast<const file::ModelAnimation *>(data + header.animations.offset);
+        const auto *file_channels = reinterpret_cast<const file::ModelChannel *>(data + header.channels.offset);
+        const auto *file_skins = reinterpret_cast<const file::ModelSkin *>(data + header.skins.offset);
+        const auto *links = reinterpret_cast<const uint32_t *>(data + header.links.offset);
+        const char *strings = reinterpret_cast<const char *>(data + header.strings.offset);
+
+        auto get_string = [&](uint32_t offset) -> const char *
+        {
+            if (offset >= header.strings.count)
+                fail("String out of range");
+            return strings + offset;
+        };
+        // Slice of the data section, the element type only has to be aligned to DATA_ALIGNMENT
+        auto get_data = [&]<typename T>(uint64_t offset, uint64_t count) -> std::span<const T>
+        {
+            if (offset % file::DATA_ALIGNMENT != 0 || offset > header.data.count || count > (header.data.count - offset) / sizeof(T))
+                fail("Data out of range");
+            return std::span<const T>(reinterpret_cast<const T *>(data + header.data.offset + offset), count);
+        };
+
+        this->root_node = header.root_node;
+        this->nodes.resize(header.nodes.count);
+        for (uint32_t i = 0; i < header.nodes.count; i++)
+        {
+            const file::ModelNode &file_node = file_nodes[i];
+            ModelNode &node = this->nodes[i];
+            node.name = get_string(file_node.name);
+            node.bone_id = file_node.bone_id;
+            node.position = glm::make_vec3(file_node.position);
+            node.scale = glm::make_vec3(file_node.scale);
+            node.rotation = glm::make_quat(file_node.rotation);
+            node.inverse_bind_transform = glm::make_mat4x4(file_node.inverse_bind_transform);
+            if (file_node.mesh != file::NO_INDEX)
+            {
+                if (file_node.mesh >= header.meshes.count)
+                    fail("Mesh out of range");
+                node.has_mesh = true;
+                node.mesh_index = file_node.mesh;
+            }
+            if (file_node.skin != file::NO_INDEX)
+            {
+                if (file_node.skin >= header.skins.count)
+                    fail("Skin out of range");
+                node.has_skin = true;
+                node.skin_index = file_node.skin;
+            }
+
+            check_range(file_node.first_child, file_node.child_count, header.links.count);
+            node.children.assign(links + file_node.first_child, links + file_node.first_child + file_node.child_count);
+            for (uint32_t child : node.children)
+            {
+                if (child >= header.nodes.count)
+                    fail("Child out of range");
+            }
+        }
+
+        if (!is_node_tree(this->nodes, this->root_node))
+            fail("Node linked more than once");
+
+        // Primitive views point into cooked_lods, it is filled before them and never grows
+        this->cooked_lods.reserve(header.lods.count);
+        for (uint32_t i = 0; i < header.lods.count; i++)
+        {
+            const file::ModelLod &file_lod = file_lods[i];
+            this->cooked_lods.push_back({.start = file_lod.first_index, .count = file_lod.index_count, .error = file_lod.error});
+        }
+
+        this->mesh_views.resize(header.meshes.count);
+        for (uint32_t i = 0; i < header.meshes.count; i++)
+        {
+            const file::ModelMesh &file_mesh = file_meshes[i];
+            check_range(file_mesh.first_primitive, file_mesh.primitive_count, header.primitives.count);
+            this->mesh_views[i].reserve(file_mesh.primitive_count);
+            for (uint32_t p = file_mesh.first_primitive; p < file_mesh.first_primitive + file_mesh.primitive_count; p++)
+            {
+                const file::ModelPrimitive &file_primitive = file_primitives[p];
+                if (file_primitive.material < -1 || file_primitive.material >= (int64_t)header.materials.count)
+                    fail("Material out of range");
+                if (file_primitive.index_size != sizeof(uint16_t) && file_primitive.index_size != sizeof(uint32_t))
+                    fail("Unsupported index size");
+                check_range(file_primitive.first_lod, file_primitive.lod_count, header.lods.count);
+                if (file_primitive.lod_count == 0)
+                    fail("Primitive without levels of detail");
+                std::span<const MeshLod> lods(this->cooked_lods.data() + file_primitive.first_lod, file_primitive.lod_count);
+                for (const MeshLod &lod : lods)
+                {
+                    check_range(lod.start, lod.count, file_primitive.index_count);
+                }
+                if (file_primitive.vertex_layout >= VERTEX_LAYOUT_COUNT)
+                    fail("Unsupported vertex layout");
+                const uint32_t vertex_count = file_primitive.vertex_count;
+                const VertexLayout vertex_layout = (VertexLayout)file_primitive.vertex_layout;
+                auto indices = get_data.operator()<unsigned char>(file_primitive.indices, uint64_t(file_primitive.index_count) * file_primitive.index_size);
+                auto check_indices = [&](auto index_values)
+                {
+                    for (uint32_t index : index_values)
+                    {
+                        if (index >= vertex_count)
+                            fail("Index out of range");
+                    }
+                };
+                if (file_primitive.index_size == sizeof(uint16_t))
+                    check_indices(get_data.operator()<uint16_t>(file_primitive.indices, file_primitive.index_count));
+                else
+                    check_indices(get_data.operator()<uint32_t>(file_primitive.indices, file_primitive.index_count));
+                const auto &formats = get_vertex_attribute_formats(vertex_layout);
+                auto get_stream = [&](uint64_t offset, VertexAttribute attribute)
+                {
+                    return get_data.operator()<unsigned char>(offset, uint64_t(vertex_count) * formats[attribute].stride);
+                };
+                this->mesh_views[i].push_back(ModelMeshPrimitiveView{
+                    .indices = indices,
+                    .index_type = file_primitive.index_size == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32,
+                    .lods = lods,
+                    .bounding_sphere = glm::make_vec4(file_primitive.bounding_sphere),
+                    .vertex_count = vertex_count,
+                    .vertex_layout = vertex_layout,
+                    .dequantization = {
+                        .position_offset = glm::make_vec4(file_primitive.position_offset),
+                        .position_scale = glm::make_vec4(file_primitive.position_scale),
+                        .texcoord_transform = glm::make_vec4(file_primitive.texcoord_transform)},
+                    .positions = get_stream(file_primitive.positions, VERTEX_ATTRIBUTE_POSITION),
+                    .normals = get_stream(file_primitive.normals, VERTEX_ATTRIBUTE_NORMAL),
+                    .texcoords = get_stream(file_primitive.texcoords, VERTEX_ATTRIBUTE_TEXCOORD),
+                    .bone_ids = get_stream(file_primitive.bone_ids, VERTEX_ATTRIBUTE_BONE_ID),
+                    .bone_weights = get_stream(file_primitive.bone_weights, VERTEX_ATTRIBUTE_BONE_WEIGHT),
+                    .material_index = file_primitive.material,
+                    .has_skin = file_primitive.has_skin != 0});
+            }
+        }
+
+        auto get_texture = [&](uint32_t texture_index) -> ModelTextureView
+        {
+            if (texture_index == file::NO_INDEX)
+                return {};
+            if (texture_index >= header.textures.count)
+                fail("Texture out of range");
+            const file::ModelTexture &file_texture = file_textures[texture_index];
+            auto texture_file = get_data.operator()<unsigned char>(file_texture.file, file_texture.size);
+            try
+            {
+                gfx::data::TextureFile validate(texture_file);
+            }
+            catch (const gfx::GraphicsException &)
+            {
+                fail("Invalid texture");
+            }
+            return ModelTextureView{.texture_file = texture_file};
+        };
+        this->material_datas.resize(header.materials.count);
+        for (uint32_t i = 0; i < header.materials.count; i++)
+        {
+            const file::ModelMaterial &file_material = file_materials[i];
+            ModelMaterialData &material_data = this->material_datas[i];
+            material_data.color = glm::make_vec4(file_material.color);
+            material_data.albedo = get_texture(file_material.albedo);
+            material_data.metalic_roughness = get_texture(file_material.metalic_roughness);
+            material_data.normal = get_texture(file_material.normal);
+        }
+
+        // Animations are sampled on the cpu, the keys are copied out of the mapping
+        this->animations.resize(header.animations.count);
+        for (uint32_t i = 0; i < header.animations.count; i++)
+        {
+            const file::ModelAnimation &file_animation = file_animations[i];
+            ModelAnimation &animation = this->animations[i];
+            animation.name = get_string(file_animation.name);
+            animation.duration = file_animation.duration;
+
+            check_range(file_animation.first_channel, file_animation.channel_count, header.channels.count);
+            for (uint32_t c = file_animation.first_channel; c < file_animation.first_channel + file_animation.channel_count; c++)
+            {
+                const file::ModelChannel &file_channel = file_channels[c];
+                if (file_channel.target_node >= header.nodes.count)
+                    fail("Channel target out of range");
+                auto times = get_data.operator()<float>(file_channel.times, file_channel.key_count);
+                std::vector<float> time_points(times.begin(), times.end());
+                switch (file_channel.path)
+                {
+                case file::ChannelPath::Translation:
+                {
+                    auto values = get_data.operator()<glm::vec3>(file_channel.values, file_channel.key_count);
+                    animation.pos_channels.push_back({file_channel.target_node, std::move(time_points), {values.begin(), values.end()}});
+                    break;
+                }
+                case file::ChannelPath::Scale:
+                {
+                    auto values = get_data.operator()<glm::vec3>(file_channel.values, file_channel.key_count);
+                    animation.scale_channels.push_back({file_channel.target_node, std::move(time_points), {values.begin(), values.end()}});
+                    break;
+                }
+                case file::ChannelPath::Rotation:
+                {
+                    auto values = get_data.operator()<glm::vec4>(file_channel.values, file_channel.key_count);
+                    ModelAnimation::RotationChannel channel{file_channel.target_node, std::move(time_points), {}};
+                    channel.rotations.reserve(values.size());
+                    for (const glm::vec4 &value : values)
+                    {
+                        channel.rotations.push_back(glm::quat{value.w, value.x, value.y, value.z});
+                    }
+                    animation.rotation_channels.push_back(std::move(channel));
+                    break;
+                }
+                default:
+                    fail("Unknown channel path");
+                }
+            }
+        }
+
+        this->skins.resize(header.skins.count);
+        for (uint32_t i = 0; i < header.skins.count; i++)
+        {
+            const file::ModelSkin &file_skin = file_skins[i];
+            check_range(file_skin.first_joint, file_skin.joint_count, header.links.count);
+            this->skins[i].assign(links + file_skin.first_joint, links + file_skin.first_joint + file_skin.joint_count);
+        }
+
+        build_node_name_index();
     }
+
     Model::~Model()
     {
 
     }
+
+    Model::Model(Model&&) = default;
+
+    void Model::upload(const gfx::Graphics& gfx, systems::Renderer& renderer, gfx::data::UploadBatch& batch)
+    {
+        assert((gltf_model || cooked_file) && "Model was already uploaded");
+
+        this->meshes.reserve(mesh_views.size());
+        for (const auto &primitive_views : mesh_views)
+        {
+            this->meshes.emplace_back(renderer.get_mesh_arena(), batch, primitive_views);
+        }
+
+        this->materials.reserve(material_datas.size());
+        for (const auto &material_data : material_datas)
+        {
+            this->materials.emplace_back(gfx, renderer, batch, material_data);
+        }
+    }
+
+    void Model::release_import_data()
+    {
+        mesh_views = {};
+        cooked_lods = {};
+        material_datas = {};
+        mesh_datas = {};
+        gltf_model.reset();
+        cooked_file.reset();
+    }
+
+    void Model::cook(utils::JobSystem &job_system, const std::string &file_path, bool fast_textures) const
+    {
+        assert((gltf_model || cooked_file) && "Import data was released");
+
+        std::vector<file::ModelNode> file_nodes{};
+        std::vector<file::ModelMesh> file_meshes{};
+        std::vector<file::ModelPrimitive> file_primitives{};
+        std::vector<file::ModelLod> file_lods{};
+        std::vector<file::ModelMaterial> file_materials{};
+        std::vector<file::ModelTexture> file_textures{};
+        std::vector<file::ModelAnimation> file_animations{};
+        std::vector<file::ModelChannel> file_channels{};
+        std::vector<file::ModelSkin> file_skins{};
+        std::vector<uint32_t> links{};
+        std::vector<uint8_t> data{};
+        std::string strings(1, '\0');
+        std::unordered_map<std::string, uint32_t> string_offsets{};
+
+        auto add_string = [&](const std::string &string) -> uint32_t
+        {
+            if (string.empty())
+                return 0;
+            auto [it, inserted] = string_offsets.try_emplace(string, (uint32_t)strings.size());
+            if (inserted)
+            {
+                strings.append(string);
+                strings.push_back('\0');
+            }
+            return it->second;
+        };
+        auto add_data = [&](const void *bytes, size_t size_in_bytes) -> uint64_t
+        {
+            data.resize((data.size() + file::DATA_ALIGNMENT - 1) / file::DATA_ALIGNMENT * file::DATA_ALIGNMENT);
+            uint64_t offset = data.size();
+            data.insert(data.end(), (const uint8_t *)bytes, (const uint8_t *)bytes + size_in_bytes);
+            return offset;
+        };
+        auto add_links = [&](const std::vector<uint32_t> &indices) -> uint32_t
+        {
+            uint32_t first = links.size();
+            links.insert(links.end(), indices.begin(), indices.end());
+            return first;
+        };
+
+        for (const ModelNode &node : nodes)
+        {
+            file::ModelNode file_node{};
+            file_node.name = add_string(node.name);
+            file_node.bone_id = node.bone_id;
+            file_node.mesh = node.has_mesh ? node.mesh_index : file::NO_INDEX;
+            file_node.skin = node.has_skin ? node.skin_index : file::NO_INDEX;
+            file_node.first_child = add_links(node.children);
+            file_node.child_count = node.children.size();
+            std::memcpy(file_node.position, glm::value_ptr(node.position), sizeof(file_node.position));
+            std::memcpy(file_node.scale, glm::value_ptr(node.scale), sizeof(file_node.scale));
+            std::memcpy(file_node.rotation, glm::value_ptr(node.rotation), sizeof(file_node.rotation));
+            std::memcpy(file_node.inverse_bind_transform, glm::value_ptr(node.inverse_bind_transform), sizeof(file_node.inverse_bind_transform));
+            file_nodes.push_back(file_node);
+        }
+
+        for (const auto &primitive_views : mesh_views)
+        {
+            file_meshes.push_back({.first_primitive = (uint32_t)file_primitives.size(), .primitive_count = (uint32_t)primitive_views.size()});
+            for (const ModelMeshPrimitiveView &primitive : primitive_views)
+            {
+                file::ModelPrimitive file_primitive{};
+                file_primitive.material = primitive.material_index;
+                file_primitive.has_skin = primitive.has_skin;
+                file_primitive.index_size = primitive.index_type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+                file_primitive.index_count = primitive.indices.size() / file_primitive.index_size;
+                file_primitive.vertex_count = primitive.vertex_count;
+                file_primitive.indices = add_data(primitive.indices.data(), primitive.indices.size_bytes());
+                file_primitive.positions = add_data(primitive.positions.data(), primitive.positions.size_bytes());
+                file_primitive.normals = add_data(primitive.normals.data(), primitive.normals.size_bytes());
+                file_primitive.texcoords = add_data(primitive.texcoords.data(), primitive.texcoords.size_bytes());
+                file_primitive.bone_ids = add_data(primitive.bone_ids.data(), primitive.bone_ids.size_bytes());
+                file_primitive.bone_weights = add_data(primitive.bone_weights.data(), primitive.bone_weights.size_bytes());
+                file_primitive.first_lod = file_lods.size();
+                file_primitive.lod_count = primitive.lods.size();
+                for (const MeshLod &lod : primitive.lods)
+                {
+                    file_lods.push_back({.first_index = lod.start, .index_count = lod.count, .error = lod.error});
+                }
+                std::memcpy(file_primitive.bounding_sphere, glm::value_ptr(primitive.bounding_sphere), sizeof(file_primitive.bounding_sphere));
+                file_primitive.vertex_layout = (uint32_t)primitive.vertex_layout;
+                std::memcpy(file_primitive.position_offset, glm::value_ptr(primitive.dequantization.position_offset), sizeof(file_primitive.position_offset));
+                std::memcpy(file_primitive.position_scale, glm::value_ptr(primitive.dequantization.position_scale), sizeof(file_primitive.position_scale));
+                std::memcpy(file_primitive.texcoord_transform, glm::value_ptr(primitive.dequantization.texcoord_transform), sizeof(file_primitive.texcoord_transform));
+                file_primitives.push_back(file_primitive);
+            }
+        }
+
+        // Materials sharing an image share the cooked texture, compressed for the slot it is first used in.
+        // The texture files of a cooked model are copied as they are
+        struct TextureSource
+        {
+            ModelTextureView view{};
+            gfx::data::TextureKind kind{};
+        };
+        std::vector<TextureSource> texture_sources{};
+        std::unordered_map<const unsigned char *, uint32_t> texture_indices{};
+        auto add_texture = [&](const ModelTextureView &texture, gfx::data::TextureKind kind) -> uint32_t
+        {
+            if (texture.empty())
+                return file::NO_INDEX;
+            const unsigned char *key = texture.pixels ? texture.pixels : texture.texture_file.data();
+            auto [it, inserted] = texture_indices.try_emplace(key, (uint32_t)texture_sources.size());
+            if (inserted)
+                texture_sources.push_back({texture, kind});
+            return it->second;
+        };
+        for (const ModelMaterialData &material_data : material_datas)
+        {
+            file::ModelMaterial file_material{};
+            std::memcpy(file_material.color, glm::value_ptr(material_data.color), sizeof(file_material.color));
+            file_material.albedo = add_texture(material_data.albedo, gfx::data::TextureKind::Color);
+            file_material.metalic_roughness = add_texture(material_data.metalic_roughness, gfx::data::TextureKind::Linear);
+            file_material.normal = add_texture(material_data.normal, gfx::data::TextureKind::Normal);
+            file_materials.push_back(file_material);
+        }
+
+        std::vector<std::vector<unsigned char>> cooked_textures(texture_sources.size());
+        parallel_import(job_system, texture_sources.size(), [&](uint32_t index)
+        {
+            const ModelTextureView &view = texture_sources[index].view;
+            if (view.pixels)
+                cooked_textures[index] = gfx::data::cook_texture(view.pixels, view.width, view.height, {.kind = texture_sources[index].kind, .fast = fast_textures});
+        });
+        for (uint32_t i = 0; i < texture_sources.size(); i++)
+        {
+            std::span<const unsigned char> texture_file = texture_sources[i].view.pixels ? std::span<const unsigned char>(cooked_textures[i]) : texture_sources[i].view.texture_file;
+            file_textures.push_back({.file = add_data(texture_file.data(), texture_file.size()), .size = texture_file.size()});
+        }
+
+        for (const ModelAnimation &animation : animations)
+        {
+            file::ModelAnimation file_animation{};
+            file_animation.name = add_string(animation.name);
+            file_animation.duration = animation.duration;
+            file_animation.first_channel = file_channels.size();
+
+            auto add_channel = [&](uint32_t target_node, file::ChannelPath path, const std::vector<float> &time_points, const void *values, size_t value_size)
+            {
+                file::ModelChannel file_channel{};
+                file_channel.target_node = target_node;
+                file_channel.path = path;
+                file_channel.key_count = time_points.size();
+                file_channel.times = add_data(time_points.data(), time_points.size() * sizeof(float));
+                file_channel.values = add_data(values, time_points.size() * value_size);
+                file_channels.push_back(file_channel);
+            };
+            for (const auto &channel : animation.pos_channels)
+            {
+                assert(channel.positions.size() == channel.time_points.size());
+                add_channel(channel.target_node, file::ChannelPath::Translation, channel.time_points, channel.positions.data(), sizeof(glm::vec3));
+            }
+            for (const auto &channel : animation.scale_channels)
+            {
+                assert(channel.scales.size() == channel.time_points.size());
+                add_channel(channel.target_node, file::ChannelPath::Scale, channel.time_points, channel.scales.data(), sizeof(glm::vec3));
+            }
+            for (const auto &channel : animation.rotation_channels)
+            {
+                assert(channel.rotations.size() == channel.time_points.size());
+                std::vector<glm::vec4> rotations{};
+                rotations.reserve(channel.rotations.size());
+                for (const glm::quat &rotation : channel.rotations)
+                {
+                    rotations.push_back({rotation.x, rotation.y, rotation.z, rotation.w});
+                }
+                add_channel(channel.target_node, file::ChannelPath::Rotation, channel.time_points, rotations.data(), sizeof(glm::vec4));
+            }
+
+            file_animation.channel_count = file_channels.size() - file_animation.first_channel;
+            file_animations.push_back(file_animation);
+        }
+
+        for (const auto &joints : skins)
+        {
+            file_skins.push_back({.first_joint = add_links(joints), .joint_count = (uint32_t)joints.size()});
+        }
+
+        // Tables follow the header in this order, each aligned to its element
+        file::ModelHeader header{};
+        std::memcpy(header.magic, file::MAGIC, sizeof(header.magic));
+        header.version = file::VERSION;
+        header.root_node = root_node;
+        uint64_t file_size = sizeof(file::ModelHeader);
+        auto place = [&file_size](file::Table &table, uint64_t count, uint64_t element_size, uint64_t alignment)
+        {
+            table.offset = (file_size + alignment - 1) / alignment * alignment;
+            table.count = count;
+            file_size = table.offset + count * element_size;
+        };
+        place(header.nodes, file_nodes.size(), sizeof(file::ModelNode), alignof(file::ModelNode));
+        place(header.meshes, file_meshes.size(), sizeof(file::ModelMesh), alignof(file::ModelMesh));
+        place(header.primitives, file_primitives.size(), sizeof(file::ModelPrimitive), alignof(file::ModelPrimitive));
+        place(header.lods, file_lods.size(), sizeof(file::ModelLod), alignof(file::ModelLod));
+        place(header.materials, file_materials.size(), sizeof(file::ModelMaterial), alignof(file::ModelMaterial));
+        place(header.textures, file_textures.size(), sizeof(file::ModelTexture), alignof(file::ModelTexture));
+        place(header.animations, file_animations.size(), sizeof(file::ModelAnimation), alignof(file::ModelAnimation));
+        place(header.channels, file_channels.size(), sizeof(file::ModelChannel), alignof(file::ModelChannel));
+        place(header.skins, file_skins.size(), sizeof(file::ModelSkin), alignof(file::ModelSkin));
+        place(header.links, links.size(), sizeof(uint32_t), alignof(uint32_t));
+        place(header.strings, strings.size(), 1, 1);
+        place(header.data, data.size(), 1, file::DATA_ALIGNMENT);
+
+        std::ofstream stream(file_path, std::ios::binary);
+        if (!stream.is_open())
+        {
+            log().critical("Failed to open cooked model for writing: {}", file_path);
+            throw SceneException{"Failed to open cooked model for writing: " + file_path};
+        }
+        uint64_t written = 0;
+        auto write = [&](const file::Table &table, const void *bytes, size_t size_in_bytes)
+        {
+            static constexpr char padding[file::DATA_ALIGNMENT]{};
+            stream.write(padding, table.offset - written);
+            stream.write(reinterpret_cast<const char *>(bytes), size_in_bytes);
+            written = table.offset + size_in_bytes;
+        };
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        written = sizeof(header);
+        write(header.nodes, file_nodes.data(), file_nodes.size() * sizeof(file::ModelNode));
+        write(header.meshes, file_meshes.data(), file_meshes.size() * sizeof(file::ModelMesh));
+        write(header.primitives, file_primitives.data(), file_primitives.size() * sizeof(file::ModelPrimitive));
+        write(header.lods, file_lods.data(), file_lods.size() * sizeof(file::ModelLod));
+        write(header.materials, file_materials.data(), file_materials.size() * sizeof(file::ModelMaterial));
+        write(header.textures, file_textures.data(), file_textures.size() * sizeof(file::ModelTexture));
+        write(header.animations, file_animations.data(), file_animations.size() * sizeof(file::ModelAnimation));
+        write(header.channels, file_channels.data(), file_channels.size() * sizeof(file::ModelChannel));
+        write(header.skins, file_skins.data(), file_skins.size() * sizeof(file::ModelSkin));
+        write(header.links, links.data(), links.size() * sizeof(uint32_t));
+        write(header.strings, strings.data(), strings.size());
+        write(header.data, data.data(), data.size());
+        if (!stream)
+        {
+            log().critical("Failed to write cooked model: {}", file_path);
+            throw SceneException{"Failed to write cooked model: " + file_path};
+        }
+        log().info("Cooked model: {}, {} bytes", file_path, written);
+    }
+
+    void Model::build_node_name_index()
+    {
+        // The first node in pre order wins like a recursive search would
+        std::function<void(uint32_t node_index)> index_names_recursive;
+        index_names_recursive = [&](uint32_t node_index)
+        {
+            const data::ModelNode &node = this->nodes.at(node_index);
+            node_name_to_index.try_emplace(node.name, node_index);
+            for (uint32_t child : node.children)
+            {
+                index_names_recursive(child);
+            }
+        };
+
+        node_name_to_index.reserve(this->nodes.size());
+        index_names_recursive(this->root_node);
+    }
+
+    std::optional<uint32_t> Model::find_node(std::string_view name) const
+    {
+        auto it = node_name_to_index.find(name);
+        if (it == node_name_to_index.end())
+            return std::nullopt;
+        return it->second;
+    }
 }
\ No newline at end of file
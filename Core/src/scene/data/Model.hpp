@@ -14,28 +14,75 @@
 #include <memory>
 #include <string>
 #include <optional>
+#include <string_view>
+#include <unordered_map>
 
 #include <glm/vec3.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+namespace tinygltf
+{
+    class Model;
+}
+
+namespace gage::gfx::data
+{
+    class UploadBatch;
+}
+
+namespace gage::utils
+{
+    class MappedFile;
+    class JobSystem;
+}
+
 namespace gage::scene::data
 {
     enum class ModelImportMode
     {
         Binary,
-        ASCII
+        ASCII,
+        Cooked // Written by AssetCooker, see ModelFile.hpp
     };
+
+    // Binary or ASCII gltf with its images decoded to 8 bit rgba, throws SceneException if it can not be parsed.
+    // The images are decoded in jobs of job_system, call it from one of its workers
+    std::shared_ptr<const tinygltf::Model> load_gltf(utils::JobSystem& job_system, const std::string& file_path, ModelImportMode mode);
+
+    // Built from a parsed gltf or a cooked file in two parts: the cpu side is extracted by the constructor, then upload()
+    // creates the meshes and materials on the gpu. The first part can run on any job system worker.
     class Model
     {
     public:
-        Model(const gfx::Graphics& gfx, const systems::Renderer& renderer, const std::string &file_path, ModelImportMode mode);
+        // Extracts and uploads, waits for the upload to finish
+        Model(const gfx::Graphics& gfx, systems::Renderer& renderer, utils::JobSystem& job_system, const std::string &name, std::shared_ptr<const tinygltf::Model> gltf_model);
+        // Cpu part only, does not touch the gpu. Meshes and materials are empty until upload().
+        // Vertex streams are packed into vertex_layout, primitives that do not fit it keep the full one.
+        // Meshes are extracted in jobs of job_system
+        Model(utils::JobSystem& job_system, const std::string &name, std::shared_ptr<const tinygltf::Model> gltf_model, const MeshLodSettings& lod_settings = {},
+            VertexLayout vertex_layout = VertexLayout::Quantized);
+        // Cpu part of a cooked file. The file is mapped and only the node and animation tables are copied,
+        // upload() stages the vertex streams and textures straight from the mapping. Throws SceneException if it is invalid
+        Model(const std::string &name, const std::string &cooked_file_path);
         ~Model();
-        
 
-        Model(Model&&) = default;
+        Model(Model&&);
         Model(const Model&) = delete;
         Model operator=(const Model&) = delete;
 
+        // Records the meshes into the mesh arena of renderer and the materials into batch, main thread only.
+        // The model can be rendered once batch completed
+        void upload(const gfx::Graphics& gfx, systems::Renderer& renderer, gfx::data::UploadBatch& batch);
+        // Lets go of the parsed or mapped file and frees the extracted vertex data, call it after upload()
+        void release_import_data();
+        // Writes the model in the cooked format, needs the import data (before release_import_data()).
+        // Textures are block compressed for their material slot, fast_textures trades quality for cooking time
+        void cook(utils::JobSystem& job_system, const std::string &file_path, bool fast_textures = false) const;
+
+        // Index of the first node named name in pre order from the root node
+        std::optional<uint32_t> find_node(std::string_view name) const;
+    private:
+        void build_node_name_index();
     public:
         std::string name{};
         std::vector<ModelNode> nodes{};
@@ -44,5 +91,14 @@ namespace gage::scene::data
         std::vector<ModelMaterial> materials{};
         std::vector<ModelAnimation> animations{};
         std::vector<std::vector<uint32_t>> skins{};
+    private:
+        std::unordered_map<std::string_view, uint32_t> node_name_to_index{}; // Views into nodes
+        // Import data, one of the two files is set until release_import_data()
+        std::shared_ptr<const tinygltf::Model> gltf_model{}; // Decoded images for the materials, shared through the asset cache
+        std::unique_ptr<utils::MappedFile> cooked_file{};
+        std::vector<ModelMeshData> mesh_datas{}; // Extracted from gltf_model
+        std::vector<std::vector<ModelMeshPrimitiveView>> mesh_views{}; // Into mesh_datas or cooked_file
+        std::vector<MeshLod> cooked_lods{};
+        std::vector<ModelMaterialData> material_datas{};
     };
 }
\ No newline at end of file
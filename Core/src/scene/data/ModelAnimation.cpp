@@ -1,6 +1,7 @@
 #include <pch.hpp>
 #include "ModelAnimation.hpp"
 
+#include "AccessorView.hpp"
 #include "../scene.hpp"
 
 
@@ -11,86 +12,71 @@ namespace gage::scene::data
         name = gltf_animation.name;
         log().trace("Animation name: {}", gltf_animation.name);
 
-        auto extract_buffer_from_accessor = [&](const tinygltf::Accessor &accessor)
-            -> std::vector<unsigned char>
-        {
-            const auto &buffer_view = gltf_model.bufferViews.at(accessor.bufferView);
-            const auto &buffer = gltf_model.buffers.at(buffer_view.buffer);
-
-            std::vector<unsigned char> result(buffer_view.byteLength);
-            std::memcpy(result.data(), buffer.data.data() + buffer_view.byteOffset, buffer_view.byteLength);
-
-            return result;
-        };
-
         duration = std::numeric_limits<float>::min();
         for (const auto &gltf_channel : gltf_animation.channels)
         {
             const auto &gltf_sampler = gltf_animation.samplers.at(gltf_channel.sampler);
             const auto &time_point_accessor = gltf_model.accessors.at(gltf_sampler.input);
-            auto time_points = extract_buffer_from_accessor(time_point_accessor); // .size() in bytes
+            AccessorView time_point_view(gltf_model, time_point_accessor);
+            AccessorView data_view(gltf_model, gltf_model.accessors.at(gltf_sampler.output));
             duration = std::max(duration, time_point_accessor.maxValues.at(0));
+
+            std::vector<float> time_points(time_point_view.size());
+            time_point_view.read(std::span(time_points));
+
+            // Cubic spline keys are in tangent, value, out tangent, only the values are kept
+            bool cubic_spline = gltf_sampler.interpolation == "CUBICSPLINE";
+            uint32_t key_stride = cubic_spline ? 3 : 1;
+            uint32_t key_offset = cubic_spline ? 1 : 0;
+            if (data_view.size() != time_points.size() * key_stride)
+            {
+                log().critical("Animation channel has {} keys for {} time points", data_view.size(), time_points.size());
+                throw SceneException{"Animation channel key count does not match its time points"};
+            }
+            auto read_keys = [&](auto &keys)
+            {
+                keys.resize(time_points.size());
+                if (!cubic_spline)
+                {
+                    data_view.read(std::span(keys));
+                    return;
+                }
+                using Key = typename std::remove_reference_t<decltype(keys)>::value_type;
+                for (uint32_t i = 0; i < keys.size(); i++)
+                {
+                    keys[i] = data_view.get<Key>(i * key_stride + key_offset);
+                }
+            };
+
             if (gltf_channel.target_path.compare("translation") == 0)
             {
                 data::ModelAnimation::PositionChannel channel{};
                 channel.target_node = gltf_channel.target_node;
-                const auto &data_accessor = gltf_model.accessors.at(gltf_sampler.output);
-                auto data = extract_buffer_from_accessor(data_accessor); // .size() in bytes
-
-                channel.time_points.resize(time_point_accessor.count); // .size() in n * floats(4 bytes)
-                channel.positions.resize(data_accessor.count);         // .size() in n * glm::vec3 ( 12 bytes )
-                // log().info("Time point size: {} bytes, data size: {} bytes", time_points.size(),  data.size());
-
-                std::memcpy(channel.time_points.data(), time_points.data(), time_point_accessor.count * sizeof(float));
-                std::memcpy(channel.positions.data(), data.data(), data_accessor.count * sizeof(glm::vec3));
-
+                read_keys(channel.positions);
+                channel.time_points = std::move(time_points);
                 pos_channels.push_back(std::move(channel));
             }
             else if (gltf_channel.target_path.compare("scale") == 0)
             {
                 data::ModelAnimation::ScaleChannel channel{};
                 channel.target_node = gltf_channel.target_node;
-                const auto &data_accessor = gltf_model.accessors.at(gltf_sampler.output);
-                auto data = extract_buffer_from_accessor(data_accessor); // .size() in bytes
-
-                channel.time_points.resize(time_point_accessor.count); // .size() in n * floats(4 bytes)
-                channel.scales.resize(data_accessor.count);            // .size() in n * glm::vec3 ( 12 bytes )
-                // log().info("Time point size: {} bytes, data size: {} bytes", time_points.size(),  data.size());
-
-                std::memcpy(channel.time_points.data(), time_points.data(), time_point_accessor.count * sizeof(float));
-                std::memcpy(channel.scales.data(), data.data(), data_accessor.count * sizeof(glm::vec3));
-
+                read_keys(channel.scales);
+                channel.time_points = std::move(time_points);
                 scale_channels.push_back(std::move(channel));
             }
-
             else if (gltf_channel.target_path.compare("rotation") == 0)
             {
                 data::ModelAnimation::RotationChannel channel{};
                 channel.target_node = gltf_channel.target_node;
-                const auto &data_accessor = gltf_model.accessors.at(gltf_sampler.output);
-                auto data = extract_buffer_from_accessor(data_accessor); // .size() in bytes
-
-                channel.time_points.resize(time_point_accessor.count); // .size() in n * floats(4 bytes)
-                std::memcpy(channel.time_points.data(), time_points.data(), time_point_accessor.count * sizeof(float));
-
-                if (data_accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
+                // Float or normalized integer x, y, z, w
+                std::vector<glm::vec4> rotations{};
+                read_keys(rotations);
+                channel.rotations.reserve(rotations.size());
+                for (const glm::vec4 &rotation : rotations)
                 {
-                    channel.rotations.reserve(data_accessor.count);
-                    for (uint32_t i = 0; i < data_accessor.count; i++)
-                    {
-                        float x = *(float *)&data.at(i * sizeof(glm::quat) + sizeof(float) * 0);
-                        float y = *(float *)&data.at(i * sizeof(glm::quat) + sizeof(float) * 1);
-                        float z = *(float *)&data.at(i * sizeof(glm::quat) + sizeof(float) * 2);
-                        float w = *(float *)&data.at(i * sizeof(glm::quat) + sizeof(float) * 3);
-                        channel.rotations.push_back(glm::quat{w, x, y, z});
-                    }
+                    channel.rotations.push_back(glm::quat{rotation.w, rotation.x, rotation.y, rotation.z});
                 }
-                else
-                {
-                    log().critical("Animation rotation channel is not in float ! TO DO LIST !");
-                    throw SceneException{};
-                }
-
+                channel.time_points = std::move(time_points);
                 rotation_channels.push_back(std::move(channel));
             }
         }
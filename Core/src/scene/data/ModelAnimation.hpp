@@ -39,6 +39,7 @@ namespace gage::scene::data
             std::vector<glm::quat> rotations{}; 
         };
     public:
+        ModelAnimation() = default;
         ModelAnimation(const tinygltf::Model& gltf_model, const tinygltf::Animation& gltf_animation);
         ~ModelAnimation();
 
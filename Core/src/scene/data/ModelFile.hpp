@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace gage::scene::data::file
+{
+    // Cooked model written by AssetCooker (Model::cook) and memory mapped by the Model constructor that takes a file.
+    // Layout: ModelHeader | tables | strings | data. Every table is at an offset aligned to its element.
+    // Node children and skin joints are ranges of the links table. Strings are null terminated and referenced by their
+    // offset into the string table, offset 0 is the empty string.
+    // The data section holds vertex streams in the formats the pipelines bind, animation keys and texture files
+    // (gfx::data::TextureFile) with their block compressed mip chains, offsets into it are 16 byte aligned.
+    static constexpr char MAGIC[4] = {'G', 'M', 'D', 'L'};
+    static constexpr uint32_t VERSION = 5;
+    static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+    static constexpr const char* EXTENSION = ".gmdl";
+    static constexpr uint64_t DATA_ALIGNMENT = 16;
+
+    struct Table
+    {
+        uint64_t offset{};
+        uint64_t count{}; // Elements, bytes for strings and data
+    };
+
+    struct ModelHeader
+    {
+        char magic[4]{};
+        uint32_t version{};
+        uint32_t root_node{};
+        uint32_t reserved{};
+        Table nodes{};
+        Table meshes{};
+        Table primitives{};
+        Table lods{};
+        Table materials{};
+        Table textures{};
+        Table animations{};
+        Table channels{};
+        Table skins{};
+        Table links{}; // uint32_t
+        Table strings{};
+        Table data{};
+    };
+
+    struct ModelNode
+    {
+        uint32_t name{}; // String offset
+        uint32_t bone_id{};
+        uint32_t mesh{NO_INDEX};
+        uint32_t skin{NO_INDEX};
+        uint32_t first_child{}; // Into links
+        uint32_t child_count{};
+        float position[3]{};
+        float scale[3]{};
+        float rotation[4]{}; // x, y, z, w
+        float inverse_bind_transform[16]{}; // Column major, precomputed from the bind pose
+    };
+
+    struct ModelMesh
+    {
+        uint32_t first_primitive{};
+        uint32_t primitive_count{};
+    };
+
+    // Streams: uint16 or uint32 indices (index_size) of every level of detail, then positions, normals, texcoords,
+    // bone ids and bone weights in the formats of vertex_layout (VertexLayout)
+    struct ModelPrimitive
+    {
+        int32_t material{-1};
+        uint16_t has_skin{};
+        uint16_t index_size{}; // 2 or 4 bytes
+        uint32_t index_count{};
+        uint32_t vertex_count{};
+        uint64_t indices{}; // Offsets into data
+        uint64_t positions{};
+        uint64_t normals{};
+        uint64_t texcoords{};
+        uint64_t bone_ids{};
+        uint64_t bone_weights{};
+        uint32_t first_lod{}; // The first is the full detail level
+        uint32_t lod_count{};
+        float bounding_sphere[4]{}; // Center and radius
+        uint32_t vertex_layout{};
+        uint32_t reserved{};
+        float position_offset[4]{}; // VertexDequantization
+        float position_scale[4]{};
+        float texcoord_transform[4]{};
+    };
+
+    struct ModelLod
+    {
+        uint32_t first_index{}; // Range of the primitive's indices
+        uint32_t index_count{};
+        float error{};
+        uint32_t reserved{};
+    };
+
+    struct ModelMaterial
+    {
+        float color[4]{};
+        uint32_t albedo{NO_INDEX}; // Texture index
+        uint32_t metalic_roughness{NO_INDEX};
+        uint32_t normal{NO_INDEX};
+        uint32_t reserved{};
+    };
+
+    // Whole texture file embedded in the data section
+    struct ModelTexture
+    {
+        uint64_t file{}; // Offset into data
+        uint64_t size{};
+    };
+
+    struct ModelAnimation
+    {
+        uint32_t name{};
+        uint32_t first_channel{};
+        uint32_t channel_count{};
+        uint32_t reserved{};
+        double duration{};
+    };
+
+    enum class ChannelPath : uint32_t
+    {
+        Translation,
+        Scale,
+        Rotation
+    };
+
+    // key_count float times, then key_count vec3 or x, y, z, w quaternions depending on path
+    struct ModelChannel
+    {
+        uint32_t target_node{};
+        ChannelPath path{};
+        uint32_t key_count{};
+        uint32_t reserved{};
+        uint64_t times{}; // Offsets into data
+        uint64_t values{};
+    };
+
+    struct ModelSkin
+    {
+        uint32_t first_joint{}; // Into links
+        uint32_t joint_count{};
+    };
+
+    static_assert(std::is_trivially_copyable_v<ModelHeader> && sizeof(ModelHeader) == 208);
+    static_assert(std::is_trivially_copyable_v<ModelNode> && sizeof(ModelNode) == 128);
+    static_assert(std::is_trivially_copyable_v<ModelMesh> && sizeof(ModelMesh) == 8);
+    static_assert(std::is_trivially_copyable_v<ModelPrimitive> && sizeof(ModelPrimitive) == 144);
+    static_assert(std::is_trivially_copyable_v<ModelLod> && sizeof(ModelLod) == 16);
+    static_assert(std::is_trivially_copyable_v<ModelMaterial> && sizeof(ModelMaterial) == 32);
+    static_assert(std::is_trivially_copyable_v<ModelTexture> && sizeof(ModelTexture) == 16);
+    static_assert(std::is_trivially_copyable_v<ModelAnimation> && sizeof(ModelAnimation) == 24);
+    static_assert(std::is_trivially_copyable_v<ModelChannel> && sizeof(ModelChannel) == 32);
+    static_assert(std::is_trivially_copyable_v<ModelSkin> && sizeof(ModelSkin) == 8);
+}
@@ -3,20 +3,38 @@
 #include "../systems/Renderer.hpp"
 
 #include <Core/src/gfx/data/Image.hpp>
+#include <Core/src/gfx/data/TextureFile.hpp>
 
 namespace gage::scene::data
 {
-    ModelMaterial::ModelMaterial(const gfx::Graphics& gfx, const systems::Renderer& renderer, const tinygltf::Model &gltf_model, const tinygltf::Material &gltf_material) :
-        gfx(gfx),
-        renderer(renderer)
+    ModelMaterialData::ModelMaterialData(const tinygltf::Model &gltf_model, const tinygltf::Material &gltf_material)
     {
-        uniform_buffer_data.color = {
+        color = {
             gltf_material.pbrMetallicRoughness.baseColorFactor.at(0),
             gltf_material.pbrMetallicRoughness.baseColorFactor.at(1),
             gltf_material.pbrMetallicRoughness.baseColorFactor.at(2),
             gltf_material.pbrMetallicRoughness.baseColorFactor.at(3),
         };
 
+        auto get_texture = [&](int texture_index) -> ModelTextureView
+        {
+            if (texture_index < 0)
+                return {};
+            const auto &image_src_index = gltf_model.textures.at(texture_index).source;
+            const auto &image = gltf_model.images.at(image_src_index);
+            return ModelTextureView{image.image.data(), (uint32_t)image.width, (uint32_t)image.height};
+        };
+        albedo = get_texture(gltf_material.pbrMetallicRoughness.baseColorTexture.index);
+        metalic_roughness = get_texture(gltf_material.pbrMetallicRoughness.metallicRoughnessTexture.index);
+        normal = get_texture(gltf_material.normalTexture.index);
+    }
+
+    ModelMaterial::ModelMaterial(const gfx::Graphics& gfx, const systems::Renderer& renderer, gfx::data::UploadBatch& batch, const ModelMaterialData& data) :
+        gfx(gfx),
+        renderer(renderer)
+    {
+        uniform_buffer_data.color = data.color;
+
         gfx::data::ImageCreateInfo image_ci{};
         image_ci.format = VK_FORMAT_R8G8B8A8_UNORM;
         image_ci.min_filter = VK_FILTER_NEAREST;
@@ -24,52 +42,41 @@ namespace gage::scene::data
         image_ci.address_node = VK_SAMPLER_ADDRESS_MODE_REPEAT;
         image_ci.mip_levels = 1;
 
+        auto create_image = [&](const ModelTextureView &texture) -> std::unique_ptr<gfx::data::Image>
+        {
+            // Cooked textures bring their whole mip chain
+            if (!texture.texture_file.empty())
+            {
+                gfx::data::TextureFile texture_file(texture.texture_file);
+                return std::make_unique<gfx::data::Image>(gfx, batch, texture_file.get_image_create_info(image_ci.min_filter, image_ci.mag_filter, image_ci.address_node));
+            }
+
+            image_ci.image_data = texture.pixels;
+            image_ci.width = texture.width;
+            image_ci.height = texture.height;
+            image_ci.size_in_bytes = size_t(texture.width) * texture.height * 4;
+            return std::make_unique<gfx::data::Image>(gfx, batch, image_ci);
+        };
+
         // Has albedo texture ?
-        const auto &albedo_texture_index = gltf_material.pbrMetallicRoughness.baseColorTexture.index;
-        uniform_buffer_data.has_albedo = albedo_texture_index > -1;
+        uniform_buffer_data.has_albedo = !data.albedo.empty();
         if (uniform_buffer_data.has_albedo)
         {
-            const auto &image_src_index = gltf_model.textures.at(albedo_texture_index).source;
-            const auto &image = gltf_model.images.at(image_src_index);
-            size_t size_in_bytes = image.width * image.height * 4;
-
-            image_ci.image_data = image.image.data();
-            image_ci.width = image.width;
-            image_ci.height = image.height;
-            image_ci.size_in_bytes = size_in_bytes;
-            albedo_image = std::make_unique<gfx::data::Image>(gfx, image_ci);
+            albedo_image = create_image(data.albedo);
         }
 
         // Has metalic roughness ?
-        const auto &metalic_roughness_texture_index = gltf_material.pbrMetallicRoughness.metallicRoughnessTexture.index;
-        uniform_buffer_data.has_metalic = metalic_roughness_texture_index > -1;
+        uniform_buffer_data.has_metalic = !data.metalic_roughness.empty();
         if (uniform_buffer_data.has_metalic)
         {
-            const auto &image_src_index = gltf_model.textures.at(metalic_roughness_texture_index).source;
-            const auto &image = gltf_model.images.at(image_src_index);
-            size_t size_in_bytes = image.width * image.height * 4;
-
-            image_ci.image_data = image.image.data();
-            image_ci.width = image.width;
-            image_ci.height = image.height;
-            image_ci.size_in_bytes = size_in_bytes;
-            metalic_roughness_image = std::make_unique<gfx::data::Image>(gfx, image_ci);
+            metalic_roughness_image = create_image(data.metalic_roughness);
         }
 
         // Has normal map ?
-        const auto &normal_texture_index = gltf_material.normalTexture.index;
-        uniform_buffer_data.has_normal = normal_texture_index > -1;
+        uniform_buffer_data.has_normal = !data.normal.empty();
         if (uniform_buffer_data.has_normal)
         {
-            const auto &image_src_index = gltf_model.textures.at(normal_texture_index).source;
-            const auto &image = gltf_model.images.at(image_src_index);
-            size_t size_in_bytes = image.width * image.height * 4;
-
-            image_ci.image_data = image.image.data();
-            image_ci.width = image.width;
-            image_ci.height = image.height;
-            image_ci.size_in_bytes = size_in_bytes;
-            normal_image = std::make_unique<gfx::data::Image>(gfx, image_ci);
+            normal_image = create_image(data.normal);
         }
 
         uniform_buffer = std::make_unique<gfx::data::CPUBuffer>(gfx, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(data::ModelMaterial::UniformBuffer), &uniform_buffer_data);
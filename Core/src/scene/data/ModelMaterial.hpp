@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <vulkan/vulkan.h>
 
 #include <glm/vec4.hpp>
@@ -13,6 +14,7 @@ namespace gage::gfx
     {
         class CPUBuffer;
         class Image;
+        class UploadBatch;
     }
 }
 
@@ -29,6 +31,29 @@ namespace gage::scene::systems
 
 namespace gage::scene::data
 {
+    // 8 bit rgba pixels owned by the parsed gltf or a block compressed texture file (gfx::data::TextureFile) in a cooked file,
+    // empty if the material has no such texture
+    struct ModelTextureView
+    {
+        const unsigned char* pixels{};
+        uint32_t width{};
+        uint32_t height{};
+        std::span<const unsigned char> texture_file{};
+
+        bool empty() const { return pixels == nullptr && texture_file.empty(); }
+    };
+
+    struct ModelMaterialData
+    {
+        ModelMaterialData() = default;
+        ModelMaterialData(const tinygltf::Model &gltf_model, const tinygltf::Material &gltf_material);
+
+        glm::vec4 color{1, 1, 1, 1};
+        ModelTextureView albedo{};
+        ModelTextureView metalic_roughness{};
+        ModelTextureView normal{};
+    };
+
     class ModelMaterial
     {
     public: 
@@ -42,7 +67,8 @@ namespace gage::scene::data
             uint32_t has_normal{};
         };
     public:
-        ModelMaterial(const gfx::Graphics& gfx, const systems::Renderer& renderer, const tinygltf::Model &gltf_model, const tinygltf::Material &gltf_material);
+        // Textures can be sampled once batch completed, the viewed pixels can be freed after that
+        ModelMaterial(const gfx::Graphics& gfx, const systems::Renderer& renderer, gfx::data::UploadBatch& batch, const ModelMaterialData& data);
         ~ModelMaterial();
 
         ModelMaterial(ModelMaterial&&) = default;
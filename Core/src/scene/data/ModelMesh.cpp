@@ -2,8 +2,10 @@
 #include "ModelMesh.hpp"
 
 
-#include <Core/src/gfx/Graphics.hpp>
+#include <Core/src/gfx/data/UploadBatch.hpp>
 
+#include "AccessorView.hpp"
+#include "MeshOptimizer.hpp"
 #include "../scene.hpp"
 
 namespace gage::scene::data
@@ -12,207 +14,222 @@ namespace gage::scene::data
     {
 
     }
-    ModelMesh::ModelMesh(const gfx::Graphics& gfx, const tinygltf::Model& model, const tinygltf::Mesh& mesh)
+    ModelMeshData::ModelMeshData(const tinygltf::Model& model, const tinygltf::Mesh& mesh, const MeshLodSettings& lod_settings, VertexLayout vertex_layout)
     {
-        using namespace tinygltf;
-        auto extract_buffer_from_accessor = [&](const Accessor &accessor)
-            -> std::vector<unsigned char>
-        {
-            const auto &buffer_view = model.bufferViews.at(accessor.bufferView);
-            const auto &buffer = model.buffers.at(buffer_view.buffer);
-
-            std::vector<unsigned char> result(buffer_view.byteLength);
-            std::memcpy(result.data(), buffer.data.data() + buffer_view.byteOffset, buffer_view.byteLength);
-
-            return result;
-        };
-
-        auto extract_indices_from_primitive = [&](const Primitive &primitive, std::vector<uint32_t> &indices)
+        primitives.reserve(mesh.primitives.size());
+        for (const auto &primitive : mesh.primitives)
         {
-            const auto &accessor = model.accessors.at(primitive.indices);
-            auto index_vector = extract_buffer_from_accessor(accessor);
-            switch (accessor.componentType)
-            {
-            case 5123:
-            {
-                for (uint32_t i = 0; i < accessor.count; i++)
-                {
-                    const uint16_t *index = (const uint16_t *)&index_vector.at(i * sizeof(uint16_t));
-                    indices.push_back(uint32_t(*index));
-                }
-                break;
-            }
+            ModelMeshPrimitiveData &data = primitives.emplace_back();
 
-            case 5125:
+            if (primitive.indices < 0)
             {
-                for (uint32_t i = 0; i < accessor.count; i++)
-                {
-                    const uint32_t *index = (const uint32_t *)&index_vector.at(i * sizeof(uint32_t));
-                    indices.push_back(uint32_t(*index));
-                }
-                break;
+                log().critical("Model primitives must be indexed");
+                throw SceneException{"Model primitives must be indexed"};
             }
+            AccessorView index_view(model, model.accessors.at(primitive.indices));
+            data.indices.resize(index_view.size());
+            index_view.read(std::span(data.indices));
 
-            default:
-                throw SceneException{"Invalid index component type !"};
-            }
-        };
-
-        auto extract_data_from_primitive = [&](const Primitive &primitive,
-                                               std::vector<glm::vec3> &positions,
-                                               std::vector<glm::vec3> &normals,
-                                               std::vector<glm::vec2> &texcoords,
-                                               std::vector<glm::vec<4, uint16_t>> &bone_ids,
-                                               std::vector<glm::vec4> &bone_weights)
-        {
             if (primitive.attributes.find("POSITION") == primitive.attributes.end())
             {
                 log().critical("Model vertex attribute must have POSITION attributes");
                 throw SceneException{"Model vertex attribute must have POSITION attributes"};
             }
+            AccessorView position_view(model, model.accessors.at(primitive.attributes.at("POSITION")));
+            uint32_t vertex_count = position_view.size();
+            data.positions.resize(vertex_count);
+            position_view.read(std::span(data.positions));
 
-            const auto &position_accessor = model.accessors.at(primitive.attributes.at("POSITION"));
-            std::vector<unsigned char> position_buffer = extract_buffer_from_accessor(position_accessor);
-            std::vector<unsigned char> normal_buffer;
+            // Missing attributes are left zeroed
+            auto read_attribute = [&](const char *name, auto &stream) -> bool
+            {
+                stream.resize(vertex_count);
+                auto it = primitive.attributes.find(name);
+                if (it == primitive.attributes.end())
+                    return false;
 
-            if (primitive.attributes.find("NORMAL") != primitive.attributes.end())
+                AccessorView view(model, model.accessors.at(it->second));
+                if (view.size() != vertex_count)
+                {
+                    log().critical("Model vertex attribute {} does not match the vertex count", name);
+                    throw SceneException{"Model vertex attribute does not match the vertex count"};
+                }
+                view.read(std::span(stream));
+                return true;
+            };
+            read_attribute("NORMAL", data.normals);
+            read_attribute("TEXCOORD_0", data.texcoords);
+            bool has_joints = read_attribute("JOINTS_0", data.bone_ids);
+            bool has_weights = read_attribute("WEIGHTS_0", data.bone_weights);
+
+            data.material_index = primitive.material;
+            data.has_skin = has_joints && has_weights;
+
+            if (data.indices.size() % 3 != 0)
             {
-                normal_buffer = extract_buffer_from_accessor(model.accessors.at(primitive.attributes.at("NORMAL")));
+                log().critical("Model primitives must be triangle lists");
+                throw SceneException{"Model primitives must be triangle lists"};
             }
-            else
+            for (uint32_t index : data.indices)
             {
-                // Fill it with zeroes
-                auto vertex_count = position_accessor.count;
-                normal_buffer.resize(vertex_count * sizeof(glm::vec3));
-                std::memset(normal_buffer.data(), 0, vertex_count * sizeof(glm::vec3));
+                if (index >= vertex_count)
+                {
+                    log().critical("Model primitive index {} is out of range of {} vertices", index, vertex_count);
+                    throw SceneException{"Model primitive index is out of range"};
+                }
             }
 
-            if (primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end())
+            VertexStream streams[] = {
+                {reinterpret_cast<unsigned char *>(data.positions.data()), sizeof(glm::vec3)},
+                {reinterpret_cast<unsigned char *>(data.normals.data()), sizeof(glm::vec3)},
+                {reinterpret_cast<unsigned char *>(data.texcoords.data()), sizeof(glm::vec2)},
+                {reinterpret_cast<unsigned char *>(data.bone_ids.data()), sizeof(glm::vec<4, uint16_t>)},
+                {reinterpret_cast<unsigned char *>(data.bone_weights.data()), sizeof(glm::vec4)}};
+            MeshOptimizeResult result = optimize_mesh(data.indices, streams, 0, vertex_count);
+            log().trace("Optimized primitive of {}: {} -> {} vertices, ACMR {:.3f} -> {:.3f}",
+                        mesh.name, result.input_vertex_count, result.vertex_count, result.input_acmr, result.acmr);
+
+            data.positions.resize(result.vertex_count);
+            data.normals.resize(result.vertex_count);
+            data.texcoords.resize(result.vertex_count);
+            data.bone_ids.resize(result.vertex_count);
+            data.bone_weights.resize(result.vertex_count);
+
+            glm::vec3 min{std::numeric_limits<float>::max()};
+            glm::vec3 max{std::numeric_limits<float>::lowest()};
+            for (const glm::vec3 &position : data.positions)
             {
-                const auto &accessor = model.accessors.at(primitive.attributes.at("TEXCOORD_0"));
-                auto buffer = extract_buffer_from_accessor(accessor);
-
-                for (uint32_t i = 0; i < accessor.count; i++)
-                {
-                    if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
-                    {
-                        glm::vec2 tex_coord = *(glm::vec2 *)&buffer.at(i * sizeof(tex_coord));
-                        texcoords.push_back(tex_coord);
-                    }
-                    else
-                    {
-                        log().info("TEXCOORD_0: TODO !");
-                        throw SceneException{};
-                    }
-                }
+                min = glm::min(min, position);
+                max = glm::max(max, position);
             }
-            else
+            glm::vec3 center = data.positions.empty() ? glm::vec3{0.0f} : (min + max) * 0.5f;
+            float radius = 0.0f;
+            for (const glm::vec3 &position : data.positions)
             {
-                // Fill with zeroes
-                auto vertex_count = position_accessor.count;
-                texcoords.resize(vertex_count * sizeof(glm::vec<2, float>));
-                std::memset(texcoords.data(), 0, vertex_count * sizeof(glm::vec<2, float>));
+                radius = std::max(radius, glm::distance(center, position));
             }
+            data.bounding_sphere = glm::vec4{center, radius};
 
-            if (primitive.attributes.find("JOINTS_0") != primitive.attributes.end())
+            // Skinned vertices only collapse onto vertices that follow the same joint the most, so the levels deform alike
+            std::vector<uint32_t> dominant_joints{};
+            if (data.has_skin)
             {
-
-                const auto &accessor = model.accessors.at(primitive.attributes.at("JOINTS_0"));
-                auto buffer = extract_buffer_from_accessor(accessor);
-
-                for (uint32_t i = 0; i < accessor.count; i++)
+                dominant_joints.resize(result.vertex_count);
+                for (uint32_t i = 0; i < result.vertex_count; i++)
                 {
-                    if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
+                    const glm::vec4 &weights = data.bone_weights[i];
+                    int strongest = 0;
+                    for (int j = 1; j < 4; j++)
                     {
-                        glm::vec<4, uint16_t> bone_id = *(glm::vec<4, uint16_t> *)&buffer.at(i * sizeof(bone_id));
-                        bone_ids.push_back(bone_id);
-                    }
-                    else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-                    {
-                        glm::vec<4, uint16_t> bone_id = *(glm::vec<4, uint8_t> *)&buffer.at(i * sizeof(glm::vec<4, uint8_t>));
-                        bone_ids.push_back(bone_id);
+                        if (weights[j] > weights[strongest])
+                            strongest = j;
                     }
+                    dominant_joints[i] = data.bone_ids[i][strongest];
                 }
             }
-            else
+            data.lods = build_lod_chain(data.indices, streams[0], result.vertex_count, dominant_joints, lod_settings);
+            log().trace("Primitive of {} has {} levels of detail, {} -> {} triangles",
+                        mesh.name, data.lods.size(), data.lods.front().count / 3, data.lods.back().count / 3);
+
+            if (fits_16_bit_indices(result.vertex_count))
             {
-                // Fill with zeroes
-                auto vertex_count = position_accessor.count;
-                bone_ids.resize(vertex_count * sizeof(glm::vec<4, uint16_t>));
-                std::memset(bone_ids.data(), 0, vertex_count * sizeof(glm::vec<4, uint16_t>));
+                data.short_indices = narrow_indices(data.indices);
+                data.indices = {};
             }
 
-            if (primitive.attributes.find("WEIGHTS_0") != primitive.attributes.end())
+            data.vertex_layout = vertex_layout;
+            if (vertex_layout != VertexLayout::Full)
             {
-
-                const auto &accessor = model.accessors.at(primitive.attributes.at("WEIGHTS_0"));
-                auto buffer = extract_buffer_from_accessor(accessor);
-
-                for (uint32_t i = 0; i < accessor.count; i++)
+                if (quantize_vertices(vertex_layout, data.positions, data.normals, data.texcoords, data.bone_ids, data.bone_weights, data.quantized))
                 {
-                    if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
-                    {
-                        glm::vec4 bone_weight = *(glm::vec4 *)&buffer.at(i * sizeof(bone_weight));
-                        bone_weights.push_back(bone_weight);
-                    }
-                    else
-                    {
-                        log().info("WEIGHTS_0: TODO !");
-                        throw SceneException{};
-                    }
+                    data.positions = {};
+                    data.normals = {};
+                    data.texcoords = {};
+                    data.bone_ids = {};
+                    data.bone_weights = {};
+                }
+                else
+                {
+                    log().warn("Primitive of {} has joint indices above 255, keeping the full vertex layout", mesh.name);
+                    data.vertex_layout = VertexLayout::Full;
                 }
             }
-            else
+        }
+    }
+
+    template <typename T>
+    static std::span<const unsigned char> as_bytes(const std::vector<T> &stream)
+    {
+        return std::span(reinterpret_cast<const unsigned char *>(stream.data()), stream.size() * sizeof(T));
+    }
+
+    std::vector<ModelMeshPrimitiveView> ModelMeshData::get_views() const
+    {
+        std::vector<ModelMeshPrimitiveView> views{};
+        views.reserve(primitives.size());
+        for (const auto &primitive : primitives)
+        {
+            bool short_indices = !primitive.short_indices.empty();
+            std::span<const unsigned char> indices = short_indices ? as_bytes(primitive.short_indices) : as_bytes(primitive.indices);
+            ModelMeshPrimitiveView view{
+                .indices = indices,
+                .index_type = short_indices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32,
+                .lods = primitive.lods,
+                .bounding_sphere = primitive.bounding_sphere,
+                .vertex_layout = primitive.vertex_layout,
+                .material_index = primitive.material_index,
+                .has_skin = primitive.has_skin};
+            if (primitive.vertex_layout == VertexLayout::Full)
             {
-                // Fill with zeroes
-                auto vertex_count = position_accessor.count;
-                bone_weights.resize(vertex_count * sizeof(glm::vec4));
-                std::memset(bone_weights.data(), 0, vertex_count * sizeof(glm::vec4));
+                view.vertex_count = primitive.positions.size();
+                view.positions = as_bytes(primitive.positions);
+                view.normals = as_bytes(primitive.normals);
+                view.texcoords = as_bytes(primitive.texcoords);
+                view.bone_ids = as_bytes(primitive.bone_ids);
+                view.bone_weights = as_bytes(primitive.bone_weights);
             }
-
-            // Process
-            for (uint32_t i = 0; i < position_accessor.count; i++)
+            else
             {
-                glm::vec3 position{};
-                glm::vec3 normal{};
-                std::memcpy(&position.x, position_buffer.data() + i * sizeof(glm::vec3), sizeof(glm::vec3));
-                std::memcpy(&normal.x, normal_buffer.data() + i * sizeof(glm::vec3), sizeof(glm::vec3));
-                positions.push_back(position);
-                normals.push_back(normal);
+                const auto &streams = primitive.quantized.streams;
+                view.vertex_count = streams[VERTEX_ATTRIBUTE_POSITION].size() / get_vertex_attribute_formats(primitive.vertex_layout)[VERTEX_ATTRIBUTE_POSITION].stride;
+                view.dequantization = primitive.quantized.dequantization;
+                view.positions = streams[VERTEX_ATTRIBUTE_POSITION];
+                view.normals = streams[VERTEX_ATTRIBUTE_NORMAL];
+                view.texcoords = streams[VERTEX_ATTRIBUTE_TEXCOORD];
+                view.bone_ids = streams[VERTEX_ATTRIBUTE_BONE_ID];
+                view.bone_weights = streams[VERTEX_ATTRIBUTE_BONE_WEIGHT];
             }
-        };
-
-        auto detect_skin = [](const tinygltf::Primitive &gltf_primitive) -> bool
-        {
-            return (gltf_primitive.attributes.find("WEIGHTS_0") != gltf_primitive.attributes.end()) && (gltf_primitive.attributes.find("JOINTS_0") != gltf_primitive.attributes.end());
-        };
+            views.push_back(view);
+        }
+        return views;
+    }
 
-        primitives.reserve(mesh.primitives.size());
-        for (const auto &primitive : mesh.primitives)
+    ModelMesh::ModelMesh(MeshArena& arena, gfx::data::UploadBatch& batch, std::span<const ModelMeshPrimitiveView> primitive_views)
+    {
+        primitives.reserve(primitive_views.size());
+        for (const auto &primitive : primitive_views)
         {
-            std::vector<glm::vec3> positions{};
-            std::vector<glm::vec3> normals{};
-            std::vector<glm::vec2> texcoords{};
-            std::vector<uint32_t> indices{};
-            std::vector<glm::vec<4, uint16_t>> bone_ids{};
-            std::vector<glm::vec4> bone_weights{};
-            extract_indices_from_primitive(primitive, indices);
-            extract_data_from_primitive(primitive, positions, normals, texcoords, bone_ids, bone_weights);
-
+            assert(!primitive.lods.empty());
+            const std::span<const unsigned char> streams[VERTEX_ATTRIBUTE_COUNT] = {
+                primitive.positions,
+                primitive.normals,
+                primitive.texcoords,
+                primitive.bone_ids,
+                primitive.bone_weights};
             ModelMeshPrimitive new_primitive(
-                (uint32_t)indices.size(),
-                gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, sizeof(uint32_t) * indices.size(), indices.data()),
-                gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(glm::vec3) * positions.size(), positions.data()),
-                gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(glm::vec3) * normals.size(), normals.data()),
-                gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(glm::vec2) * texcoords.size(), texcoords.data()),
-                gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(glm::vec<4, uint16_t>) * bone_ids.size(), bone_ids.data()),
-                gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(glm::vec4) * bone_weights.size(), bone_weights.data()),
-                (int32_t)primitive.material,
-                detect_skin(primitive)
+                primitive.lods.front().count,
+                primitive.index_type,
+                arena.allocate(batch, primitive.vertex_layout, primitive.vertex_count, streams, primitive.indices, primitive.index_type),
+                primitive.material_index,
+                primitive.has_skin,
+                std::vector<MeshLod>(primitive.lods.begin(), primitive.lods.end()),
+                primitive.bounding_sphere,
+                primitive.vertex_layout,
+                primitive.dequantization
             );
             primitives.emplace_back(std::move(new_primitive));
         }
-    }   
+    }
     ModelMesh::~ModelMesh()
     {
 
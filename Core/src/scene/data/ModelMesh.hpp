@@ -2,9 +2,16 @@
 
 #include <memory>
 #include <vector>
+#include <span>
 #include <cstdint>
 
-#include <Core/src/gfx/data/GPUBuffer.hpp>
+#include "MeshArena.hpp"
+#include "MeshOptimizer.hpp"
+#include "VertexQuantization.hpp"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
 namespace tinygltf
 {
@@ -14,32 +21,87 @@ namespace tinygltf
 
 namespace gage::gfx
 {
-    class Graphics;
+    namespace data
+    {
+        class UploadBatch;
+    }
 }
 
 namespace gage::scene::data
 {
+    // Vertex data of a primitive as extracted from gltf and optimized, kept on the cpu until it is uploaded.
+    // Primitives with less than 65536 vertices keep 16 bit indices in short_indices, the others 32 bit indices in indices.
+    // The index buffer holds every level of detail, lods[0] is the full detail one.
+    // The float streams are packed into quantized and freed unless vertex_layout is Full
+    struct ModelMeshPrimitiveData
+    {
+        std::vector<uint32_t> indices{};
+        std::vector<uint16_t> short_indices{};
+        std::vector<MeshLod> lods{};
+        glm::vec4 bounding_sphere{}; // Center and radius
+        std::vector<glm::vec3> positions{};
+        std::vector<glm::vec3> normals{};
+        std::vector<glm::vec2> texcoords{};
+        std::vector<glm::vec<4, uint16_t>> bone_ids{};
+        std::vector<glm::vec4> bone_weights{};
+        VertexLayout vertex_layout{VertexLayout::Full};
+        QuantizedVertices quantized{};
+        int32_t material_index{};
+        bool has_skin{};
+    };
+
+    // Vertex streams of a primitive in the formats the pipelines bind, either extracted data or slices of a cooked file
+    struct ModelMeshPrimitiveView
+    {
+        std::span<const unsigned char> indices{};     // Of index_type
+        VkIndexType index_type{VK_INDEX_TYPE_UINT32};
+        std::span<const MeshLod> lods{};
+        glm::vec4 bounding_sphere{};
+        uint32_t vertex_count{};
+        VertexLayout vertex_layout{VertexLayout::Full};
+        VertexDequantization dequantization{};
+        std::span<const unsigned char> positions{};   // Formats of vertex_layout
+        std::span<const unsigned char> normals{};
+        std::span<const unsigned char> texcoords{};
+        std::span<const unsigned char> bone_ids{};
+        std::span<const unsigned char> bone_weights{};
+        int32_t material_index{};
+        bool has_skin{};
+    };
+
+    class ModelMeshData
+    {
+    public:
+        // Reads the accessors in place, optimizes the primitives and builds their levels of detail.
+        // Does not touch the gpu, safe on any thread
+        ModelMeshData(const tinygltf::Model& model, const tinygltf::Mesh& mesh, const MeshLodSettings& lod_settings, VertexLayout vertex_layout);
+
+        std::vector<ModelMeshPrimitiveView> get_views() const;
+    public:
+        std::vector<ModelMeshPrimitiveData> primitives{};
+    };
+
     class ModelMeshPrimitive
     {
     public:
         ModelMeshPrimitive(uint32_t vertex_count, 
-            gfx::data::GPUBuffer index_buffer,
-            gfx::data::GPUBuffer position_buffer,
-            gfx::data::GPUBuffer normal_buffer,
-            gfx::data::GPUBuffer texcoord_buffer,
-            gfx::data::GPUBuffer bone_id_buffer, 
-            gfx::data::GPUBuffer bone_weight_buffer,
+            VkIndexType index_type,
+            MeshAllocation allocation,
             uint32_t material_index,
-            bool has_skin) :
+            bool has_skin,
+            std::vector<MeshLod> lods,
+            glm::vec4 bounding_sphere,
+            VertexLayout vertex_layout,
+            const VertexDequantization& dequantization) :
             vertex_count(vertex_count),
-            index_buffer(std::move(index_buffer)),
-            position_buffer(std::move(position_buffer)),
-            normal_buffer(std::move(normal_buffer)),
-            texcoord_buffer(std::move(texcoord_buffer)),
-            bone_id_buffer(std::move(bone_id_buffer)),
-            bone_weight_buffer(std::move(bone_weight_buffer)),
+            index_type(index_type),
+            allocation(std::move(allocation)),
             material_index(material_index),
-            has_skin(has_skin)
+            has_skin(has_skin),
+            lods(std::move(lods)),
+            bounding_sphere(bounding_sphere),
+            vertex_layout(vertex_layout),
+            dequantization(dequantization)
             {}
         ~ModelMeshPrimitive();
 
@@ -49,19 +111,20 @@ namespace gage::scene::data
         ModelMeshPrimitive operator=(const ModelMeshPrimitive&) = delete;
     public:
         uint32_t vertex_count{};
-        gfx::data::GPUBuffer index_buffer; 
-        gfx::data::GPUBuffer position_buffer; 
-        gfx::data::GPUBuffer normal_buffer; 
-        gfx::data::GPUBuffer texcoord_buffer;
-        gfx::data::GPUBuffer bone_id_buffer;
-        gfx::data::GPUBuffer bone_weight_buffer;
+        VkIndexType index_type{VK_INDEX_TYPE_UINT32};
+        MeshAllocation allocation; // Vertex streams and indices in the renderer's mesh arena
         int32_t material_index{};
         bool has_skin{};
+        std::vector<MeshLod> lods{}; // Ranges of the primitive's indices, lods[0] is the full detail one
+        glm::vec4 bounding_sphere{};
+        VertexLayout vertex_layout{VertexLayout::Full}; // Picks the pipeline, dequantization goes in the push constants
+        VertexDequantization dequantization{};
     };
     class ModelMesh
     {
     public:
-        ModelMesh(const gfx::Graphics& gfx, const tinygltf::Model& model, const tinygltf::Mesh& mesh);
+        // Primitives can be drawn once batch completed, the viewed data can be freed after that
+        ModelMesh(MeshArena& arena, gfx::data::UploadBatch& batch, std::span<const ModelMeshPrimitiveView> primitive_views);
         ~ModelMesh();
 
         ModelMesh(ModelMesh&&) = default;
@@ -18,6 +18,7 @@ namespace gage::scene::data
     class ModelNode
     { 
     public:
+        ModelNode() = default;
         ModelNode(const tinygltf::Node& node, uint32_t node_index);
         ~ModelNode() = default;
     public:
@@ -0,0 +1,163 @@
+#include <pch.hpp>
+#include "VertexQuantization.hpp"
+
+#include <algorithm>
+
+namespace gage::scene::data
+{
+    const std::array<VertexAttributeFormat, VERTEX_ATTRIBUTE_COUNT>& get_vertex_attribute_formats(VertexLayout layout)
+    {
+        static const std::array<VertexAttributeFormat, VERTEX_ATTRIBUTE_COUNT> FORMATS[VERTEX_LAYOUT_COUNT] = {
+            {{
+                {VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3},
+                {VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3},
+                {VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 2},
+                {VK_FORMAT_R16G16B16A16_UINT, sizeof(uint16_t) * 4},
+                {VK_FORMAT_R32G32B32A32_SFLOAT, sizeof(float) * 4},
+            }},
+            {{
+                {VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3},
+                {VK_FORMAT_R16G16_SNORM, sizeof(int16_t) * 2},
+                {VK_FORMAT_R16G16_UNORM, sizeof(uint16_t) * 2},
+                {VK_FORMAT_R8G8B8A8_UINT, sizeof(uint8_t) * 4},
+                {VK_FORMAT_R8G8B8A8_UNORM, sizeof(uint8_t) * 4},
+            }},
+            {{
+                {VK_FORMAT_R16G16B16A16_UNORM, sizeof(uint16_t) * 4},
+                {VK_FORMAT_R16G16_SNORM, sizeof(int16_t) * 2},
+                {VK_FORMAT_R16G16_UNORM, sizeof(uint16_t) * 2},
+                {VK_FORMAT_R8G8B8A8_UINT, sizeof(uint8_t) * 4},
+                {VK_FORMAT_R8G8B8A8_UNORM, sizeof(uint8_t) * 4},
+            }},
+        };
+        assert((uint32_t)layout < VERTEX_LAYOUT_COUNT);
+        return FORMATS[(uint32_t)layout];
+    }
+
+    glm::vec<2, int16_t> encode_octahedral_normal(const glm::vec3 &normal)
+    {
+        float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        if (sum == 0.0f)
+            return {0, 0};
+
+        glm::vec3 n = normal / sum;
+        glm::vec2 p{n.x, n.y};
+        if (n.z < 0.0f)
+        {
+            p = glm::vec2{1.0f - std::abs(n.y), 1.0f - std::abs(n.x)};
+            p.x *= n.x >= 0.0f ? 1.0f : -1.0f;
+            p.y *= n.y >= 0.0f ? 1.0f : -1.0f;
+        }
+        return {
+            static_cast<int16_t>(std::round(std::clamp(p.x, -1.0f, 1.0f) * 32767.0f)),
+            static_cast<int16_t>(std::round(std::clamp(p.y, -1.0f, 1.0f) * 32767.0f))};
+    }
+
+    uint16_t quantize_unorm16(float value)
+    {
+        return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+
+    template <typename T>
+    static T *resize_stream(std::vector<unsigned char> &stream, size_t count)
+    {
+        stream.resize(count * sizeof(T));
+        return reinterpret_cast<T *>(stream.data());
+    }
+
+    bool quantize_vertices(VertexLayout layout,
+        std::span<const glm::vec3> positions,
+        std::span<const glm::vec3> normals,
+        std::span<const glm::vec2> texcoords,
+        std::span<const glm::vec<4, uint16_t>> bone_ids,
+        std::span<const glm::vec4> bone_weights,
+        QuantizedVertices &result)
+    {
+        assert(layout != VertexLayout::Full);
+        const size_t vertex_count = positions.size();
+        assert(normals.size() == vertex_count && texcoords.size() == vertex_count && bone_ids.size() == vertex_count && bone_weights.size() == vertex_count);
+
+        for (const auto &ids : bone_ids)
+        {
+            if (ids.x > 255 || ids.y > 255 || ids.z > 255 || ids.w > 255)
+                return false;
+        }
+
+        result = {};
+        VertexDequantization &dequantization = result.dequantization;
+
+        if (layout == VertexLayout::QuantizedPosition)
+        {
+            glm::vec3 min{std::numeric_limits<float>::max()};
+            glm::vec3 max{std::numeric_limits<float>::lowest()};
+            for (const glm::vec3 &position : positions)
+            {
+                min = glm::min(min, position);
+                max = glm::max(max, position);
+            }
+            if (vertex_count == 0)
+                min = max = glm::vec3{0.0f};
+            glm::vec3 extent = max - min;
+            dequantization.position_offset = glm::vec4{min, 0.0f};
+            dequantization.position_scale = glm::vec4{extent, 0.0f};
+
+            auto *out = resize_stream<glm::vec<4, uint16_t>>(result.streams[VERTEX_ATTRIBUTE_POSITION], vertex_count);
+            for (size_t i = 0; i < vertex_count; i++)
+            {
+                for (int c = 0; c < 3; c++)
+                    out[i][c] = extent[c] > 0.0f ? quantize_unorm16((positions[i][c] - min[c]) / extent[c]) : 0;
+                out[i].w = 0;
+            }
+        }
+        else
+        {
+            auto *out = resize_stream<glm::vec3>(result.streams[VERTEX_ATTRIBUTE_POSITION], vertex_count);
+            std::copy(positions.begin(), positions.end(), out);
+        }
+
+        auto *out_normals = resize_stream<glm::vec<2, int16_t>>(result.streams[VERTEX_ATTRIBUTE_NORMAL], vertex_count);
+        for (size_t i = 0; i < vertex_count; i++)
+            out_normals[i] = encode_octahedral_normal(normals[i]);
+
+        // Texcoords are quantized inside their bounds, so tiling beyond [0, 1] keeps its precision
+        glm::vec2 uv_min{std::numeric_limits<float>::max()};
+        glm::vec2 uv_max{std::numeric_limits<float>::lowest()};
+        for (const glm::vec2 &texcoord : texcoords)
+        {
+            uv_min = glm::min(uv_min, texcoord);
+            uv_max = glm::max(uv_max, texcoord);
+        }
+        if (vertex_count == 0)
+            uv_min = uv_max = glm::vec2{0.0f};
+        glm::vec2 uv_extent = uv_max - uv_min;
+        dequantization.texcoord_transform = glm::vec4{uv_min, uv_extent};
+        auto *out_texcoords = resize_stream<glm::vec<2, uint16_t>>(result.streams[VERTEX_ATTRIBUTE_TEXCOORD], vertex_count);
+        for (size_t i = 0; i < vertex_count; i++)
+        {
+            for (int c = 0; c < 2; c++)
+                out_texcoords[i][c] = uv_extent[c] > 0.0f ? quantize_unorm16((texcoords[i][c] - uv_min[c]) / uv_extent[c]) : 0;
+        }
+
+        auto *out_ids = resize_stream<glm::vec<4, uint8_t>>(result.streams[VERTEX_ATTRIBUTE_BONE_ID], vertex_count);
+        auto *out_weights = resize_stream<glm::vec<4, uint8_t>>(result.streams[VERTEX_ATTRIBUTE_BONE_WEIGHT], vertex_count);
+        for (size_t i = 0; i < vertex_count; i++)
+        {
+            out_ids[i] = glm::vec<4, uint8_t>(bone_ids[i]);
+
+            // Rounded weights of a skinned vertex keep summing to one, the error goes to the largest
+            const glm::vec4 &weights = bone_weights[i];
+            int32_t sum = 0;
+            int32_t largest = 0;
+            for (int c = 0; c < 4; c++)
+            {
+                out_weights[i][c] = static_cast<uint8_t>(std::clamp(weights[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+                sum += out_weights[i][c];
+                if (weights[c] > weights[largest])
+                    largest = c;
+            }
+            if (sum > 0)
+                out_weights[i][largest] = static_cast<uint8_t>(std::clamp<int32_t>(out_weights[i][largest] + 255 - sum, 0, 255));
+        }
+        return true;
+    }
+}
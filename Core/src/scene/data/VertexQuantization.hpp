@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace gage::scene::data
+{
+    // Formats of the position, normal, texcoord, bone id and bone weight streams of a primitive, chosen per mesh at import
+    enum class VertexLayout : uint32_t
+    {
+        Full,              // 56 bytes: vec3 position, vec3 normal, vec2 texcoord, u16vec4 bone ids, vec4 bone weights
+        Quantized,         // 28 bytes: vec3 position, octahedral snorm16x2 normal, unorm16x2 texcoord, u8vec4 bone ids, unorm8x4 bone weights
+        QuantizedPosition  // 24 bytes: Quantized with unorm16x4 positions inside the primitive bounds
+    };
+    static constexpr uint32_t VERTEX_LAYOUT_COUNT = 3;
+
+    struct VertexAttributeFormat
+    {
+        VkFormat format{};
+        uint32_t stride{};
+    };
+
+    enum VertexAttribute : uint32_t
+    {
+        VERTEX_ATTRIBUTE_POSITION,
+        VERTEX_ATTRIBUTE_NORMAL,
+        VERTEX_ATTRIBUTE_TEXCOORD,
+        VERTEX_ATTRIBUTE_BONE_ID,
+        VERTEX_ATTRIBUTE_BONE_WEIGHT,
+        VERTEX_ATTRIBUTE_COUNT
+    };
+
+    const std::array<VertexAttributeFormat, VERTEX_ATTRIBUTE_COUNT>& get_vertex_attribute_formats(VertexLayout layout);
+
+    // What the vertex shaders undo the quantization with, the identity for float streams. Matches the push constants after the transform
+    struct VertexDequantization
+    {
+        glm::vec4 position_offset{0.0f};
+        glm::vec4 position_scale{1.0f};
+        glm::vec4 texcoord_transform{0.0f, 0.0f, 1.0f, 1.0f}; // Offset in xy, scale in zw
+    };
+
+    struct QuantizedVertices
+    {
+        std::array<std::vector<unsigned char>, VERTEX_ATTRIBUTE_COUNT> streams{};
+        VertexDequantization dequantization{};
+    };
+
+    // Packs float streams of equal length into layout (not Full). False if they do not fit, bone ids above 255
+    bool quantize_vertices(VertexLayout layout,
+        std::span<const glm::vec3> positions,
+        std::span<const glm::vec3> normals,
+        std::span<const glm::vec2> texcoords,
+        std::span<const glm::vec<4, uint16_t>> bone_ids,
+        std::span<const glm::vec4> bone_weights,
+        QuantizedVertices& result);
+
+    // Unit vector folded onto the octahedron as snorm16x2, zero vectors decode to +z
+    glm::vec<2, int16_t> encode_octahedral_normal(const glm::vec3& normal);
+    uint16_t quantize_unorm16(float value);
+}
@@ -3,6 +3,7 @@
 
 #include "../scene.hpp"
 #include "../Node.hpp"
+#include "../ModelInstance.hpp"
 #include "../data/Model.hpp"
 
 #include "../components/MeshRenderer.hpp"
@@ -10,6 +11,23 @@
 #include <set>
 namespace gage::scene::systems
 {
+    // Index of the key frame before current_time, key frames are sorted.
+    // Past the last key frame this wraps back to the first one
+    static int32_t get_key_frame_index(double current_time, const std::vector<float> &key_frames)
+    {
+        auto it = std::upper_bound(key_frames.begin() + 1, key_frames.end(), current_time);
+        if (it == key_frames.end())
+            return 0;
+        return (int32_t)std::distance(key_frames.begin(), it) - 1;
+    }
+
+    static float get_scale_factor(float current_time_point, float next_time_point, float current_time)
+    {
+        float current_time_rev_to_current_time_point = current_time - current_time_point;
+        float diff = next_time_point - current_time_point;
+        return current_time_rev_to_current_time_point / diff;
+    }
+
     Animation::Animation()
     {
     }
@@ -17,107 +35,96 @@ namespace gage::scene::systems
     {
     }
 
-    void Animation::init()
+    void Animation::init(utils::LinearArena &scratch_arena)
     {
-        for (std::unique_ptr<components::Animator> &animator : animators)
+        for (components::Animator &animator : animators)
         {
-            std::vector<void *> mesh_renderers{};
-            animator->node.get_requested_component_accumulate_recursive(typeid(components::MeshRenderer).name(), mesh_renderers);
+            init_animator(animator, scratch_arena);
+        }
+    }
 
-            for (void *ptrs : mesh_renderers)
-            {
-                animator->p_mesh_renderers.push_back((components::MeshRenderer *)ptrs);
-            }
+    void Animation::init_animator(components::Animator &animator, utils::LinearArena &scratch_arena)
+    {
+        utils::ArenaVector<components::MeshRenderer *> mesh_renderers(scratch_arena);
+        animator.node.get_requested_component_accumulate_recursive<components::MeshRenderer>(mesh_renderers);
+
+        animator.p_mesh_renderers.insert(animator.p_mesh_renderers.end(), mesh_renderers.begin(), mesh_renderers.end());
 
-            log().trace("Animator found {} meshes with skin.", mesh_renderers.size());
+        log().trace("Animator found {} meshes with skin.", mesh_renderers.size());
+    }
+
+    void Animation::remove_mesh_renderer(components::MeshRenderer *mesh_renderer)
+    {
+        for (components::Animator &animator : animators)
+        {
+            std::erase(animator.p_mesh_renderers, mesh_renderer);
         }
     }
     void Animation::update(float delta)
     {
-        for (std::unique_ptr<components::Animator> &animator : animators)
+        for (components::Animator &animator : animators)
         {
-            for (const auto mesh_renderer : animator->p_mesh_renderers)
+            for (const auto mesh_renderer : animator.p_mesh_renderers)
             {
-                mesh_renderer->get_animation_buffer().enabled = (animator->current_animation != nullptr);
+                mesh_renderer->get_animation_buffer().enabled = (animator.current_animation != nullptr);
             }
-            if (animator->current_animation == nullptr)
+            if (animator.current_animation == nullptr)
                 continue;
 
-            animator->current_time += delta;
-
-            auto get_key_frame_index = [](double current_time, const std::vector<float> &key_frames) -> int32_t
-            {
-                for (int32_t index = 0; index < ((int64_t)key_frames.size() - 1); index++)
-                {
-                    if (current_time < key_frames.at(index + 1))
-                        return index;
-                }
-                return 0;
-            };
-
-            auto get_scale_factor = [](float current_time_point, float next_time_point, float current_time)
-            {
-                float scale_factor = 0.0f;
-                float current_time_rev_to_current_time_point = current_time - current_time_point;
-                float diff = next_time_point - current_time_point;
-                scale_factor = current_time_rev_to_current_time_point / diff;
-
-                // scale_factor = std::floor(scale_factor);
-                return scale_factor;
-            };
+            animator.current_time += delta;
 
-            for (const auto &channel : animator->current_animation->pos_channels)
+            for (const auto &channel : animator.current_animation->pos_channels)
             {
                 // Interpolate position
                 if (channel.time_points.size() >= 2)
                 {
-                    int index = get_key_frame_index(animator->current_time, channel.time_points);
-                    float scale_factor = get_scale_factor(channel.time_points.at(index), channel.time_points.at(index + 1), animator->current_time);
+                    int index = get_key_frame_index(animator.current_time, channel.time_points);
+                    float scale_factor = get_scale_factor(channel.time_points.at(index), channel.time_points.at(index + 1), animator.current_time);
                     glm::vec3 position = glm::mix(channel.positions.at(index), channel.positions.at(index + 1), scale_factor);
-                    animator->bone_id_to_joint_map.at(channel.target_node)->position = position;
+                    animator.bone_id_to_joint_map.at(channel.target_node)->set_position(position);
                 }
             }
 
-            for (const auto &channel : animator->current_animation->scale_channels)
+            for (const auto &channel : animator.current_animation->scale_channels)
             {
 
                 // Interpolate position
                 if (channel.time_points.size() >= 2)
                 {
-                    int index = get_key_frame_index(animator->current_time, channel.time_points);
-                    float scale_factor = get_scale_factor(channel.time_points.at(index), channel.time_points.at(index + 1), animator->current_time);
+                    int index = get_key_frame_index(animator.current_time, channel.time_points);
+                    float scale_factor = get_scale_factor(channel.time_points.at(index), channel.time_points.at(index + 1), animator.current_time);
                     glm::vec3 scale = glm::mix(channel.scales.at(index), channel.scales.at(index + 1), scale_factor);
-                    animator->bone_id_to_joint_map.at(channel.target_node)->scale = scale;
+                    animator.bone_id_to_joint_map.at(channel.target_node)->set_scale(scale);
                 }
             }
 
-            for (const auto &channel : animator->current_animation->rotation_channels)
+            for (const auto &channel : animator.current_animation->rotation_channels)
             {
 
                 // Interpolate position
                 if (channel.time_points.size() >= 2)
                 {
-                    int index = get_key_frame_index(animator->current_time, channel.time_points);
-                    float scale_factor = get_scale_factor(channel.time_points.at(index), channel.time_points.at(index + 1), animator->current_time);
+                    int index = get_key_frame_index(animator.current_time, channel.time_points);
+                    float scale_factor = get_scale_factor(channel.time_points.at(index), channel.time_points.at(index + 1), animator.current_time);
                     glm::quat rotation = glm::slerp(channel.rotations.at(index), channel.rotations.at(index + 1), scale_factor);
-                    animator->bone_id_to_joint_map.at(channel.target_node)->rotation = rotation;
+                    animator.bone_id_to_joint_map.at(channel.target_node)->set_rotation(rotation);
                 }
             }
 
-            animator->current_time = std::fmod(animator->current_time, animator->current_animation->duration);
+            animator.current_time = std::fmod(animator.current_time, animator.current_animation->duration);
         }
     }
     void Animation::late_update(float delta)
     {
-        for (std::unique_ptr<components::Animator> &animator : animators)
+        for (components::Animator &animator : animators)
         {
-            if (animator->current_animation == nullptr)
+            if (animator.current_animation == nullptr)
                 continue;
-            for (const auto &[skeleton_id, joint] : animator->skeleton_id_to_joint_map)
+            for (const auto &[skeleton_id, joint] : animator.skeleton_id_to_joint_map)
             {
-                for (const auto mesh_renderer : animator->p_mesh_renderers)
+                for (const auto mesh_renderer : animator.p_mesh_renderers)
                 {
-                    mesh_renderer->get_animation_buffer().bone_matrices[skeleton_id] = joint->global_transform * joint->inverse_bind_transform;
+                    mesh_renderer->get_animation_buffer().bone_matrices[skeleton_id] = joint->get_global_transform() * joint->inverse_bind_transform;
                 }
             }
         }
@@ -125,16 +132,29 @@ namespace gage::scene::systems
     void Animation::shutdown()
     {
     }
-    void Animation::add_animator(std::unique_ptr<components::Animator> animator)
-    {
-        animators.push_back(std::move(animator));
-    }
-
     void Animation::set_animator_animation(components::Animator *animator, const std::string &animation)
     {
+        // Called every tick by scripts, bail out before building anything
+        if (animator->current_animation && animator->current_animation->name.compare(animation) == 0)
+        {
+            return;
+        }
+
+        std::function<void(std::map<uint32_t, Node *> & out_joints, const std::set<uint32_t> &bone_ids, Node *node)> link_bone_id_recursive;
+        link_bone_id_recursive = [&link_bone_id_recursive](std::map<uint32_t, Node *> &out_joints, const std::set<uint32_t> &bone_ids, Node *node)
+        {
+            if (bone_ids.contains(node->bone_id))
+            {
+                out_joints.insert({node->bone_id, node});
+            }
+            for (Node *child : node->get_children())
+            {
+                link_bone_id_recursive(out_joints, bone_ids, child);
+            }
+        };
 
-        std::function<void(std::map<uint32_t, Node *> & out_joints, const data::ModelAnimation &animation, Node *node)> link_bone_id_recursive;
-        link_bone_id_recursive = [&link_bone_id_recursive](std::map<uint32_t, Node *> &out_joints, const data::ModelAnimation &animation, Node *node)
+        // Bone ids are model node indices, an instance of the animator's model maps them straight to its nodes
+        auto link_bone_id = [&link_bone_id_recursive](std::map<uint32_t, Node *> &out_joints, const data::ModelAnimation &animation, Node &root, const data::Model &model)
         {
             std::set<uint32_t> bone_ids;
             for (const auto &channel : animation.pos_channels)
@@ -145,23 +165,26 @@ namespace gage::scene::systems
             {
                 bone_ids.insert(channel.target_node);
             }
-
             for (const auto &channel : animation.scale_channels)
             {
                 bone_ids.insert(channel.target_node);
             }
 
+            const ModelInstance *instance = root.get_model_instance();
+            if (instance == nullptr || &instance->model != &model)
+            {
+                link_bone_id_recursive(out_joints, bone_ids, &root);
+                return;
+            }
+
             for (uint32_t bone_id : bone_ids)
             {
-                if (bone_id == node->bone_id)
+                Node *joint = root.get_instance_node(bone_id);
+                if (joint)
                 {
-                    out_joints.insert({bone_id, node});
+                    out_joints.insert({bone_id, joint});
                 }
             }
-            for (const auto &child : node->children)
-            {
-                link_bone_id_recursive(out_joints, animation, child);
-            }
         };
 
         std::function<void(std::map<uint32_t, Node *> & out_joints, const std::map<uint32_t, Node *> &in_joints, const std::vector<uint32_t> &skeleton_joint_indices)> link_skeleton_id;
@@ -176,10 +199,6 @@ namespace gage::scene::systems
             }
         };
 
-        if (animator->current_animation && animator->current_animation->name.compare(animation) == 0)
-        {
-            return;
-        }
         animator->current_animation = nullptr;
         animator->bone_id_to_joint_map.clear();
         animator->skeleton_id_to_joint_map.clear();
@@ -190,7 +209,7 @@ namespace gage::scene::systems
             {
                 animator->current_animation = &model_animation;
                 // Link all joints
-                link_bone_id_recursive(animator->bone_id_to_joint_map, model_animation, &animator->node);
+                link_bone_id(animator->bone_id_to_joint_map, model_animation, animator->node, animator->model);
 
                 for (const auto mesh_renderer : animator->p_mesh_renderers)
                 {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../components/Animator.hpp"
+#include <Core/src/utils/PagedPool.hpp>
+
 #include <vector>
 #include <memory>
 
@@ -9,6 +11,11 @@ namespace gage::scene
     class SceneGraph;
 }
 
+namespace gage::utils
+{
+    class LinearArena;
+}
+
 namespace gage::scene::systems
 {
     class Animation
@@ -18,15 +25,18 @@ namespace gage::scene::systems
         Animation();
         ~Animation();
         
-        void init();
+        void init(utils::LinearArena& scratch_arena);
+        // Links the mesh renderers below the animator's node, they have to be added before the animator
+        void init_animator(components::Animator& animator, utils::LinearArena& scratch_arena);
+        // Unlinks a mesh renderer that is about to be destroyed from every animator
+        void remove_mesh_renderer(components::MeshRenderer* mesh_renderer);
         void update(float delta);
         void late_update(float delta);
 
         void shutdown();
 
-        void add_animator(std::unique_ptr<components::Animator> animator);
         static void set_animator_animation(components::Animator* animator, const std::string&  animation);
     private:
-        std::vector<std::unique_ptr<components::Animator>> animators; 
+        utils::PagedPool<components::Animator> animators;
     };
 }
\ No newline at end of file
@@ -44,4 +44,15 @@ namespace gage::scene::systems
     {
         scripts.push_back(std::move(script));
     }
+
+    void Generic::remove_script(components::Script *script)
+    {
+        auto it = std::find_if(scripts.begin(), scripts.end(), [script](const std::unique_ptr<components::Script> &owned)
+                               { return owned.get() == script; });
+        assert(it != scripts.end() && "Script is not owned by Generic");
+
+        script->shutdown();
+        std::swap(*it, scripts.back());
+        scripts.pop_back();
+    }
 }
\ No newline at end of file
@@ -31,6 +31,8 @@ namespace gage::scene::systems
         void shutdown();
 
         void add_script(std::unique_ptr<components::Script> script);
+        // Shuts the script down and destroys it
+        void remove_script(components::Script* script);
     private:
         std::vector<std::unique_ptr<components::Script>> scripts; 
     };
@@ -2,17 +2,31 @@
 #include "MapRenderer.hpp"
 
 #include "../Node.hpp"
+#include "../AssetCache.hpp"
+#include "../data/AccessorView.hpp"
+#include "../data/MeshOptimizer.hpp"
+#include "../data/VertexQuantization.hpp"
 
 #include <Core/src/gfx/Graphics.hpp>
 #include <Core/src/utils/FileLoader.hpp>
+#include <Core/src/utils/LinearArena.hpp>
 #include <Core/src/gfx/data/g_buffer/GBuffer.hpp>
 
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <numeric>
+
 namespace gage::scene::systems
 {
-    MapRenderer::MapRenderer(const gfx::Graphics &gfx) : gfx(gfx)
+    MapRenderer::MapVertex::MapVertex(const glm::vec3 &position, const glm::vec3 &normal, const glm::vec2 &uv) :
+        position(position),
+        uv(uv),
+        normal(data::encode_octahedral_normal(normal))
+    {
+    }
+
+    MapRenderer::MapRenderer(const gfx::Graphics &gfx, AssetCache &assets) : gfx(gfx), assets(assets)
     {
         create_pipeline();
         create_depth_pipeline();
@@ -32,7 +46,7 @@ namespace gage::scene::systems
         for (auto &map : maps)
         {
             // Process aabb walls
-            for (const auto &aabb_wall : map->aabb_walls)
+            for (const auto &aabb_wall : map.aabb_walls)
             {
                 process_aabb_wall(aabb_wall);
             }
@@ -43,11 +57,12 @@ namespace gage::scene::systems
             }
 
             // Load static models
-            for (const auto &model_path : map->static_models)
+            for (const auto &model_path : map.static_models)
             {
                 if (model_path_to_model_map.find(model_path.model_path) == model_path_to_model_map.end())
                 {
-                    create_new_static_model(model_path.model_path);
+                    model_path_to_model_map[model_path.model_path] = assets.get_derived<StaticModelData>(model_path.model_path, "map_static_model", [&]()
+                                                                                                         { return create_new_static_model(model_path.model_path); });
                 }
             }
         }
@@ -66,10 +81,6 @@ namespace gage::scene::systems
         image_path_to_geometry_data_map.clear();
         model_path_to_model_map.clear();
     }
-    void MapRenderer::add_map(std::shared_ptr<components::Map> map)
-    {
-        maps.push_back(std::move(map));
-    }
     void MapRenderer::render(VkCommandBuffer cmd) const
     {
         VkViewport viewport = {};
@@ -98,23 +109,23 @@ namespace gage::scene::systems
                 VkBuffer buffers[] ={geometry_data.vertex_buffer->get_buffer_handle()};
                 VkDeviceSize offsets[] ={0};
 
-                vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4x4), glm::value_ptr(map->node.global_transform));
+                vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4x4), glm::value_ptr(map.node.get_global_transform()));
                 vkCmdBindVertexBuffers(cmd, 0, sizeof(buffers) / sizeof(buffers[0]), buffers, offsets);
                 vkCmdDraw(cmd, geometry_data.vertex_count, 1, 0, 0);
             }
 
-            for (const auto &model_path : map->static_models)
+            for (const auto &model_path : map.static_models)
             {
-                const auto &model = model_path_to_model_map.at(model_path.model_path);
+                const auto &model = *model_path_to_model_map.at(model_path.model_path);
                 VkBuffer buffers[] ={model.vertex_buffer.get_buffer_handle()};
                 VkDeviceSize offsets[] ={0};
 
-                glm::mat4x4 offset = map->node.global_transform;
+                glm::mat4x4 offset = map.node.get_global_transform();
                 offset = glm::translate(offset, model_path.offset);
 
                 vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4x4), glm::value_ptr(offset));
                 vkCmdBindVertexBuffers(cmd, 0, sizeof(buffers) / sizeof(buffers[0]), buffers, offsets);
-                vkCmdBindIndexBuffer(cmd, model.index_buffer.get_buffer_handle(), 0, VK_INDEX_TYPE_UINT32);
+                vkCmdBindIndexBuffer(cmd, model.index_buffer.get_buffer_handle(), 0, model.index_type);
                 vkCmdDrawIndexed(cmd, model.vertex_count, 1, 0, 0, 0);
             }
         }
@@ -149,26 +160,26 @@ namespace gage::scene::systems
                         geometry_data.vertex_buffer->get_buffer_handle()};
                 VkDeviceSize offsets[] =
                     {0, 0, 0, 0, 0};
-                vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4x4), glm::value_ptr(map->node.global_transform));
+                vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4x4), glm::value_ptr(map.node.get_global_transform()));
                 vkCmdBindVertexBuffers(cmd, 0, sizeof(buffers) / sizeof(buffers[0]), buffers, offsets);
                 vkCmdDraw(cmd, geometry_data.vertex_count, 1, 0, 0);
             }
 
             //static models
-            for (const auto &model_path : map->static_models)
+            for (const auto &model_path : map.static_models)
             {
-                const auto &model = model_path_to_model_map.at(model_path.model_path);
+                const auto &model = *model_path_to_model_map.at(model_path.model_path);
                 VkBuffer buffers[] =
                     {
                         model.vertex_buffer.get_buffer_handle()};
                 VkDeviceSize offsets[] =
                     {0};
-                glm::mat4x4 offset = map->node.global_transform;
+                glm::mat4x4 offset = map.node.get_global_transform();
                 offset = glm::translate(offset, model_path.offset);
             
                 vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4x4), glm::value_ptr(offset));
                 vkCmdBindVertexBuffers(cmd, 0, sizeof(buffers) / sizeof(buffers[0]), buffers, offsets);
-                vkCmdBindIndexBuffer(cmd, model.index_buffer.get_buffer_handle(), 0, VK_INDEX_TYPE_UINT32);
+                vkCmdBindIndexBuffer(cmd, model.index_buffer.get_buffer_handle(), 0, model.index_type);
                 vkCmdDrawIndexed(cmd, model.vertex_count, 1, 0, 0, 0);
             }
         }
@@ -210,7 +221,7 @@ namespace gage::scene::systems
 
         std::vector<VkVertexInputAttributeDescription> vertex_attributes{
             {.location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = 0},                           // position
-            {.location = 1, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(MapVertex, normal)}, // normal
+            {.location = 1, .binding = 0, .format = VK_FORMAT_R16G16_SNORM, .offset = offsetof(MapVertex, normal)},     // octahedral normal
             {.location = 2, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(MapVertex, uv)},
         };
 
@@ -563,44 +574,15 @@ namespace gage::scene::systems
 
     void MapRenderer::process_aabb_wall(const components::AABBWall &aabb_wall)
     {
-        auto load_image = [this](const std::string &file_path, uint32_t &out_width, uint32_t &out_height) -> std::unique_ptr<gfx::data::Image>
+        auto load_image = [this](const std::string &file_path) -> std::shared_ptr<const Texture>
         {
-            int w, h, comp;
-            stbi_uc *data = stbi_load(file_path.c_str(), &w, &h, &comp, STBI_rgb);
-
-            unsigned char error_image_data[] =
-                {
-                    0, 255, 0, 255, 0, 0,
-                    255, 255, 0, 255, 0, 255};
-
-            if (!data)
+            std::shared_ptr<const Texture> texture = assets.get_texture(file_path, TextureDesc{.mip_maps = true});
+            if (!texture)
             {
-                w = 2;
-                h = 2;
-                data = error_image_data;
+                texture = assets.get_derived<Texture>("", "map_error_texture", [this]()
+                                                      { return create_error_texture(); });
             }
-
-            gfx::data::ImageCreateInfo ci{};
-            ci.address_node = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-            ci.format = VK_FORMAT_R8G8B8_UNORM;
-            ci.mip_levels = 1;
-            ci.width = w;
-            ci.height = h;
-            ci.min_filter = VK_FILTER_NEAREST;
-            ci.mag_filter = VK_FILTER_NEAREST;
-            ci.image_data = data;
-            ci.size_in_bytes = w * h * 3;
-            auto image = std::make_unique<gfx::data::Image>(gfx, ci);
-
-            if (data != error_image_data)
-            {
-                stbi_image_free(data);
-            }
-
-            out_width = w;
-            out_height = h;
-
-            return image;
+            return texture;
         };
 
         auto create_descriptor_set = [this](VkImageView image_view, VkSampler sampler) -> VkDescriptorSet
@@ -638,8 +620,10 @@ namespace gage::scene::systems
         auto calculate_uv = [](const GeometryData &geometry_data, const components::AABBWallData &wall_data, glm::vec3 position, glm::vec3 tangent, glm::vec3 bi_tangent) -> glm::vec2
         {
             glm::vec2 uv{};
-            uv.x = glm::dot(position, tangent) / geometry_data.image_width * wall_data.uv_scale.x + wall_data.uv_offset.x / geometry_data.image_width;
-            uv.y = glm::dot(position, bi_tangent) / geometry_data.image_height * wall_data.uv_scale.y + wall_data.uv_offset.y / geometry_data.image_height;
+            float image_width = geometry_data.texture->width;
+            float image_height = geometry_data.texture->height;
+            uv.x = glm::dot(position, tangent) / image_width * wall_data.uv_scale.x + wall_data.uv_offset.x / image_width;
+            uv.y = glm::dot(position, bi_tangent) / image_height * wall_data.uv_scale.y + wall_data.uv_offset.y / image_height;
             return uv;
         };
 
@@ -650,9 +634,9 @@ namespace gage::scene::systems
                 GeometryData new_data;
                 new_data.vertex_count = 0;
                 new_data.vertex_buffer = nullptr;
-                new_data.image = load_image(texture, new_data.image_width, new_data.image_height);
+                new_data.texture = load_image(texture);
                 new_data.vertices = {};
-                new_data.image_descriptor_set = create_descriptor_set(new_data.image->get_image_view(), new_data.image->get_sampler());
+                new_data.image_descriptor_set = create_descriptor_set(new_data.texture->image.get_image_view(), new_data.texture->image.get_sampler());
 
                 image_path_to_geometry_data_map.insert({texture, std::move(new_data)});
             }
@@ -774,68 +758,43 @@ namespace gage::scene::systems
         }
     }
 
-    void MapRenderer::create_new_static_model(const std::string &model_path)
+    std::shared_ptr<const Texture> MapRenderer::create_error_texture()
     {
-        log().info("Importing static model: {}", model_path);
-
-        tinygltf::Model model;
-        tinygltf::TinyGLTF loader;
-        std::string err;
-        std::string warn;
-        if (!loader.LoadBinaryFromFile(&model, &err, &warn, model_path))
-        {
-            log().critical("Failed to import scene: {} | {} | {}", model_path, warn, err);
-            throw SceneException{"Failed to import scene: " + model_path + "| " + warn + "| " + err};
-        }
-
-        const tinygltf::Mesh &mesh = model.meshes.at(0);
-        auto extract_buffer_from_accessor = [&](const tinygltf::Accessor &accessor)
-            -> std::vector<unsigned char>
-        {
-            const auto &buffer_view = model.bufferViews.at(accessor.bufferView);
-            const auto &buffer = model.buffers.at(buffer_view.buffer);
-
-            std::vector<unsigned char> result(buffer_view.byteLength);
-            std::memcpy(result.data(), buffer.data.data() + buffer_view.byteOffset, buffer_view.byteLength);
-
-            return result;
-        };
-
-        auto extract_indices_from_primitive = [&](const tinygltf::Primitive &primitive, std::vector<uint32_t> &indices)
-        {
-            const auto &accessor = model.accessors.at(primitive.indices);
-            auto index_vector = extract_buffer_from_accessor(accessor);
-            switch (accessor.componentType)
-            {
-            case 5123:
+        unsigned char error_image_data[] =
             {
-                for (uint32_t i = 0; i < accessor.count; i++)
-                {
-                    const uint16_t *index = (const uint16_t *)&index_vector.at(i * sizeof(uint16_t));
-                    indices.push_back(uint32_t(*index));
-                }
-                break;
-            }
+                0, 255, 0, 255, 255, 0, 0, 255,
+                255, 255, 0, 255, 255, 0, 255, 255};
+
+        gfx::data::ImageCreateInfo ci{};
+        ci.address_node = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        ci.format = VK_FORMAT_R8G8B8A8_UNORM;
+        ci.mip_levels = 1;
+        ci.width = 2;
+        ci.height = 2;
+        ci.min_filter = VK_FILTER_NEAREST;
+        ci.mag_filter = VK_FILTER_NEAREST;
+        ci.image_data = error_image_data;
+        ci.size_in_bytes = sizeof(error_image_data);
+        return std::make_shared<Texture>(gfx, ci);
+    }
 
-            case 5125:
-            {
-                for (uint32_t i = 0; i < accessor.count; i++)
-                {
-                    const uint32_t *index = (const uint32_t *)&index_vector.at(i * sizeof(uint32_t));
-                    indices.push_back(uint32_t(*index));
-                }
-                break;
-            }
+    std::shared_ptr<const MapRenderer::StaticModelData> MapRenderer::create_new_static_model(const std::string &model_path)
+    {
+        log().info("Importing static model: {}", model_path);
 
-            default:
-                throw SceneException{"Invalid index component type !"};
-            }
-        };
+        std::shared_ptr<const tinygltf::Model> gltf_model = assets.get_gltf(model_path, data::ModelImportMode::Binary);
+        const tinygltf::Model &model = *gltf_model;
+
+        using utils::ArenaVector;
+        utils::LinearArena arena{};
 
-        auto extract_data_from_primitive = [&](const tinygltf::Primitive &primitive,
-                                               std::vector<glm::vec3> &positions,
-                                               std::vector<glm::vec3> &normals,
-                                               std::vector<glm::vec2> &texcoords)
+        const tinygltf::Mesh &mesh = model.meshes.at(0);
+        ArenaVector<MapVertex> vertices(arena);
+        ArenaVector<glm::vec3> positions(arena);
+        ArenaVector<glm::vec3> normals(arena);
+        ArenaVector<glm::vec2> texcoords(arena);
+        ArenaVector<uint32_t> indices(arena);
+        for (const auto &primitive : mesh.primitives)
         {
             if (primitive.attributes.find("POSITION") == primitive.attributes.end())
             {
@@ -843,71 +802,54 @@ namespace gage::scene::systems
                 throw SceneException{"Model vertex attribute must have POSITION attributes"};
             }
 
-            const auto &position_accessor = model.accessors.at(primitive.attributes.at("POSITION"));
-            std::vector<unsigned char> position_buffer = extract_buffer_from_accessor(position_accessor);
+            // Primitives are merged into one draw, their indices are rebased on the vertices before them
+            uint32_t base_vertex = positions.size();
+            data::AccessorView position_view(model, model.accessors.at(primitive.attributes.at("POSITION")));
+            uint32_t vertex_count = position_view.size();
 
-            for (uint32_t i = 0; i < position_accessor.count; i++)
+            if (primitive.indices < 0)
             {
-                glm::vec3 position{};
-                std::memcpy(&position.x, position_buffer.data() + i * sizeof(glm::vec3), sizeof(glm::vec3));
-                positions.push_back(position);
+                // Not indexed, every vertex is used once in order
+                uint32_t first_index = indices.size();
+                indices.resize(first_index + vertex_count);
+                std::iota(indices.begin() + first_index, indices.end(), base_vertex);
             }
-
-            if (primitive.attributes.find("NORMAL") != primitive.attributes.end())
+            else
             {
-                const auto &accessor = model.accessors.at(primitive.attributes.at("NORMAL"));
-                auto buffer = extract_buffer_from_accessor(accessor);
-                for (uint32_t i = 0; i < accessor.count; i++)
+                if ((size_t)primitive.indices >= model.accessors.size())
                 {
-                    glm::vec3 normal = *(glm::vec3 *)&buffer.at(i * sizeof(normal));
-                    normals.push_back(normal);
+                    log().critical("Model primitive index accessor {} is out of range", primitive.indices);
+                    throw SceneException{"Model primitive index accessor is out of range"};
+                }
+                data::AccessorView index_view(model, model.accessors[primitive.indices]);
+                indices.resize(indices.size() + index_view.size());
+                std::span<uint32_t> primitive_indices(indices.end() - index_view.size(), indices.end());
+                index_view.read(primitive_indices);
+                for (uint32_t &index : primitive_indices)
+                {
+                    index += base_vertex;
                 }
-            }
-            else
-            {
-                // Fill it with zeroes
-                auto vertex_count = position_accessor.count;
-                normals.resize(vertex_count);
-                std::memset(normals.data(), 0, vertex_count * sizeof(glm::vec3));
             }
 
-            if (primitive.attributes.find("TEXCOORD_0") != primitive.attributes.end())
+            // Missing attributes are left zeroed
+            auto read_attribute = [&](const char *name, auto &stream)
             {
-                const auto &accessor = model.accessors.at(primitive.attributes.at("TEXCOORD_0"));
-                auto buffer = extract_buffer_from_accessor(accessor);
+                stream.resize(base_vertex + vertex_count);
+                auto it = primitive.attributes.find(name);
+                if (it == primitive.attributes.end())
+                    return;
 
-                for (uint32_t i = 0; i < accessor.count; i++)
+                data::AccessorView view(model, model.accessors.at(it->second));
+                if (view.size() != vertex_count)
                 {
-                    if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
-                    {
-                        glm::vec2 tex_coord = *(glm::vec2 *)&buffer.at(i * sizeof(tex_coord));
-                        texcoords.push_back(tex_coord);
-                    }
-                    else
-                    {
-                        log().info("TEXCOORD_0: TODO !");
-                        throw SceneException{};
-                    }
+                    log().critical("Model vertex attribute {} does not match the vertex count", name);
+                    throw SceneException{"Model vertex attribute does not match the vertex count"};
                 }
-            }
-            else
-            {
-                // Fill with zeroes
-                auto vertex_count = position_accessor.count;
-                texcoords.resize(vertex_count);
-                std::memset(texcoords.data(), 0, vertex_count * sizeof(glm::vec<2, float>));
-            }
-        };
-
-        std::vector<MapVertex> vertices;
-        std::vector<glm::vec3> positions{};
-        std::vector<glm::vec3> normals{};
-        std::vector<glm::vec2> texcoords{};
-        std::vector<uint32_t> indices{};
-        for (const auto &primitive : mesh.primitives)
-        {
-            extract_indices_from_primitive(primitive, indices);
-            extract_data_from_primitive(primitive, positions, normals, texcoords);
+                view.read(std::span(stream.begin() + base_vertex, stream.end()));
+            };
+            read_attribute("POSITION", positions);
+            read_attribute("NORMAL", normals);
+            read_attribute("TEXCOORD_0", texcoords);
         }
         vertices.reserve(positions.size());
 
@@ -916,13 +858,40 @@ namespace gage::scene::systems
             vertices.push_back({positions.at(i), normals.at(i), texcoords.at(i)});
         }
 
-        StaticModelData data(
+        if (indices.size() % 3 != 0)
+        {
+            log().critical("Model primitives must be triangle lists");
+            throw SceneException{"Model primitives must be triangle lists"};
+        }
+        for (uint32_t index : indices)
+        {
+            if (index >= vertices.size())
+            {
+                log().critical("Model primitive index {} is out of range of {} vertices", index, vertices.size());
+                throw SceneException{"Model primitive index is out of range"};
+            }
+        }
+        data::VertexStream stream{reinterpret_cast<unsigned char *>(vertices.data()), sizeof(MapVertex)};
+        data::MeshOptimizeResult result = data::optimize_mesh(std::span(indices.data(), indices.size()), std::span(&stream, 1), 0, vertices.size());
+        log().trace("Optimized static model: {} -> {} vertices, ACMR {:.3f} -> {:.3f}", result.input_vertex_count, result.vertex_count, result.input_acmr, result.acmr);
+        vertices.resize(result.vertex_count);
+
+        if (data::fits_16_bit_indices(result.vertex_count))
+        {
+            std::vector<uint16_t> short_indices = data::narrow_indices(std::span(indices.data(), indices.size()));
+            return std::make_shared<StaticModelData>(
+                gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(MapVertex) * vertices.size(), vertices.data()),
+                gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, sizeof(uint16_t) * short_indices.size(), short_indices.data()),
+                short_indices.size(),
+                VK_INDEX_TYPE_UINT16
+            );
+        }
+        return std::make_shared<StaticModelData>(
             gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(MapVertex) * vertices.size(), vertices.data()),
             gfx::data::GPUBuffer(gfx, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, sizeof(uint32_t) * indices.size(), indices.data()),
-            indices.size()
+            indices.size(),
+            VK_INDEX_TYPE_UINT32
         );
-
-        model_path_to_model_map.insert({model_path, std::move(data)});
     }
 
 }
\ No newline at end of file
@@ -12,21 +12,33 @@
 
 #include <Core/src/gfx/data/GPUBuffer.hpp>
 #include <Core/src/gfx/data/Image.hpp>
+#include <Core/src/utils/PagedPool.hpp>
 
 namespace gage::gfx
 {
     class Graphics;
 }
 
+namespace gage::scene
+{
+    class AssetCache;
+    class Texture;
+}
+
 namespace gage::scene::systems
 {
     class MapRenderer
     {
     public:
+        // Normal is stored octahedral in snorm16, uv stays float since walls tile it in world units
         struct MapVertex
         {
-            glm::vec3 position, normal;
-            glm::vec2 uv;
+            MapVertex() = default;
+            MapVertex(const glm::vec3& position, const glm::vec3& normal, const glm::vec2& uv);
+
+            glm::vec3 position{};
+            glm::vec2 uv{};
+            glm::vec<2, int16_t> normal{};
         };
 
         class GeometryData
@@ -40,8 +52,7 @@ namespace gage::scene::systems
             GeometryData& operator=(GeometryData&&) = default;
             GeometryData(GeometryData&&) = default;
         public:
-            std::unique_ptr<gfx::data::Image> image{};
-            uint32_t image_width{}, image_height{};
+            std::shared_ptr<const Texture> texture{}; // Shared through the asset cache
             VkDescriptorSet image_descriptor_set{};
             
             std::vector<MapVertex> vertices{};
@@ -52,10 +63,11 @@ namespace gage::scene::systems
         class StaticModelData
         {
         public:
-            StaticModelData(gfx::data::GPUBuffer vertex_buffer, gfx::data::GPUBuffer index_buffer, uint32_t vertex_count) :
+            StaticModelData(gfx::data::GPUBuffer vertex_buffer, gfx::data::GPUBuffer index_buffer, uint32_t vertex_count, VkIndexType index_type) :
                 vertex_buffer(std::move(vertex_buffer)),
                 index_buffer(std::move(index_buffer)),
-                vertex_count(vertex_count)
+                vertex_count(vertex_count),
+                index_type(index_type)
             {}
             ~StaticModelData() = default;
 
@@ -67,18 +79,17 @@ namespace gage::scene::systems
             gfx::data::GPUBuffer vertex_buffer;
             gfx::data::GPUBuffer index_buffer;
             uint32_t vertex_count;  
+            VkIndexType index_type;
         };
 
 
     public:
-        MapRenderer(const gfx::Graphics &gfx);
+        MapRenderer(const gfx::Graphics &gfx, AssetCache& assets);
         ~MapRenderer();
 
         void init();
         void shutdown();
 
-        void add_map(std::shared_ptr<components::Map> map);
-
         void render(VkCommandBuffer cmd) const;
         void render_depth(VkCommandBuffer cmd) const;
 
@@ -86,10 +97,13 @@ namespace gage::scene::systems
         void create_pipeline();
         void create_depth_pipeline();
         void process_aabb_wall(const components::AABBWall& aabb_wall);
-        void create_new_static_model(const std::string& model_path);
+        // Built once per file through the asset cache
+        std::shared_ptr<const StaticModelData> create_new_static_model(const std::string& model_path);
+        std::shared_ptr<const Texture> create_error_texture();
 
     private:
         const gfx::Graphics &gfx;
+        AssetCache &assets;
 
     public:
         static constexpr uint8_t STENCIL_VALUE = 0x03;
@@ -102,8 +116,8 @@ namespace gage::scene::systems
         VkPipelineLayout depth_pipeline_layout{};
         VkPipeline depth_pipeline{};
 
-        std::vector<std::shared_ptr<components::Map>> maps;
+        utils::PagedPool<components::Map> maps;
         std::unordered_map<std::string, GeometryData> image_path_to_geometry_data_map{};
-        std::unordered_map<std::string, StaticModelData> model_path_to_model_map{};
+        std::unordered_map<std::string, std::shared_ptr<const StaticModelData>> model_path_to_model_map{};
     };
 }
\ No newline at end of file
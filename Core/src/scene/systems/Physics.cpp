@@ -4,6 +4,12 @@
 #include "../scene.hpp"
 #include "../Node.hpp"
 #include "../data/Model.hpp"
+#include "../data/AccessorView.hpp"
+#include "../AssetCache.hpp"
+
+#include <Core/src/utils/JobSystem.hpp>
+#include <Core/src/utils/LinearArena.hpp>
+#include <Core/src/mem.hpp>
 
 static void TraceImpl(const char *inFMT, ...)
 {
@@ -36,15 +42,132 @@ namespace gage::scene::systems
         delete JPH::Factory::sInstance;
         JPH::Factory::sInstance = nullptr;
     }
-    Physics::Physics() : jolt_initer(),
+    JoltJobSystem::JoltJobSystem(utils::JobSystem &job_system, uint32_t max_jobs, uint32_t max_barriers, uint32_t thread_budget) : JPH::JobSystemWithBarrier(max_barriers),
+                                                                                                                                  job_system(job_system),
+                                                                                                                                  queued_jobs(max_jobs)
+    {
+        jobs.Init(max_jobs, max_jobs);
+        set_thread_budget(thread_budget);
+        runner_group = job_system.create_group();
+    }
+
+    JoltJobSystem::~JoltJobSystem()
+    {
+        job_system.run(runner_group);
+        job_system.wait(runner_group);
+    }
+
+    int JoltJobSystem::GetMaxConcurrency() const
+    {
+        return thread_budget;
+    }
+
+    JoltJobSystem::JobHandle JoltJobSystem::CreateJob(const char *inName, JPH::ColorArg inColor, const JobFunction &inJobFunction, JPH::uint32 inNumDependencies)
+    {
+        uint32_t index;
+        for (;;)
+        {
+            index = jobs.ConstructObject(inName, inColor, this, inJobFunction, inNumDependencies);
+            if (index != JPH::FixedSizeFreeList<Job>::cInvalidObjectIndex)
+                break;
+
+            // Out of jobs, wait for some to finish
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        Job *job = &jobs.Get(index);
+
+        // Construct the handle before queueing, the job could finish and get freed right away otherwise
+        JobHandle handle(job);
+        if (inNumDependencies == 0)
+        {
+            QueueJob(job);
+        }
+        return handle;
+    }
+
+    void JoltJobSystem::set_thread_budget(uint32_t thread_budget)
+    {
+        // Runners above a lowered budget finish what is queued, no new ones start until they are below it
+        uint32_t worker_count = job_system.get_worker_count();
+        this->thread_budget = thread_budget == 0 ? worker_count : std::min(thread_budget, worker_count);
+    }
+
+    uint32_t JoltJobSystem::get_thread_budget() const
+    {
+        return thread_budget;
+    }
+
+    void JoltJobSystem::QueueJob(Job *inJob)
+    {
+        QueueJobs(&inJob, 1);
+    }
+
+    void JoltJobSystem::QueueJobs(Job **inJobs, JPH::uint inNumJobs)
+    {
+        uint32_t new_runners = 0;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            for (JPH::uint i = 0; i < inNumJobs; i++)
+            {
+                // Keep the job alive until it has been executed by a runner
+                inJobs[i]->AddRef();
+                assert(queue_count < queued_jobs.size());
+                queued_jobs[(queue_head + queue_count++) % queued_jobs.size()] = inJobs[i];
+            }
+            uint32_t budget = thread_budget.load();
+            while (active_runners < budget && new_runners < inNumJobs)
+            {
+                active_runners++;
+                new_runners++;
+            }
+        }
+
+        for (uint32_t i = 0; i < new_runners; i++)
+        {
+            job_system.run(job_system.create_child_job(runner_group, [this]()
+                                                       { run_queued_jobs(); }));
+        }
+    }
+
+    void JoltJobSystem::run_queued_jobs()
+    {
+        for (;;)
+        {
+            Job *job{};
+            {
+                // The runner count only drops with the queue empty and the lock held, a job queued meanwhile starts a new runner
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                if (queue_count == 0)
+                {
+                    active_runners--;
+                    return;
+                }
+                job = queued_jobs[queue_head];
+                queue_head = (queue_head + 1) % queued_jobs.size();
+                queue_count--;
+            }
+            job->Execute();
+            job->Release();
+        }
+    }
+
+    void JoltJobSystem::FreeJob(Job *inJob)
+    {
+        jobs.DestroyObject(inJob);
+    }
+
+    Physics::Physics(AssetCache &assets, utils::JobSystem &job_system, uint32_t thread_budget) : assets(assets),
+                         jolt_initer(),
                          physics_system(),
                          temp_allocator(10 * 1024 * 1024),
-                         job_system(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, 1),
+                         job_system(job_system, JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, thread_budget),
                          broad_phase_layer_interface(),
                          object_vs_broadphase_layer_filter(),
                          object_vs_object_layer_filter(),
                          body_interface(physics_system.GetBodyInterface())
     {
+        MemoryTagScope memory_tag(MemoryTag::PHYSICS);
+
         // This is the max amount of rigid bodies that you can add to the physics system. If you try to add more you'll get an error.
         // Note: This value is low because this is a simple test. For a real project use something in the order of 65536.
         const uint cMaxBodies = 1024;
@@ -75,27 +198,10 @@ namespace gage::scene::systems
 
     void Physics::init()
     {
+        MemoryTagScope memory_tag(MemoryTag::PHYSICS);
         for (auto &character_controller : character_controllers)
         {
-            // Create 'player' character
-            JPH::CharacterSettings settings;
-            settings.mMaxSlopeAngle = JPH::DegreesToRadians(80.0f);
-            settings.mLayer = Layers::MOVING;
-            settings.mShape = JPH::RotatedTranslatedShapeSettings(JPH::Vec3(0, 0.0f, 0.0), JPH::Quat(0, 0, 0, 1),
-                                                                  JPH::CapsuleShapeSettings(0.6f, 0.6f).Create().Get())
-                                  .Create()
-                                  .Get();
-            settings.mFriction = 0.2f;
-
-            // settings->mShape = JPH::CapsuleShapeSettings(1.8f, 0.3f).Create().Get();
-            std::unique_ptr<JPH::Character> character = std::make_unique<JPH::Character>(
-                &settings,
-                JPH::Vec3Arg(character_controller->node.position.x, character_controller->node.position.y, character_controller->node.position.z),
-                JPH::QuatArg(character_controller->node.rotation.x, character_controller->node.rotation.y, character_controller->node.rotation.z, character_controller->node.rotation.w),
-                0, &physics_system);
-            character->AddToPhysicsSystem(JPH::EActivation::Activate);
-
-            character_controller->character = std::move(character);
+            init_character_controller(character_controller);
         }
 
         for (auto &terrain_renderer : terrain_renderers)
@@ -116,56 +222,19 @@ namespace gage::scene::systems
             JPH::StaticCompoundShapeSettings compound_shape_settings;
             for (const auto &aabb_wall : map.map->aabb_walls)
             {
-                auto offset = aabb_wall.a + map.map->node.position;
+                auto offset = aabb_wall.a + map.map->node.get_position();
                 compound_shape_settings.AddShape(JPH::Vec3(offset.x, offset.y, offset.z), JPH::Quat::sIdentity(),
                                                  new JPH::BoxShape(JPH::Vec3(aabb_wall.b.x, aabb_wall.b.y, aabb_wall.b.z)));
             }
 
-            // Static models
+            // Static models, the hull of a file is cooked once and shared by every placement
             for (const auto &static_model : map.map->static_models)
             {
-                tinygltf::Model model;
-                tinygltf::TinyGLTF loader;
-                std::string err;
-                std::string warn;
-                if (!loader.LoadBinaryFromFile(&model, &err, &warn, static_model.model_path))
-                {
-                    log().critical("Physics failed to import scene: {} | {} | {}", static_model.model_path, warn, err);
-                    throw SceneException{};
-                }
-
-                const tinygltf::Mesh &mesh = model.meshes.at(0);
-                auto extract_buffer_from_accessor = [&](const tinygltf::Accessor &accessor)
-                    -> std::vector<unsigned char>
-                {
-                    const auto &buffer_view = model.bufferViews.at(accessor.bufferView);
-                    const auto &buffer = model.buffers.at(buffer_view.buffer);
-
-                    std::vector<unsigned char> result(buffer_view.byteLength);
-                    std::memcpy(result.data(), buffer.data.data() + buffer_view.byteOffset, buffer_view.byteLength);
+                std::shared_ptr<const ConvexHull> hull = assets.get_derived<ConvexHull>(static_model.model_path, "convex_hull", [this, &static_model]()
+                                                                                       { return create_convex_hull(static_model.model_path); });
 
-                    return result;
-                };
-
-                std::vector<JPH::Vec3> positions;
-                for (const auto &primitive : mesh.primitives)
-                {
-                    const auto &position_accessor = model.accessors.at(primitive.attributes.at("POSITION"));
-                    std::vector<unsigned char> position_buffer = extract_buffer_from_accessor(position_accessor);
-
-                    for (uint32_t i = 0; i < position_accessor.count; i++)
-                    {
-                        glm::vec3 position{};
-                        std::memcpy(&position.x, position_buffer.data() + i * sizeof(glm::vec3), sizeof(glm::vec3));
-                        positions.push_back(JPH::Vec3(position.x, position.y, position.z));
-                    }
-                }
-
-                JPH::ConvexHullShapeSettings shape_setting(positions.data(), positions.size());
-
-                glm::vec3 offset = static_model.offset + map.map->node.position;
-                compound_shape_settings.AddShape(JPH::Vec3(offset.x, offset.y, offset.z), JPH::Quat::sIdentity(),
-                                                 shape_setting.Create().Get());
+                glm::vec3 offset = static_model.offset + map.map->node.get_position();
+                compound_shape_settings.AddShape(JPH::Vec3(offset.x, offset.y, offset.z), JPH::Quat::sIdentity(), hull->shape);
             }
 
             JPH::BodyCreationSettings setting(compound_shape_settings.Create().Get(),
@@ -176,14 +245,92 @@ namespace gage::scene::systems
 
         for (auto &rigid_body : rigid_bodies)
         {
-            JPH::BodyCreationSettings setting(rigid_body->shape->generate_shape().Get(),
-                                              JPH::RVec3(rigid_body->node.position.x, rigid_body->node.position.y, rigid_body->node.position.z),
-                                              JPH::Quat(rigid_body->node.rotation.x, rigid_body->node.rotation.y, rigid_body->node.rotation.z, rigid_body->node.rotation.w),
-                                              JPH::EMotionType::Dynamic, Layers::MOVING);
-
-            setting.mMassPropertiesOverride.mMass = 0.01;
-            setting.mRestitution = 0.1;
-            rigid_body->body = body_interface.CreateAndAddBody(setting, JPH::EActivation::Activate);
+            init_rigid_body(rigid_body);
+        }
+    }
+
+    std::shared_ptr<const Physics::ConvexHull> Physics::create_convex_hull(const std::string &model_path)
+    {
+        MemoryTagScope memory_tag(MemoryTag::PHYSICS);
+        std::shared_ptr<const tinygltf::Model> gltf_model = assets.get_gltf(model_path, data::ModelImportMode::Binary);
+        const tinygltf::Model &model = *gltf_model;
+
+        utils::LinearArena arena{};
+        const tinygltf::Mesh &mesh = model.meshes.at(0);
+        utils::ArenaVector<JPH::Vec3> positions(arena);
+        for (const auto &primitive : mesh.primitives)
+        {
+            data::AccessorView position_view(model, model.accessors.at(primitive.attributes.at("POSITION")));
+            positions.reserve(positions.size() + position_view.size());
+            for (glm::vec3 position : position_view.as<glm::vec3>())
+            {
+                positions.push_back(JPH::Vec3(position.x, position.y, position.z));
+            }
+        }
+
+        JPH::ConvexHullShapeSettings shape_setting(positions.data(), positions.size());
+        JPH::ShapeSettings::ShapeResult result = shape_setting.Create();
+        if (result.HasError())
+        {
+            log().critical("Physics failed to cook convex hull: {} | {}", model_path, result.GetError().c_str());
+            throw SceneException{};
+        }
+        return std::make_shared<ConvexHull>(ConvexHull{result.Get()});
+    }
+
+    void Physics::init_character_controller(components::CharacterController &character_controller)
+    {
+        MemoryTagScope memory_tag(MemoryTag::PHYSICS);
+        // Create 'player' character
+        JPH::CharacterSettings settings;
+        settings.mMaxSlopeAngle = JPH::DegreesToRadians(80.0f);
+        settings.mLayer = Layers::MOVING;
+        settings.mShape = JPH::RotatedTranslatedShapeSettings(JPH::Vec3(0, 0.0f, 0.0), JPH::Quat(0, 0, 0, 1),
+                                                              JPH::CapsuleShapeSettings(0.6f, 0.6f).Create().Get())
+                              .Create()
+                              .Get();
+        settings.mFriction = 0.2f;
+
+        // settings->mShape = JPH::CapsuleShapeSettings(1.8f, 0.3f).Create().Get();
+        std::unique_ptr<JPH::Character> character = std::make_unique<JPH::Character>(
+            &settings,
+            JPH::Vec3Arg(character_controller.node.get_position().x, character_controller.node.get_position().y, character_controller.node.get_position().z),
+            JPH::QuatArg(character_controller.node.get_rotation().x, character_controller.node.get_rotation().y, character_controller.node.get_rotation().z, character_controller.node.get_rotation().w),
+            0, &physics_system);
+        character->AddToPhysicsSystem(JPH::EActivation::Activate);
+
+        character_controller.character = std::move(character);
+    }
+
+    void Physics::init_rigid_body(components::RigidBody &rigid_body)
+    {
+        MemoryTagScope memory_tag(MemoryTag::PHYSICS);
+        JPH::BodyCreationSettings setting(rigid_body.shape->generate_shape().Get(),
+                                          JPH::RVec3(rigid_body.node.get_position().x, rigid_body.node.get_position().y, rigid_body.node.get_position().z),
+                                          JPH::Quat(rigid_body.node.get_rotation().x, rigid_body.node.get_rotation().y, rigid_body.node.get_rotation().z, rigid_body.node.get_rotation().w),
+                                          JPH::EMotionType::Dynamic, Layers::MOVING);
+
+        setting.mMassPropertiesOverride.mMass = 0.01;
+        setting.mRestitution = 0.1;
+        rigid_body.body = body_interface.CreateAndAddBody(setting, JPH::EActivation::Activate);
+    }
+
+    void Physics::remove_character_controller(components::CharacterController &character_controller)
+    {
+        if (character_controller.character)
+        {
+            character_controller.character->RemoveFromPhysicsSystem();
+            character_controller.character.reset();
+        }
+    }
+
+    void Physics::remove_rigid_body(components::RigidBody &rigid_body)
+    {
+        if (!rigid_body.body.IsInvalid())
+        {
+            body_interface.RemoveBody(rigid_body.body);
+            body_interface.DestroyBody(rigid_body.body);
+            rigid_body.body = JPH::BodyID{};
         }
     }
 
@@ -205,28 +352,36 @@ namespace gage::scene::systems
 
     void Physics::update(float delta)
     {
+        step(delta);
+        sync_transforms();
+    }
+
+    void Physics::step(float delta)
+    {
+        MemoryTagScope memory_tag(MemoryTag::PHYSICS);
         const int cCollisionSteps = 1;
         physics_system.Update(delta, cCollisionSteps, &temp_allocator, &job_system);
+    }
 
+    void Physics::sync_transforms()
+    {
+        MemoryTagScope memory_tag(MemoryTag::PHYSICS);
         for (auto &rigid_body : rigid_bodies)
         {
             // Extract body id
-            JPH::Vec3 position = body_interface.GetCenterOfMassPosition(rigid_body->body);
-            JPH::Quat rotation = body_interface.GetRotation(rigid_body->body);
-            rigid_body->node.position = glm::vec3{position.GetX(), position.GetY(), position.GetZ()};
-            rigid_body->node.rotation.x = rotation.GetX();
-            rigid_body->node.rotation.y = rotation.GetY();
-            rigid_body->node.rotation.z = rotation.GetZ();
-            rigid_body->node.rotation.w = rotation.GetW();
+            JPH::Vec3 position = body_interface.GetCenterOfMassPosition(rigid_body.body);
+            JPH::Quat rotation = body_interface.GetRotation(rigid_body.body);
+            rigid_body.node.set_position(glm::vec3{position.GetX(), position.GetY(), position.GetZ()});
+            rigid_body.node.set_rotation(glm::quat{rotation.GetW(), rotation.GetX(), rotation.GetY(), rotation.GetZ()});
         }
         for (auto &character_controller : character_controllers)
         {
-            character_controller->character->PostSimulation(0.1f);
-            auto position = character_controller->character->GetPosition(false);
-            character_controller->node.position = {position.GetX(), position.GetY(), position.GetZ()};
+            character_controller.character->PostSimulation(0.1f);
+            auto position = character_controller.character->GetPosition(false);
+            character_controller.node.set_position({position.GetX(), position.GetY(), position.GetZ()});
 
-            JPH::CharacterBase::EGroundState state = character_controller->character->GetGroundState();
-            JPH::BodyLockWrite lock(physics_system.GetBodyLockInterface(), character_controller->character->GetBodyID());
+            JPH::CharacterBase::EGroundState state = character_controller.character->GetGroundState();
+            JPH::BodyLockWrite lock(physics_system.GetBodyLockInterface(), character_controller.character->GetBodyID());
             if (lock.Succeeded())
             {
                 JPH::Body &body = lock.GetBody();
@@ -251,12 +406,17 @@ namespace gage::scene::systems
         }
     }
 
-    void Physics::add_character_controller(std::unique_ptr<components::CharacterController> character_controller)
+    void Physics::set_thread_budget(uint32_t thread_budget)
     {
-        character_controllers.push_back(std::move(character_controller));
+        job_system.set_thread_budget(thread_budget);
     }
 
-    void Physics::add_terrain_renderer(std::shared_ptr<components::Terrain> terrain_renderer)
+    uint32_t Physics::get_thread_budget() const
+    {
+        return job_system.get_thread_budget();
+    }
+
+    void Physics::add_terrain_renderer(components::Terrain *terrain_renderer)
     {
         Terrain terrain_renderer_additional_datas{};
         terrain_renderer_additional_datas.terrain_renderer = terrain_renderer;
@@ -264,11 +424,6 @@ namespace gage::scene::systems
         terrain_renderers.push_back(std::move(terrain_renderer_additional_datas));
     }
 
-    void Physics::add_rigid_body(std::unique_ptr<components::RigidBody> rigid_body)
-    {
-        rigid_bodies.push_back(std::move(rigid_body));
-    }
-
     void Physics::character_add_impulse(components::CharacterController *character, const glm::vec3 &vel)
     {
         character->character->AddImpulse(JPH::Vec3(vel.x, vel.y, vel.z));
@@ -304,7 +459,7 @@ namespace gage::scene::systems
         return GroundState::GROUND;
     }
 
-    void Physics::add_map(std::shared_ptr<components::Map> map)
+    void Physics::add_map(components::Map *map)
     {
         Map additional_data{};
         additional_data.map = map;
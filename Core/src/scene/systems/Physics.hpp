@@ -4,14 +4,20 @@
 #include "../components/Terrain.hpp"
 #include "../components/Map.hpp"
 #include "../components/RigidBody.hpp"
+#include <Core/src/utils/PagedPool.hpp>
+#include <Core/src/utils/JobSystem.hpp>
+
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
 
 #include <glm/vec3.hpp>
 
 #include <Jolt/Jolt.h>
 #include <Jolt/Core/TempAllocator.h>
-#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
 #include <Jolt/Physics/PhysicsSystem.h>
 #include <Jolt/Physics/Collision/BroadPhase/BroadPhaseLayer.h>
 
@@ -19,9 +25,11 @@
 namespace gage::scene
 {
     class SceneGraph;
+    class AssetCache;
 }
 
 
+
 namespace gage::scene::systems
 {
     namespace Layers 
@@ -105,6 +113,39 @@ namespace gage::scene::systems
         ~JoltIniter();
     };
 
+    // Runs jolt jobs on the engine's worker pool instead of a private thread pool.
+    // Queued jobs wait in a queue of their own, drained by at most thread_budget engine jobs at a time
+    class JoltJobSystem final : public JPH::JobSystemWithBarrier
+    {
+    public:
+        JoltJobSystem(utils::JobSystem& job_system, uint32_t max_jobs, uint32_t max_barriers, uint32_t thread_budget);
+        ~JoltJobSystem() override;
+
+        int GetMaxConcurrency() const override;
+        JobHandle CreateJob(const char *inName, JPH::ColorArg inColor, const JobFunction &inJobFunction, JPH::uint32 inNumDependencies = 0) override;
+
+        void set_thread_budget(uint32_t thread_budget);
+        uint32_t get_thread_budget() const;
+    protected:
+        void QueueJob(Job *inJob) override;
+        void QueueJobs(Job **inJobs, JPH::uint inNumJobs) override;
+        void FreeJob(Job *inJob) override;
+    private:
+        // Executes queued jobs until the queue is empty, one engine job per runner
+        void run_queued_jobs();
+    private:
+        utils::JobSystem& job_system;
+        JPH::FixedSizeFreeList<Job> jobs;
+        std::atomic<uint32_t> thread_budget{};
+        utils::JobSystem::Job* runner_group{}; // Parent of every runner, waited on before the queue goes away
+
+        std::mutex queue_mutex{};
+        std::vector<Job*> queued_jobs{}; // Ring of max_jobs, a job is queued at most once
+        uint32_t queue_head{};
+        uint32_t queue_count{};
+        uint32_t active_runners{}; // Engine jobs running run_queued_jobs(), at most thread_budget
+    };
+
     class Physics
     {
         friend class scene::SceneGraph;
@@ -112,13 +153,19 @@ namespace gage::scene::systems
         struct Terrain
         {
             JPH::BodyID height_map_body{};
-            std::shared_ptr<components::Terrain> terrain_renderer;
+            components::Terrain* terrain_renderer{}; // Owned by TerrainRenderer
         };
 
         struct Map
         {
             JPH::BodyID body{};
-            std::shared_ptr<components::Map> map;
+            components::Map* map{}; // Owned by MapRenderer
+        };
+
+        // Cooked from the positions of a static model, shared through the asset cache
+        struct ConvexHull
+        {
+            JPH::ShapeRefC shape{};
         };
     public:
         enum class GroundState
@@ -127,39 +174,53 @@ namespace gage::scene::systems
             AIR
         };
     public:
-        Physics();
+        // thread_budget of 0 lets the simulation use every engine worker
+        Physics(AssetCache& assets, utils::JobSystem& job_system, uint32_t thread_budget = 0);
         ~Physics() = default;
         
         void init();
         void update(float);
         void shutdown();
 
-        void add_character_controller(std::unique_ptr<components::CharacterController> character_controller);
+        // update() split in two so the simulation step can run next to other systems
+        void step(float delta);
+        void sync_transforms();
+
+        void set_thread_budget(uint32_t thread_budget);
+        uint32_t get_thread_budget() const;
+
         static void character_add_impulse(components::CharacterController* character, const glm::vec3& vel);
         static void character_set_velocity(components::CharacterController* character, const glm::vec3& vel);
         static glm::vec3 character_get_velocity(components::CharacterController* character);
         static GroundState character_get_ground_state(components::CharacterController* character);
         void character_set_gravity_factor(components::CharacterController* character, const float gravity_factor) const;
 
-        void add_terrain_renderer(std::shared_ptr<components::Terrain> terrain_renderer);
-        void add_rigid_body(std::unique_ptr<components::RigidBody> rigid_body);
-        void add_map(std::shared_ptr<components::Map> map);
+        void add_terrain_renderer(components::Terrain* terrain_renderer);
+        void add_map(components::Map* map);
+
+        // Create or remove the body of a component added or removed after init()
+        void init_character_controller(components::CharacterController& character_controller);
+        void init_rigid_body(components::RigidBody& rigid_body);
+        void remove_character_controller(components::CharacterController& character_controller);
+        void remove_rigid_body(components::RigidBody& rigid_body);
     private:
         void extract_bounding_box(const std::string& file_path);
+        std::shared_ptr<const ConvexHull> create_convex_hull(const std::string& model_path);
     private:
+        AssetCache& assets;
         JoltIniter jolt_initer;
     public:
         JPH::PhysicsSystem physics_system;
         JPH::TempAllocatorImpl temp_allocator;
-        JPH::JobSystemThreadPool job_system;
+        JoltJobSystem job_system;
         BPLayerInterface broad_phase_layer_interface;
         ObjectVsBroadPhaseLayerFilter object_vs_broadphase_layer_filter;
         ObjectLayerPairFilter object_vs_object_layer_filter;
         JPH::BodyInterface& body_interface;
 
-        std::vector<std::unique_ptr<components::CharacterController>> character_controllers; 
+        utils::PagedPool<components::CharacterController> character_controllers;
         std::vector<Terrain> terrain_renderers;
         std::vector<Map> maps;
-        std::vector<std::unique_ptr<components::RigidBody>> rigid_bodies;
+        utils::PagedPool<components::RigidBody> rigid_bodies;
     };
 }
\ No newline at end of file
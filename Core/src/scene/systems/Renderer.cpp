@@ -7,11 +7,24 @@
 #include <Core/src/gfx/data/Camera.hpp>
 #include <Core/src/gfx/data/g_buffer/GBuffer.hpp>
 #include <Core/src/utils/FileLoader.hpp>
-#include <glm/gtc/type_ptr.hpp>
 
 namespace gage::scene::systems
 {
-    Renderer::Renderer(const gfx::Graphics &gfx) : gfx(gfx)
+    // One binding per attribute of layout, at consecutive locations
+    static void get_vertex_input(data::VertexLayout layout, std::span<const data::VertexAttribute> attributes,
+        std::vector<VkVertexInputBindingDescription> &bindings, std::vector<VkVertexInputAttributeDescription> &descriptions)
+    {
+        const auto &formats = data::get_vertex_attribute_formats(layout);
+        bindings.clear();
+        descriptions.clear();
+        for (uint32_t i = 0; i < attributes.size(); i++)
+        {
+            bindings.push_back({.binding = i, .stride = formats[attributes[i]].stride, .inputRate = VK_VERTEX_INPUT_RATE_VERTEX});
+            descriptions.push_back({.location = i, .binding = i, .format = formats[attributes[i]].format, .offset = 0});
+        }
+    }
+
+    Renderer::Renderer(const gfx::Graphics &gfx, const gfx::data::Camera &camera) : gfx(gfx), camera(camera), mesh_arena(gfx)
     {
         create_pipeline();
         create_depth_pipeline();
@@ -20,31 +33,77 @@ namespace gage::scene::systems
     Renderer::~Renderer()
     {
         vkDestroyPipelineLayout(gfx.device.device, depth_pipeline_layout, nullptr);
-        vkDestroyPipeline(gfx.device.device, depth_pipeline, nullptr);
+        for (VkPipeline depth_pipeline : depth_pipelines)
+            vkDestroyPipeline(gfx.device.device, depth_pipeline, nullptr);
 
         vkDestroyDescriptorSetLayout(gfx.device.device, material_set_layout, nullptr);
         vkDestroyDescriptorSetLayout(gfx.device.device, animation_set_layout, nullptr);
         vkDestroyPipelineLayout(gfx.device.device, pipeline_layout, nullptr);
-        vkDestroyPipeline(gfx.device.device, pipeline, nullptr);
+        for (VkPipeline pipeline : pipelines)
+            vkDestroyPipeline(gfx.device.device, pipeline, nullptr);
     }
     void Renderer::init()
     {
-        for (auto &mesh : mesh_renderers)
+        for (uint32_t slot = 0; slot < mesh_renderer_datas.size(); slot++)
         {
-            for (uint32_t i = 0; i < gfx::Graphics::FRAMES_IN_FLIGHT; i++)
-            {
+            init_mesh_renderer(slot);
+        }
 
+    }
+
+    void Renderer::init_mesh_renderer(uint32_t slot)
+    {
+        auto &mesh = mesh_renderer_datas.at(slot);
+        for (uint32_t i = 0; i < gfx::Graphics::FRAMES_IN_FLIGHT; i++)
+        {
+            // Buffers of a removed mesh renderer are kept for whatever reuses the slot,
+            // frames in flight may still read them
+            if (!mesh.animation_buffers[i])
+            {
                 mesh.animation_buffers[i] = std::make_unique<gfx::data::CPUBuffer>(gfx, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(components::MeshRenderer::AnimationBuffer), nullptr);
                 mesh.animation_descs[i] = allocate_animation_set(sizeof(components::MeshRenderer::AnimationBuffer), mesh.animation_buffers[i]->get_buffer_handle());
-
-                components::MeshRenderer::AnimationBuffer *buffer_ptr = (components::MeshRenderer::AnimationBuffer *)(mesh.animation_buffers[i]->get_mapped());
-                buffer_ptr->enabled = false;
             }
-        }
 
+            components::MeshRenderer::AnimationBuffer *buffer_ptr = (components::MeshRenderer::AnimationBuffer *)(mesh.animation_buffers[i]->get_mapped());
+            buffer_ptr->enabled = false;
+        }
     }
 
     void Renderer::render_depth(VkCommandBuffer cmd) const
+    {
+        render_depth(cmd, 0, mesh_renderers.get_slot_count());
+    }
+
+    void Renderer::render(VkCommandBuffer cmd) const
+    {
+        render(cmd, 0, mesh_renderers.get_slot_count());
+    }
+
+    uint32_t Renderer::select_lod(const data::ModelMeshPrimitive &primitive, const glm::mat4x4 &transform) const
+    {
+        if (primitive.lods.size() <= 1)
+            return 0;
+
+        // Nearest point of the bounding sphere, the error of a level is in mesh units and scales with the node
+        glm::vec3 center = transform * glm::vec4(glm::vec3(primitive.bounding_sphere), 1.0f);
+        float scale = std::max({glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))});
+        float distance = std::max(glm::distance(center, camera.get_position()) - primitive.bounding_sphere.w * scale, camera.get_near());
+        float pixels_per_unit = gfx.get_scaled_draw_extent().height / (2.0f * std::tan(glm::radians(camera.get_field_of_view()) * 0.5f) * distance);
+
+        for (uint32_t lod = primitive.lods.size() - 1; lod > 0; lod--)
+        {
+            if (primitive.lods[lod].error * scale * pixels_per_unit <= LOD_ERROR_THRESHOLD)
+                return lod;
+        }
+        return 0;
+    }
+
+    uint32_t Renderer::get_mesh_renderer_count() const
+    {
+        return mesh_renderers.get_slot_count();
+    }
+
+    void Renderer::render_depth(VkCommandBuffer cmd, uint32_t first, uint32_t count) const
     {
         VkViewport viewport = {};
         viewport.x = 0;
@@ -60,41 +119,65 @@ namespace gage::scene::systems
         scissor.extent.width = gfx.directional_light_shadow_map_resolution;
         scissor.extent.height = gfx.directional_light_shadow_map_resolution;
 
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, depth_pipeline);
+        // Pipelines only differ in vertex input, they and the arena buffers are bound when the primitive's change
+        std::optional<data::VertexLayout> bound_layout{};
+        uint32_t bound_vertex_block{};
+        std::optional<std::pair<uint32_t, VkIndexType>> bound_index_buffer{};
         vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, depth_pipeline_layout, 0, 1, &gfx.frame_datas[gfx.frame_index].global_set, 0, nullptr);
         vkCmdSetViewport(cmd, 0, 1, &viewport);
         vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-        for (const auto &mesh : mesh_renderers)
+        for (uint32_t i = first; i < first + count; i++)
         {
+            if (!mesh_renderers.is_alive(i))
+                continue;
+
+            const auto &mesh = mesh_renderer_datas[i];
+            const components::MeshRenderer &mesh_renderer = mesh_renderers.at(i);
             // Update animation buffer
-            std::memcpy(mesh.animation_buffers[gfx.frame_index]->get_mapped(), &mesh.mesh_renderer->animation_buffer_data, sizeof(components::MeshRenderer::AnimationBuffer));
+            std::memcpy(mesh.animation_buffers[gfx.frame_index]->get_mapped(), &mesh_renderer.animation_buffer_data, sizeof(components::MeshRenderer::AnimationBuffer));
             vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
                                         depth_pipeline_layout,
                                         1,
                                         1, &mesh.animation_descs[gfx.frame_index], 0, nullptr);
-            for (const auto &primitive : mesh.mesh_renderer->model_mesh.primitives)
+            for (const auto &primitive : mesh_renderer.model_mesh.primitives)
             {
                 if (primitive.material_index < 0)
                     continue;
 
-                VkBuffer buffers[] =
-                    {
-                        primitive.position_buffer.get_buffer_handle(),
-                        primitive.bone_id_buffer.get_buffer_handle(),
-                        primitive.bone_weight_buffer.get_buffer_handle(),
-                    };
-                VkDeviceSize offsets[] =
-                    {0, 0, 0};
-
-                vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4x4), glm::value_ptr(mesh.mesh_renderer->node.global_transform));
-                vkCmdBindVertexBuffers(cmd, 0, sizeof(buffers) / sizeof(buffers[0]), buffers, offsets);
-                vkCmdBindIndexBuffer(cmd, primitive.index_buffer.get_buffer_handle(), 0, VK_INDEX_TYPE_UINT32);
-                vkCmdDrawIndexed(cmd, primitive.vertex_count, 1, 0, 0, 0);
+                const data::MeshAllocation &allocation = primitive.allocation;
+                if (bound_layout != primitive.vertex_layout || bound_vertex_block != allocation.get_vertex_block())
+                {
+                    if (bound_layout != primitive.vertex_layout)
+                        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, depth_pipelines[(uint32_t)primitive.vertex_layout]);
+
+                    std::span<const VkBuffer> streams = mesh_arena.get_vertex_buffers(primitive.vertex_layout, allocation.get_vertex_block());
+                    VkBuffer buffers[] =
+                        {
+                            streams[data::VERTEX_ATTRIBUTE_POSITION],
+                            streams[data::VERTEX_ATTRIBUTE_BONE_ID],
+                            streams[data::VERTEX_ATTRIBUTE_BONE_WEIGHT],
+                        };
+                    VkDeviceSize offsets[] =
+                        {0, 0, 0};
+                    vkCmdBindVertexBuffers(cmd, 0, sizeof(buffers) / sizeof(buffers[0]), buffers, offsets);
+                    bound_layout = primitive.vertex_layout;
+                    bound_vertex_block = allocation.get_vertex_block();
+                }
+                if (bound_index_buffer != std::pair{allocation.get_index_block(), primitive.index_type})
+                {
+                    vkCmdBindIndexBuffer(cmd, mesh_arena.get_index_buffer(allocation.get_index_block()), 0, primitive.index_type);
+                    bound_index_buffer = std::pair{allocation.get_index_block(), primitive.index_type};
+                }
+
+                PushConstants push_constants{.model_transform = mesh_renderer.node.get_global_transform(), .dequantization = primitive.dequantization};
+                vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push_constants);
+                const data::MeshLod &lod = primitive.lods.at(select_lod(primitive, mesh_renderer.node.get_global_transform()));
+                vkCmdDrawIndexed(cmd, lod.count, 1, allocation.get_first_index() + lod.start, allocation.get_base_vertex(), 0);
             }
         }
     }
-    void Renderer::render(VkCommandBuffer cmd) const
+    void Renderer::render(VkCommandBuffer cmd, uint32_t first, uint32_t count) const
     {
         VkViewport viewport = {};
         viewport.x = 0;
@@ -110,34 +193,47 @@ namespace gage::scene::systems
         scissor.extent.width = gfx.get_scaled_draw_extent().width;
         scissor.extent.height = gfx.get_scaled_draw_extent().height;
 
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        std::optional<data::VertexLayout> bound_layout{};
+        uint32_t bound_vertex_block{};
+        std::optional<std::pair<uint32_t, VkIndexType>> bound_index_buffer{};
         vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &gfx.frame_datas[gfx.frame_index].global_set, 0, nullptr);
         vkCmdSetViewport(cmd, 0, 1, &viewport);
         vkCmdSetScissor(cmd, 0, 1, &scissor);
-        for (const auto &mesh : mesh_renderers)
+        for (uint32_t i = first; i < first + count; i++)
         {
+            if (!mesh_renderers.is_alive(i))
+                continue;
+
+            const auto &mesh = mesh_renderer_datas[i];
+            const components::MeshRenderer &mesh_renderer = mesh_renderers.at(i);
             // Update animation buffer
-            std::memcpy(mesh.animation_buffers[gfx.frame_index]->get_mapped(), &mesh.mesh_renderer->animation_buffer_data, sizeof(components::MeshRenderer::AnimationBuffer));
-            for (const auto &primitive : mesh.mesh_renderer->model_mesh.primitives)
+            std::memcpy(mesh.animation_buffers[gfx.frame_index]->get_mapped(), &mesh_renderer.animation_buffer_data, sizeof(components::MeshRenderer::AnimationBuffer));
+            for (const auto &primitive : mesh_renderer.model_mesh.primitives)
             {
                 if (primitive.material_index < 0)
                     continue;
 
-                VkBuffer buffers[] =
-                    {
-                        primitive.position_buffer.get_buffer_handle(),
-                        primitive.normal_buffer.get_buffer_handle(),
-                        primitive.texcoord_buffer.get_buffer_handle(),
-                        primitive.bone_id_buffer.get_buffer_handle(),
-                        primitive.bone_weight_buffer.get_buffer_handle(),
-                    };
-                VkDeviceSize offsets[] =
-                    {0, 0, 0, 0, 0};
-
-                // Build transform
-
-                const VkDescriptorSet &material_set = mesh.mesh_renderer->model.materials.at(primitive.material_index).descriptor_set;
-                vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(glm::mat4x4), glm::value_ptr(mesh.mesh_renderer->node.global_transform));
+                const data::MeshAllocation &allocation = primitive.allocation;
+                if (bound_layout != primitive.vertex_layout || bound_vertex_block != allocation.get_vertex_block())
+                {
+                    if (bound_layout != primitive.vertex_layout)
+                        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelines[(uint32_t)primitive.vertex_layout]);
+
+                    std::span<const VkBuffer> buffers = mesh_arena.get_vertex_buffers(primitive.vertex_layout, allocation.get_vertex_block());
+                    VkDeviceSize offsets[data::VERTEX_ATTRIBUTE_COUNT]{};
+                    vkCmdBindVertexBuffers(cmd, 0, buffers.size(), buffers.data(), offsets);
+                    bound_layout = primitive.vertex_layout;
+                    bound_vertex_block = allocation.get_vertex_block();
+                }
+                if (bound_index_buffer != std::pair{allocation.get_index_block(), primitive.index_type})
+                {
+                    vkCmdBindIndexBuffer(cmd, mesh_arena.get_index_buffer(allocation.get_index_block()), 0, primitive.index_type);
+                    bound_index_buffer = std::pair{allocation.get_index_block(), primitive.index_type};
+                }
+
+                const VkDescriptorSet &material_set = mesh_renderer.model.materials.at(primitive.material_index).descriptor_set;
+                PushConstants push_constants{.model_transform = mesh_renderer.node.get_global_transform(), .dequantization = primitive.dequantization};
+                vkCmdPushConstants(cmd, pipeline_layout, VK_SHADER_STAGE_ALL, 0, sizeof(PushConstants), &push_constants);
                 vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
                                         pipeline_layout,
                                         1,
@@ -148,9 +244,8 @@ namespace gage::scene::systems
                                         2,
                                         1, &mesh.animation_descs[gfx.frame_index], 0, nullptr);
 
-                vkCmdBindVertexBuffers(cmd, 0, sizeof(buffers) / sizeof(buffers[0]), buffers, offsets);
-                vkCmdBindIndexBuffer(cmd, primitive.index_buffer.get_buffer_handle(), 0, VK_INDEX_TYPE_UINT32);
-                vkCmdDrawIndexed(cmd, primitive.vertex_count, 1, 0, 0, 0);
+                const data::MeshLod &lod = primitive.lods.at(select_lod(primitive, mesh_renderer.node.get_global_transform()));
+                vkCmdDrawIndexed(cmd, lod.count, 1, allocation.get_first_index() + lod.start, allocation.get_base_vertex(), 0);
             }
         }
     }
@@ -158,23 +253,36 @@ namespace gage::scene::systems
 
     void Renderer::shutdown()
     {
-        for (const auto &mesh : mesh_renderers)
+        for (const auto &mesh : mesh_renderer_datas)
         {
+            if (!mesh.animation_buffers[0])
+                continue;
             for (uint32_t i = 0; i < gfx::Graphics::FRAMES_IN_FLIGHT; i++)
             {
                 vkFreeDescriptorSets(gfx.device.device, gfx.desc_pool.pool, 1, &mesh.animation_descs[i]);
             }
         }
+        mesh_renderer_datas.clear();
         mesh_renderers.clear();
        
     }
 
-    void Renderer::add_pbr_mesh_renderer(std::unique_ptr<components::MeshRenderer> mesh_renderer)
+    void Renderer::add_pbr_mesh_renderer(uint32_t slot)
     {
-        MeshRenderer additional_data{};
-        additional_data.mesh_renderer = std::move(mesh_renderer);
+        if (slot >= mesh_renderer_datas.size())
+        {
+            mesh_renderer_datas.resize(slot + 1);
+        }
+    }
 
-        this->mesh_renderers.push_back(std::move(additional_data));
+    data::MeshArena &Renderer::get_mesh_arena()
+    {
+        return mesh_arena;
+    }
+
+    const data::MeshArena &Renderer::get_mesh_arena() const
+    {
+        return mesh_arena;
     }
 
     VkDescriptorSet Renderer::allocate_material_set(const MaterialSetAllocInfo &info) const
@@ -325,7 +433,7 @@ namespace gage::scene::systems
             VkPushConstantRange{
                 VK_SHADER_STAGE_ALL,
                 0,
-                sizeof(glm::mat4x4)}};
+                sizeof(PushConstants)}};
 
         std::vector<VkDescriptorSetLayout> layouts = {gfx.global_desc_layout.layout, material_set_layout, animation_set_layout};
         VkPipelineLayoutCreateInfo pipeline_layout_info = {};
@@ -336,29 +444,9 @@ namespace gage::scene::systems
         pipeline_layout_info.setLayoutCount = layouts.size();
         vk_check(vkCreatePipelineLayout(gfx.device.device, &pipeline_layout_info, nullptr, &pipeline_layout));
 
-        //Create pipeline
-        std::vector<VkVertexInputBindingDescription> vertex_bindings{
-            {.binding = 0, .stride = (sizeof(float) * 3),       .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}, // position
-            {.binding = 1, .stride = (sizeof(float) * 3),       .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}, // Normal
-            {.binding = 2, .stride = (sizeof(float) * 2),       .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}, // Texcoord
-            {.binding = 3, .stride = (sizeof(uint16_t) * 4),    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}, // Bone id
-            {.binding = 4, .stride = (sizeof(float) * 4),       .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}, // Bone weight
-        };
-
-        std::vector<VkVertexInputAttributeDescription> vertex_attributes{
-            {.location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = 0},
-            {.location = 1, .binding = 1, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = 0},
-            {.location = 2, .binding = 2, .format = VK_FORMAT_R32G32_SFLOAT, .offset = 0},
-            {.location = 3, .binding = 3, .format = VK_FORMAT_R16G16B16A16_UINT, .offset = 0},
-            {.location = 4, .binding = 4, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = 0},
-        };
-
+        //Create pipeline, vertex input is set per vertex layout
         VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
         vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertex_input_info.vertexBindingDescriptionCount = vertex_bindings.size();
-        vertex_input_info.pVertexBindingDescriptions = vertex_bindings.data();
-        vertex_input_info.vertexAttributeDescriptionCount = vertex_attributes.size();
-        vertex_input_info.pVertexAttributeDescriptions = vertex_attributes.data();
 
         VkPipelineInputAssemblyStateCreateInfo input_assembly{};
         input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -555,7 +643,35 @@ namespace gage::scene::systems
         pipeline_info.layout = pipeline_layout;
         pipeline_info.renderPass = gfx.geometry_buffer.get_mainpass_render_pass();
 
-        vk_check(vkCreateGraphicsPipelines(gfx.device.device, nullptr, 1, &pipeline_info, nullptr, &pipeline));
+        // Quantized layouts store octahedral normals, decoded by the vertex shader when OCTAHEDRAL_NORMALS is set
+        VkSpecializationMapEntry specialization_map_entry{.constantID = 0, .offset = 0, .size = sizeof(VkBool32)};
+        VkSpecializationInfo specialization_info{};
+        specialization_info.dataSize = sizeof(VkBool32);
+        specialization_info.mapEntryCount = 1;
+        specialization_info.pMapEntries = &specialization_map_entry;
+
+        static constexpr data::VertexAttribute ATTRIBUTES[] = {
+            data::VERTEX_ATTRIBUTE_POSITION,
+            data::VERTEX_ATTRIBUTE_NORMAL,
+            data::VERTEX_ATTRIBUTE_TEXCOORD,
+            data::VERTEX_ATTRIBUTE_BONE_ID,
+            data::VERTEX_ATTRIBUTE_BONE_WEIGHT};
+        std::vector<VkVertexInputBindingDescription> vertex_bindings{};
+        std::vector<VkVertexInputAttributeDescription> vertex_attributes{};
+        for (uint32_t layout = 0; layout < data::VERTEX_LAYOUT_COUNT; layout++)
+        {
+            get_vertex_input((data::VertexLayout)layout, ATTRIBUTES, vertex_bindings, vertex_attributes);
+            vertex_input_info.vertexBindingDescriptionCount = vertex_bindings.size();
+            vertex_input_info.pVertexBindingDescriptions = vertex_bindings.data();
+            vertex_input_info.vertexAttributeDescriptionCount = vertex_attributes.size();
+            vertex_input_info.pVertexAttributeDescriptions = vertex_attributes.data();
+
+            VkBool32 octahedral_normals = (data::VertexLayout)layout != data::VertexLayout::Full;
+            specialization_info.pData = &octahedral_normals;
+            pipeline_shader_stages[0].pSpecializationInfo = &specialization_info;
+
+            vk_check(vkCreateGraphicsPipelines(gfx.device.device, nullptr, 1, &pipeline_info, nullptr, &pipelines[layout]));
+        }
 
         vkDestroyShaderModule(gfx.device.device, vertex_shader, nullptr);
         vkDestroyShaderModule(gfx.device.device, geometry_shader, nullptr);
@@ -567,7 +683,7 @@ namespace gage::scene::systems
             VkPushConstantRange{
                 VK_SHADER_STAGE_ALL,
                 0,
-                sizeof(glm::mat4x4)}};
+                sizeof(PushConstants)}};
 
         std::vector<VkDescriptorSetLayout> layouts = {gfx.global_desc_layout.layout, animation_set_layout};
         VkPipelineLayoutCreateInfo pipeline_layout_info = {};
@@ -578,24 +694,9 @@ namespace gage::scene::systems
         pipeline_layout_info.setLayoutCount = layouts.size();
         vk_check(vkCreatePipelineLayout(gfx.device.device, &pipeline_layout_info, nullptr, &depth_pipeline_layout));
 
-        std::vector<VkVertexInputBindingDescription> vertex_bindings{
-            {.binding = 0, .stride = (sizeof(float) * 3), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}, // position
-            {.binding = 1, .stride = (sizeof(uint16_t) * 4),    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}, // Bone id
-            {.binding = 2, .stride = (sizeof(float) * 4),       .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}, // Bone weight
-        };
-
-        std::vector<VkVertexInputAttributeDescription> vertex_attributes{
-            {.location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = 0},
-            {.location = 1, .binding = 1, .format = VK_FORMAT_R16G16B16A16_UINT, .offset = 0},
-            {.location = 2, .binding = 2, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = 0},
-        };
-
+        // Vertex input is set per vertex layout
         VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
         vertex_input_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertex_input_info.vertexBindingDescriptionCount = vertex_bindings.size();
-        vertex_input_info.pVertexBindingDescriptions = vertex_bindings.data();
-        vertex_input_info.vertexAttributeDescriptionCount = vertex_attributes.size();
-        vertex_input_info.pVertexAttributeDescriptions = vertex_attributes.data();
 
         VkPipelineInputAssemblyStateCreateInfo input_assembly{};
         input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -737,7 +838,22 @@ namespace gage::scene::systems
         pipeline_info.layout = depth_pipeline_layout;
         pipeline_info.renderPass = gfx.geometry_buffer.get_shadowpass_render_pass();
 
-        vk_check(vkCreateGraphicsPipelines(gfx.device.device, nullptr, 1, &pipeline_info, nullptr, &depth_pipeline));
+        static constexpr data::VertexAttribute ATTRIBUTES[] = {
+            data::VERTEX_ATTRIBUTE_POSITION,
+            data::VERTEX_ATTRIBUTE_BONE_ID,
+            data::VERTEX_ATTRIBUTE_BONE_WEIGHT};
+        std::vector<VkVertexInputBindingDescription> vertex_bindings{};
+        std::vector<VkVertexInputAttributeDescription> vertex_attributes{};
+        for (uint32_t layout = 0; layout < data::VERTEX_LAYOUT_COUNT; layout++)
+        {
+            get_vertex_input((data::VertexLayout)layout, ATTRIBUTES, vertex_bindings, vertex_attributes);
+            vertex_input_info.vertexBindingDescriptionCount = vertex_bindings.size();
+            vertex_input_info.pVertexBindingDescriptions = vertex_bindings.data();
+            vertex_input_info.vertexAttributeDescriptionCount = vertex_attributes.size();
+            vertex_input_info.pVertexAttributeDescriptions = vertex_attributes.data();
+
+            vk_check(vkCreateGraphicsPipelines(gfx.device.device, nullptr, 1, &pipeline_info, nullptr, &depth_pipelines[layout]));
+        }
 
         vkDestroyShaderModule(gfx.device.device, vertex_shader, nullptr);
         vkDestroyShaderModule(gfx.device.device, geometry_shader, nullptr);
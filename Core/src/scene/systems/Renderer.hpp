@@ -1,11 +1,14 @@
 #pragma once
 
 #include "../components/MeshRenderer.hpp"
+#include "../data/VertexQuantization.hpp"
+#include "../data/MeshArena.hpp"
 
 #include <vector>
 #include <memory>
 #include <Core/src/gfx/Graphics.hpp>
 #include <Core/src/gfx/data/CPUBuffer.hpp>
+#include <Core/src/utils/PagedPool.hpp>
 
 namespace gage::gfx::data
 {
@@ -17,6 +20,11 @@ namespace gage::scene
     class SceneGraph;
 }
 
+namespace gage::scene::data
+{
+    class ModelMeshPrimitive;
+}
+
 namespace gage::scene::systems
 {
     class Renderer
@@ -36,16 +44,22 @@ namespace gage::scene::systems
             VkSampler normal_sampler{};
         };
 
+        // Push constants of the pbr and shadow shaders
+        struct PushConstants
+        {
+            glm::mat4x4 model_transform{};
+            data::VertexDequantization dequantization{};
+        };
+
+        // Per frame data of the mesh renderer in the same pool slot
         struct MeshRenderer
         {
             std::unique_ptr<gfx::data::CPUBuffer> animation_buffers[gfx::Graphics::FRAMES_IN_FLIGHT]{};
             VkDescriptorSet animation_descs[gfx::Graphics::FRAMES_IN_FLIGHT]{};
-
-            std::unique_ptr<components::MeshRenderer> mesh_renderer;
         };
 
     public:
-        Renderer(const gfx::Graphics &gfx);
+        Renderer(const gfx::Graphics &gfx, const gfx::data::Camera &camera);
         ~Renderer();
 
         void init();
@@ -53,30 +67,45 @@ namespace gage::scene::systems
 
         void render_depth(VkCommandBuffer cmd) const;
         void render(VkCommandBuffer cmd) const;
+        // Records mesh renderer slots [first, first + count), lets worker threads split the draws
+        void render_depth(VkCommandBuffer cmd, uint32_t first, uint32_t count) const;
+        void render(VkCommandBuffer cmd, uint32_t first, uint32_t count) const;
+        uint32_t get_mesh_renderer_count() const;
 
-        void add_pbr_mesh_renderer(std::unique_ptr<components::MeshRenderer> mesh_renderer);
+        void add_pbr_mesh_renderer(uint32_t slot);
+        // Per frame buffers of a mesh renderer added after init()
+        void init_mesh_renderer(uint32_t slot);
 
         VkDescriptorSet allocate_material_set(const MaterialSetAllocInfo &info) const;
         VkDescriptorSet allocate_animation_set(size_t size_in_bytes, VkBuffer buffer) const;
+        // Vertex and index data of every model primitive
+        data::MeshArena& get_mesh_arena();
+        const data::MeshArena& get_mesh_arena() const;
 
     private:
         void create_pipeline();
         void create_depth_pipeline();
+        // Coarsest level of detail whose error projects to at most LOD_ERROR_THRESHOLD pixels
+        uint32_t select_lod(const data::ModelMeshPrimitive &primitive, const glm::mat4x4 &transform) const;
 
     private:
         static constexpr uint8_t STENCIL_VALUE = 0x01;
+        static constexpr float LOD_ERROR_THRESHOLD = 1.0f; // Pixels
         const gfx::Graphics &gfx;
-        std::vector<MeshRenderer> mesh_renderers;
+        const gfx::data::Camera &camera;
+        utils::PagedPool<components::MeshRenderer> mesh_renderers;
+        std::vector<MeshRenderer> mesh_renderer_datas; // Indexed by mesh_renderers slot
+        data::MeshArena mesh_arena;
 
         VkDescriptorSetLayout material_set_layout{};
         VkDescriptorSetLayout animation_set_layout{};
 
         VkPipelineLayout pipeline_layout{};
-        VkPipeline pipeline{};
+        VkPipeline pipelines[data::VERTEX_LAYOUT_COUNT]{}; // Indexed by data::VertexLayout
 
         // Shadow map
         VkPipelineLayout depth_pipeline_layout{};
-        VkPipeline depth_pipeline{};
+        VkPipeline depth_pipelines[data::VERTEX_LAYOUT_COUNT]{};
         // VkDescriptorSetLayout depth_desc_layout{};
     };
 }
\ No newline at end of file
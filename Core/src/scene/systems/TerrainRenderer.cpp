@@ -8,11 +8,14 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "../scene.hpp"
+#include "../AssetCache.hpp"
+#include "../data/VertexQuantization.hpp"
 
 namespace gage::scene::systems
 {
-    TerrainRenderer::TerrainRenderer(const gfx::Graphics &gfx, const gfx::data::Camera &camera) : gfx(gfx),
-                                                                                            camera(camera)
+    TerrainRenderer::TerrainRenderer(const gfx::Graphics &gfx, const gfx::data::Camera &camera, AssetCache &assets) : gfx(gfx),
+                                                                                            camera(camera),
+                                                                                            assets(assets)
     {
         create_pipeline();
         create_depth_pipeline();
@@ -32,11 +35,20 @@ namespace gage::scene::systems
         // Init terrain renderers
         for (auto &terrain : terrains)
         {
+            std::vector<PackedVertex> packed_vertices{};
+            packed_vertices.reserve(terrain.terrain->vertex_data.size());
+            for (const auto &v : terrain.terrain->vertex_data)
+            {
+                packed_vertices.push_back({
+                    .pos = v.pos,
+                    .tex_coord = {data::quantize_unorm16(v.tex_coord.x), data::quantize_unorm16(v.tex_coord.y)},
+                    .normal = data::encode_octahedral_normal(v.normal)});
+            }
             terrain.vertex_buffer =
                 std::make_unique<gfx::data::GPUBuffer>(gfx,
                                                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                                                       terrain.terrain->vertex_data.size() * sizeof(components::Terrain::Vertex),
-                                                       terrain.terrain->vertex_data.data());
+                                                       packed_vertices.size() * sizeof(PackedVertex),
+                                                       packed_vertices.data());
 
             terrain.index_buffer =
                 std::make_unique<gfx::data::GPUBuffer>(gfx,
@@ -45,21 +57,11 @@ namespace gage::scene::systems
                                                        terrain.terrain->indices_data.data());
 
             // Load test image
+            terrain.texture = assets.get_texture("res/textures/grass_tiled.jpg", TextureDesc{.mip_maps = true});
+            if (!terrain.texture)
             {
-                int w, h, comp;
-                stbi_uc *data = stbi_load("res/textures/grass_tiled.jpg", &w, &h, &comp, STBI_rgb);
-                if (!data)
-                {
-                    log().critical("Failed to terrain load image: {}", "res/textures/grass_tiled.jpg");
-                    throw SceneException{};
-                }
-
-                uint32_t size_in_bytes = w * h * 3;
-                gfx::data::ImageCreateInfo image_ci{data, w, h, 1, size_in_bytes, VK_FORMAT_R8G8B8_UNORM, VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_REPEAT};
-
-                image_ci.mip_levels = std::floor(std::log2(std::max(w, h))) + 1;
-                terrain.image = std::make_unique<gfx::data::Image>(gfx, image_ci);
-                stbi_image_free(data);
+                log().critical("Failed to terrain load image: {}", "res/textures/grass_tiled.jpg");
+                throw SceneException{};
             }
 
             // Create descriptor
@@ -69,7 +71,7 @@ namespace gage::scene::systems
                 // terrain.uniform_buffer_data.uv_scale = terrain.terrain->size;
 
                 // terrain.uniform_buffer = std::make_unique<gfx::data::CPUBuffer>(gfx, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(Terrain::UniformBuffer), nullptr);
-                terrain.descriptor = this->allocate_descriptor_set(terrain.image->get_image_view(), terrain.image->get_sampler());
+                terrain.descriptor = this->allocate_descriptor_set(terrain.texture->image.get_image_view(), terrain.texture->image.get_sampler());
             }
         }
     }
@@ -82,7 +84,7 @@ namespace gage::scene::systems
         terrains.clear();
     }
 
-    void TerrainRenderer::add_terrain(std::shared_ptr<components::Terrain> terrain)
+    void TerrainRenderer::add_terrain(components::Terrain *terrain)
     {
         Terrain additional_terrain_datas{};
         additional_terrain_datas.terrain = terrain;
@@ -293,15 +295,13 @@ namespace gage::scene::systems
 
         // Create pipelie
         std::vector<VkVertexInputBindingDescription> vertex_bindings{
-            {.binding = 0, .stride = (sizeof(float) * 8), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
-            //{.binding = 0, .stride = (sizeof(float) * 5), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
-            //{.binding = 2, .stride = (sizeof(float) * 2), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
+            {.binding = 0, .stride = sizeof(PackedVertex), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
         };
 
         std::vector<VkVertexInputAttributeDescription> vertex_attributes{
-            {.location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = 0},              // position
-            {.location = 1, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = sizeof(float) * 3}, // tex coord
-            {.location = 2, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = sizeof(float) * 5},
+            {.location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = 0},                               // position
+            {.location = 1, .binding = 0, .format = VK_FORMAT_R16G16_UNORM, .offset = offsetof(PackedVertex, tex_coord)}, // tex coord
+            {.location = 2, .binding = 0, .format = VK_FORMAT_R16G16_SNORM, .offset = offsetof(PackedVertex, normal)},    // octahedral normal
         };
 
         VkPipelineVertexInputStateCreateInfo vertex_input_info = {};
@@ -526,9 +526,7 @@ namespace gage::scene::systems
 
         // Create pipelie
         std::vector<VkVertexInputBindingDescription> vertex_bindings{
-            {.binding = 0, .stride = (sizeof(float) * 8), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
-            //{.binding = 0, .stride = (sizeof(float) * 5), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
-            //{.binding = 2, .stride = (sizeof(float) * 2), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
+            {.binding = 0, .stride = sizeof(PackedVertex), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX},
         };
 
         std::vector<VkVertexInputAttributeDescription> vertex_attributes{
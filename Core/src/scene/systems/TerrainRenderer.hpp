@@ -8,6 +8,7 @@
 #include <Core/src/gfx/data/Image.hpp>
 
 #include "../components/Terrain.hpp"
+#include <Core/src/utils/PagedPool.hpp>
 
 namespace gage::gfx
 {
@@ -22,6 +23,8 @@ namespace gage::gfx
 namespace gage::scene
 {
     class SceneGraph;
+    class AssetCache;
+    class Texture;
 }
 
 
@@ -31,26 +34,34 @@ namespace gage::scene::systems
     {
         friend class scene::SceneGraph;
     public:
+        // Uploaded form of components::Terrain::Vertex, texcoord in unorm16 and octahedral normal in snorm16
+        struct PackedVertex
+        {
+            glm::vec3 pos{};
+            glm::vec<2, uint16_t> tex_coord{};
+            glm::vec<2, int16_t> normal{};
+        };
+
         struct Terrain
         {
             //Additional datas
             std::unique_ptr<gfx::data::GPUBuffer> vertex_buffer{};
             std::unique_ptr<gfx::data::GPUBuffer> index_buffer{};
-            std::unique_ptr<gfx::data::Image> image{};
+            std::shared_ptr<const Texture> texture{}; // Shared through the asset cache
             std::unique_ptr<gfx::data::CPUBuffer> uniform_buffer{};
             VkDescriptorSet descriptor{};
 
             //Original data
-            std::shared_ptr<components::Terrain> terrain;
+            components::Terrain* terrain{};
         };
     public:
-        TerrainRenderer(const  gfx::Graphics &gfx, const gfx::data::Camera& camera);
+        TerrainRenderer(const  gfx::Graphics &gfx, const gfx::data::Camera& camera, AssetCache& assets);
         ~TerrainRenderer();
 
         void init();
         void shutdown();
 
-        void add_terrain(std::shared_ptr<components::Terrain> terrain);
+        void add_terrain(components::Terrain* terrain);
 
 
         void render(VkCommandBuffer cmd) const;
@@ -64,6 +75,7 @@ namespace gage::scene::systems
         static constexpr uint8_t STENCIL_VALUE = 0x02;
         const gfx::Graphics& gfx;
         const gfx::data::Camera& camera;
+        AssetCache& assets;
 
         VkPipelineLayout pipeline_layout{};
         VkPipeline pipeline{};
@@ -75,6 +87,7 @@ namespace gage::scene::systems
 
 
         //Terrains
+        utils::PagedPool<components::Terrain> terrain_components;
         std::vector<Terrain> terrains;
     };
 }
\ No newline at end of file
@@ -15,4 +15,5 @@ namespace gage::utils
     };
 
     class FileLoaderException : public Exception{ using Exception::Exception; };
+    class JobSystemException : public Exception{ using Exception::Exception; };
 }
\ No newline at end of file
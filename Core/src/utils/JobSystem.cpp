@@ -0,0 +1,345 @@
+#include <pch.hpp>
+#include "JobSystem.hpp"
+
+#include "Exception.hpp"
+
+#include <Core/src/mem.hpp>
+
+namespace gage::utils
+{
+    static thread_local uint32_t current_worker_index = JobSystem::INVALID_WORKER_INDEX;
+
+    JobSystem::WorkStealingQueue::WorkStealingQueue() : jobs(std::make_unique<std::atomic<Job *>[]>(MAX_JOBS_PER_WORKER))
+    {
+    }
+
+    bool JobSystem::WorkStealingQueue::push(Job *job)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= (int64_t)MAX_JOBS_PER_WORKER)
+        {
+            return false;
+        }
+
+        jobs[b & MASK].store(job, std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    JobSystem::Job *JobSystem::WorkStealingQueue::pop()
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // Queue is empty
+            bottom.store(b + 1, std::memory_order_release);
+            return nullptr;
+        }
+
+        Job *job = jobs[b & MASK].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // Last job, race against stealers
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                job = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_release);
+        }
+        return job;
+    }
+
+    JobSystem::Job *JobSystem::WorkStealingQueue::steal()
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+        {
+            return nullptr;
+        }
+
+        Job *job = jobs[t & MASK].load(std::memory_order_acquire);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            // Lost the race against another stealer or the owner
+            return nullptr;
+        }
+        return job;
+    }
+
+    JobSystem::JobSystem(uint32_t num_workers)
+    {
+        if (num_workers == 0)
+        {
+            num_workers = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        for (uint32_t i = 0; i < num_workers; i++)
+        {
+            auto worker = std::make_unique<Worker>();
+            worker->job_pool = std::make_unique<Job[]>(MAX_JOBS_PER_WORKER);
+            worker->random_state = i * 2654435761u + 1;
+            workers.push_back(std::move(worker));
+        }
+
+        // The calling thread is worker 0
+        current_worker_index = 0;
+        for (uint32_t i = 1; i < num_workers; i++)
+        {
+            workers.at(i)->thread = std::thread(&JobSystem::loop, this, i);
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        terminate.store(true);
+        wake_generation.fetch_add(1);
+        wake_generation.notify_all();
+        for (uint32_t i = 1; i < workers.size(); i++)
+        {
+            workers.at(i)->thread.join();
+        }
+        current_worker_index = INVALID_WORKER_INDEX;
+    }
+
+    JobSystem::Job *JobSystem::create_group()
+    {
+        return create_job([]() {});
+    }
+
+    void JobSystem::run(Job *job)
+    {
+        Worker &worker = get_current_worker();
+        if (!worker.queue.push(job))
+        {
+            // Queue is full, run it right away
+            execute(job);
+            return;
+        }
+        wake_workers();
+    }
+
+    void JobSystem::run_background(Job *job)
+    {
+        get_current_worker();
+        if (workers.size() == 1)
+        {
+            execute(job);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(background_mutex);
+            background_jobs.push_back(job);
+            background_job_count.fetch_add(1);
+        }
+        wake_workers();
+    }
+
+    void JobSystem::wait(const Job *job)
+    {
+        get_current_worker();
+        while (!is_finished(job))
+        {
+            if (Job *next = get_job())
+            {
+                execute(next);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool JobSystem::is_finished(const Job *job) const
+    {
+        return job->unfinished_jobs.load(std::memory_order_acquire) == 0;
+    }
+
+    uint32_t JobSystem::get_worker_count() const
+    {
+        return workers.size();
+    }
+
+    uint32_t JobSystem::get_worker_index()
+    {
+        return current_worker_index;
+    }
+
+    LinearArena &JobSystem::get_frame_arena()
+    {
+        return get_current_worker().frame_arena;
+    }
+
+    void JobSystem::reset_frame_arenas()
+    {
+        assert(get_worker_index() == 0 && "Frame arenas are reset from worker 0");
+        for (auto &worker : workers)
+        {
+            worker->frame_arena.reset();
+        }
+    }
+
+    JobSystem::Worker &JobSystem::get_current_worker()
+    {
+        uint32_t worker_index = get_worker_index();
+        if (worker_index == INVALID_WORKER_INDEX)
+        {
+            throw JobSystemException{"Job system used from a thread that is not one of its workers"};
+        }
+        return *workers.at(worker_index);
+    }
+
+    JobSystem::Job *JobSystem::allocate_job()
+    {
+        Worker &worker = get_current_worker();
+
+        // Slots whose job is still alive are skipped, a group for example stays alive until all of its children finished
+        for (uint32_t i = 0; i < MAX_JOBS_PER_WORKER; i++)
+        {
+            Job *job = &worker.job_pool[worker.allocated_jobs++ & (MAX_JOBS_PER_WORKER - 1)];
+            if (job->unfinished_jobs.load(std::memory_order_acquire) == 0)
+            {
+                return job;
+            }
+        }
+
+        // More than MAX_JOBS_PER_WORKER jobs in flight, finished overflow jobs are reused
+        for (auto &job : worker.overflow_jobs)
+        {
+            if (job->unfinished_jobs.load(std::memory_order_acquire) == 0)
+            {
+                return job.get();
+            }
+        }
+        return worker.overflow_jobs.emplace_back(std::make_unique<Job>()).get();
+    }
+
+    JobSystem::Job *JobSystem::get_job()
+    {
+        uint32_t worker_index = get_worker_index();
+        Worker &worker = *workers.at(worker_index);
+        if (Job *job = worker.queue.pop())
+        {
+            return job;
+        }
+
+        // Steal from a random victim, then sweep the others
+        uint32_t worker_count = workers.size();
+        if (worker_count <= 1)
+        {
+            return nullptr;
+        }
+
+        worker.random_state ^= worker.random_state << 13;
+        worker.random_state ^= worker.random_state >> 17;
+        worker.random_state ^= worker.random_state << 5;
+        uint32_t first_victim = worker.random_state % worker_count;
+        for (uint32_t i = 0; i < worker_count; i++)
+        {
+            uint32_t victim_index = (first_victim + i) % worker_count;
+            if (victim_index == worker_index)
+                continue;
+
+            if (Job *job = workers.at(victim_index)->queue.steal())
+            {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    JobSystem::Job *JobSystem::get_background_job()
+    {
+        if (background_job_count.load(std::memory_order_relaxed) == 0)
+        {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(background_mutex);
+        if (background_jobs.empty())
+        {
+            return nullptr;
+        }
+        Job *job = background_jobs.front();
+        background_jobs.pop_front();
+        background_job_count.fetch_sub(1);
+        return job;
+    }
+
+    void JobSystem::execute(Job *job)
+    {
+        job->function(job);
+        finish(job);
+    }
+
+    void JobSystem::finish(Job *job)
+    {
+        while (job)
+        {
+            Job *parent = job->parent;
+            if (job->unfinished_jobs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            {
+                return;
+            }
+            job = parent;
+        }
+    }
+
+    void JobSystem::wake_workers()
+    {
+        wake_generation.fetch_add(1);
+        if (sleeping_workers.load() > 0)
+        {
+            wake_generation.notify_all();
+        }
+    }
+
+    void JobSystem::loop(uint32_t worker_index)
+    {
+        current_worker_index = worker_index;
+        while (!terminate.load(std::memory_order_relaxed))
+        {
+            if (Job *job = get_job())
+            {
+                execute(job);
+                continue;
+            }
+            if (Job *job = get_background_job())
+            {
+                execute(job);
+                continue;
+            }
+
+            // Nothing to do, publish batched memory counters and sleep until a new job is pushed
+            flush_thread_memory_stats();
+            sleeping_workers.fetch_add(1);
+            uint32_t generation = wake_generation.load();
+            Job *job = get_job();
+            if (!job)
+            {
+                job = get_background_job();
+            }
+            if (job)
+            {
+                sleeping_workers.fetch_sub(1);
+                execute(job);
+                continue;
+            }
+            if (!terminate.load())
+            {
+                wake_generation.wait(generation);
+            }
+            sleeping_workers.fetch_sub(1);
+        }
+        flush_thread_memory_stats();
+    }
+}
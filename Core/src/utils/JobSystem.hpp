@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+#include <limits>
+
+#include "LinearArena.hpp"
+
+namespace gage::utils
+{
+    // Work stealing job system
+    // Every worker owns a lock free deque (Chase-Lev) and a ring of preallocated jobs,
+    // the thread that constructs the JobSystem is worker 0 and helps executing jobs while waiting.
+    // Jobs can only be created, run and waited on from worker threads, other threads get a JobSystemException.
+    // Long running jobs (e.g. asset import) go through run_background() so worker 0 never ends up stuck in one.
+    class JobSystem
+    {
+    public:
+        static constexpr uint32_t MAX_JOBS_PER_WORKER = 4096; // Must be a power of two
+        static constexpr size_t JOB_DATA_SIZE = 96;
+        static constexpr uint32_t INVALID_WORKER_INDEX = std::numeric_limits<uint32_t>::max();
+
+        struct alignas(64) Job
+        {
+            using Function = void (*)(Job *job);
+
+            Function function{};
+            Job *parent{};
+            std::atomic<int32_t> unfinished_jobs{}; // Itself + children, 0 means finished
+            alignas(16) unsigned char data[JOB_DATA_SIZE];
+        };
+    private:
+        class WorkStealingQueue
+        {
+        public:
+            WorkStealingQueue();
+
+            bool push(Job *job); // Owner thread only
+            Job *pop();          // Owner thread only
+            Job *steal();        // Any thread
+        private:
+            static constexpr int64_t MASK = MAX_JOBS_PER_WORKER - 1;
+
+            alignas(64) std::atomic<int64_t> top{};
+            alignas(64) std::atomic<int64_t> bottom{};
+            std::unique_ptr<std::atomic<Job *>[]> jobs;
+        };
+
+        struct Worker
+        {
+            WorkStealingQueue queue{};
+            std::unique_ptr<Job[]> job_pool{};
+            uint32_t allocated_jobs{};
+            std::vector<std::unique_ptr<Job>> overflow_jobs{}; // Used when every job of the pool is still alive
+            uint32_t random_state{};
+            LinearArena frame_arena{};
+            std::thread thread{};
+        };
+    public:
+        // 0 means one worker per hardware thread
+        JobSystem(uint32_t num_workers = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem &) = delete;
+        JobSystem operator=(const JobSystem &) = delete;
+
+        template <typename F>
+        Job *create_job(F &&function)
+        {
+            return create_child_job(nullptr, std::forward<F>(function));
+        }
+
+        // The parent will not finish until all of its children finished
+        template <typename F>
+        Job *create_child_job(Job *parent, F &&function)
+        {
+            using Function = std::decay_t<F>;
+            static_assert(sizeof(Function) <= JOB_DATA_SIZE, "Job capture is too large, capture by pointer instead");
+            static_assert(alignof(Function) <= 16, "Job capture is over aligned");
+
+            Job *job = allocate_job();
+            job->parent = parent;
+            job->unfinished_jobs.store(1, std::memory_order_relaxed);
+            job->function = [](Job *job)
+            {
+                Function *function = std::launder(reinterpret_cast<Function *>(job->data));
+                (*function)();
+                function->~Function();
+            };
+            new (job->data) Function(std::forward<F>(function));
+
+            if (parent)
+            {
+                parent->unfinished_jobs.fetch_add(1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+
+        // Empty job, usefull as a parent to wait for a group of jobs
+        Job *create_group();
+
+        void run(Job *job);
+        // Picked up by the workers other than worker 0 once their own queue and stealing came up empty.
+        // Jobs it creates are ordinary ones any worker can take. With a single worker the job runs right away
+        void run_background(Job *job);
+        // Executes other jobs while waiting
+        void wait(const Job *job);
+        bool is_finished(const Job *job) const;
+
+        // Splits [0, count) into chunks and calls function(begin, end) on every chunk, returns when all chunks are done
+        // chunk_size of 0 picks a chunk size from the worker count
+        template <typename F>
+        void parallel_for(uint32_t count, uint32_t chunk_size, const F &function)
+        {
+            if (count == 0)
+                return;
+
+            if (chunk_size == 0)
+            {
+                chunk_size = std::max(1u, count / (get_worker_count() * 4));
+            }
+
+            if (count <= chunk_size)
+            {
+                function(0u, count);
+                return;
+            }
+
+            Job *group = create_group();
+            for (uint32_t begin = 0; begin < count; begin += chunk_size)
+            {
+                uint32_t end = std::min(begin + chunk_size, count);
+                run(create_child_job(group, [&function, begin, end]()
+                                     { function(begin, end); }));
+            }
+            run(group);
+            wait(group);
+        }
+
+        uint32_t get_worker_count() const;
+        // Index of the calling worker thread, INVALID_WORKER_INDEX if the thread is not a worker
+        static uint32_t get_worker_index();
+
+        // Scratch memory of the calling worker, valid until reset_frame_arenas()
+        LinearArena &get_frame_arena();
+        // Worker 0 only, no job may be using its frame arena
+        void reset_frame_arenas();
+    private:
+        Worker &get_current_worker();
+        Job *allocate_job();
+        Job *get_job();
+        Job *get_background_job();
+        void execute(Job *job);
+        void finish(Job *job);
+        void wake_workers();
+        void loop(uint32_t worker_index);
+    private:
+        std::vector<std::unique_ptr<Worker>> workers{};
+        std::atomic<bool> terminate{};
+        std::atomic<uint32_t> wake_generation{};
+        std::atomic<uint32_t> sleeping_workers{};
+        std::mutex background_mutex{};
+        std::deque<Job *> background_jobs{};
+        std::atomic<uint32_t> background_job_count{}; // Checked before taking the lock
+    };
+}
@@ -0,0 +1,74 @@
+#include <pch.hpp>
+#include "LinearArena.hpp"
+
+namespace gage::utils
+{
+    LinearArena::LinearArena(size_t block_size) : block_size(block_size)
+    {
+    }
+
+    void *LinearArena::allocate(size_t size, size_t alignment)
+    {
+        assert((alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+        if (size == 0)
+            size = 1;
+
+        while (current_block < blocks.size())
+        {
+            Block &block = blocks.at(current_block);
+            uintptr_t base = (uintptr_t)block.memory.get();
+            uintptr_t aligned = (base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            size_t aligned_offset = aligned - base;
+            if (aligned_offset + size <= block.size)
+            {
+                offset = aligned_offset + size;
+                return (void *)aligned;
+            }
+
+            // Does not fit, move on to the next block
+            used_bytes_in_previous_blocks += offset;
+            current_block++;
+            offset = 0;
+        }
+
+        add_block(size + alignment);
+        return allocate(size, alignment);
+    }
+
+    void LinearArena::reset()
+    {
+        if (blocks.size() > 1)
+        {
+            size_t total_size = get_capacity_bytes();
+            blocks.clear();
+            add_block(total_size);
+        }
+        current_block = 0;
+        offset = 0;
+        used_bytes_in_previous_blocks = 0;
+    }
+
+    size_t LinearArena::get_used_bytes() const
+    {
+        return used_bytes_in_previous_blocks + offset;
+    }
+
+    size_t LinearArena::get_capacity_bytes() const
+    {
+        size_t capacity = 0;
+        for (const auto &block : blocks)
+        {
+            capacity += block.size;
+        }
+        return capacity;
+    }
+
+    void LinearArena::add_block(size_t min_size)
+    {
+        size_t size = std::max(block_size, min_size);
+        blocks.push_back(Block{
+            .memory = std::make_unique_for_overwrite<unsigned char[]>(size),
+            .size = size,
+        });
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace gage::utils
+{
+    // Bump allocator, individual allocations are never freed, reset() releases everything at once.
+    // Not thread safe, every thread should use its own arena.
+    class LinearArena
+    {
+        struct Block
+        {
+            std::unique_ptr<unsigned char[]> memory{};
+            size_t size{};
+        };
+    public:
+        static constexpr size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+        LinearArena(size_t block_size = DEFAULT_BLOCK_SIZE);
+        ~LinearArena() = default;
+
+        LinearArena(LinearArena &&) = default;
+        LinearArena &operator=(LinearArena &&) = default;
+        LinearArena(const LinearArena &) = delete;
+        LinearArena operator=(const LinearArena &) = delete;
+
+        void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+        // Everything allocated becomes invalid, blocks are kept and merged so the next round does not grow again
+        void reset();
+
+        size_t get_used_bytes() const;
+        size_t get_capacity_bytes() const;
+    private:
+        void add_block(size_t min_size);
+    private:
+        std::vector<Block> blocks{};
+        size_t block_size{};
+        uint32_t current_block{};
+        size_t offset{};
+        size_t used_bytes_in_previous_blocks{};
+    };
+
+    // std compatible allocator adapter, deallocate is a no op
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+        using value_type = T;
+
+        ArenaAllocator(LinearArena &arena) noexcept : arena(&arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena(other.arena) {}
+
+        T *allocate(size_t n)
+        {
+            return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, size_t) noexcept
+        {
+        }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U> &other) const noexcept
+        {
+            return arena == other.arena;
+        }
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U> &other) const noexcept
+        {
+            return arena != other.arena;
+        }
+
+        LinearArena *arena;
+    };
+
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
@@ -0,0 +1,51 @@
+#include <pch.hpp>
+#include "MappedFile.hpp"
+
+#include "Exception.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace gage::utils
+{
+    MappedFile::MappedFile(const std::string &file_path)
+    {
+        int fd = open(file_path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw FileLoaderException{"Error opening file: " + file_path};
+        }
+
+        struct stat file_stat{};
+        if (fstat(fd, &file_stat) != 0)
+        {
+            close(fd);
+            throw FileLoaderException{"Error reading file size: " + file_path};
+        }
+        size = file_stat.st_size;
+
+        // mmap does not take empty mappings
+        if (size > 0)
+        {
+            void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED)
+            {
+                close(fd);
+                throw FileLoaderException{"Error mapping file: " + file_path};
+            }
+            data = static_cast<const unsigned char *>(mapping);
+        }
+        // The mapping keeps the file alive
+        close(fd);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (data)
+        {
+            munmap(const_cast<unsigned char *>(data), size);
+        }
+    }
+}
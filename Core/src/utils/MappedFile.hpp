@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace gage::utils
+{
+    // Read only memory mapping of a whole file, pages are loaded by the OS on first access
+    class MappedFile
+    {
+    public:
+        // Throws FileLoaderException if the file can not be opened or mapped
+        MappedFile(const std::string &file_path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile operator=(const MappedFile &) = delete;
+
+        const unsigned char *get_data() const { return data; }
+        size_t get_size() const { return size; }
+    private:
+        const unsigned char *data{};
+        size_t size{};
+    };
+}
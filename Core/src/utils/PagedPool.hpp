@@ -0,0 +1,157 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cassert>
+#include <utility>
+#include <new>
+
+namespace gage::utils
+{
+    // Objects of one type stored contiguously in fixed size pages.
+    // Pages never move so pointers stay valid for the lifetime of the object, iterating is a linear sweep
+    // over the pages. Erased slots go to a free list and are reused by the next emplace, their generation
+    // is bumped so stale handles can be detected. Not thread safe.
+    template <typename T, uint32_t PAGE_SIZE = 256>
+    class PagedPool
+    {
+        struct Page
+        {
+            alignas(T) unsigned char bytes[sizeof(T) * PAGE_SIZE];
+        };
+    public:
+        template <typename Pool, typename Value>
+        class Iterator
+        {
+        public:
+            Iterator(Pool *pool, uint32_t slot) : pool(pool), slot(slot) { skip_dead(); }
+
+            Value &operator*() const { return pool->at(slot); }
+            Value *operator->() const { return &pool->at(slot); }
+            Iterator &operator++()
+            {
+                slot++;
+                skip_dead();
+                return *this;
+            }
+            bool operator==(const Iterator &other) const { return slot == other.slot; }
+            bool operator!=(const Iterator &other) const { return slot != other.slot; }
+
+            uint32_t get_slot() const { return slot; }
+        private:
+            void skip_dead()
+            {
+                while (slot < pool->get_slot_count() && !pool->is_alive(slot))
+                    slot++;
+            }
+        private:
+            Pool *pool;
+            uint32_t slot;
+        };
+        using iterator = Iterator<PagedPool, T>;
+        using const_iterator = Iterator<const PagedPool, const T>;
+    public:
+        PagedPool() = default;
+        ~PagedPool() { clear(); }
+
+        PagedPool(const PagedPool &) = delete;
+        PagedPool operator=(const PagedPool &) = delete;
+
+        // Constructs in place and returns its slot, the object does not move until it is destroyed
+        template <typename... Args>
+        uint32_t emplace(Args &&...args)
+        {
+            uint32_t slot = free_slots.empty() ? slot_count : free_slots.back();
+            if (slot / PAGE_SIZE == pages.size())
+            {
+                pages.push_back(std::make_unique_for_overwrite<Page>());
+                generations.resize(pages.size() * PAGE_SIZE, 0);
+                alive.resize(pages.size() * PAGE_SIZE, false);
+            }
+
+            new (get_address(slot)) T(std::forward<Args>(args)...);
+            alive[slot] = true;
+            if (free_slots.empty())
+                slot_count++;
+            else
+                free_slots.pop_back();
+            count++;
+            return slot;
+        }
+
+        void erase(uint32_t slot)
+        {
+            at(slot).~T();
+            alive[slot] = false;
+            generations[slot]++;
+            free_slots.push_back(slot);
+            count--;
+        }
+
+        void clear()
+        {
+            for (uint32_t slot = 0; slot < slot_count; slot++)
+            {
+                if (alive[slot])
+                {
+                    at(slot).~T();
+                    alive[slot] = false;
+                    generations[slot]++;
+                }
+            }
+            free_slots.clear();
+            slot_count = 0;
+            count = 0;
+        }
+
+        T &at(uint32_t slot)
+        {
+            assert(slot < slot_count && alive[slot] && "Invalid pool slot");
+            return *std::launder(reinterpret_cast<T *>(get_address(slot)));
+        }
+        const T &at(uint32_t slot) const
+        {
+            assert(slot < slot_count && alive[slot] && "Invalid pool slot");
+            return *std::launder(reinterpret_cast<const T *>(get_address(slot)));
+        }
+
+        // Slot of an object owned by this pool, scans the pages
+        uint32_t get_slot(const T *object) const
+        {
+            const unsigned char *address = reinterpret_cast<const unsigned char *>(object);
+            for (uint32_t page = 0; page < pages.size(); page++)
+            {
+                const unsigned char *begin = pages[page]->bytes;
+                if (address >= begin && address < begin + sizeof(Page::bytes))
+                    return page * PAGE_SIZE + (address - begin) / sizeof(T);
+            }
+            assert(false && "Object is not owned by this pool");
+            return slot_count;
+        }
+
+        bool is_alive(uint32_t slot) const { return slot < slot_count && alive[slot]; }
+        uint32_t get_generation(uint32_t slot) const { return generations[slot]; }
+        // Live objects
+        uint32_t size() const { return count; }
+        // Upper bound of the slots in use, dead slots below it are skipped by iteration
+        uint32_t get_slot_count() const { return slot_count; }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, slot_count); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, slot_count); }
+    private:
+        unsigned char *get_address(uint32_t slot) const
+        {
+            return pages[slot / PAGE_SIZE]->bytes + (slot % PAGE_SIZE) * sizeof(T);
+        }
+    private:
+        std::vector<std::unique_ptr<Page>> pages{};
+        std::vector<uint32_t> generations{};
+        std::vector<uint8_t> alive{};
+        std::vector<uint32_t> free_slots{};
+        uint32_t slot_count{};
+        uint32_t count{};
+    };
+}
@@ -130,6 +130,65 @@ namespace gage::win
         }
         ImGui::End();
 
+        if (ImGui::Begin("Memory"))
+        {
+            static MemorySnapshot baseline{};
+            static bool has_baseline = false;
+            MemorySnapshot current = take_memory_snapshot();
+
+            ImGui::Text("Last frame: %ld allocations, %ld bytes", current.frame_allocation_count, current.frame_allocated_bytes);
+            ImGui::Text("Total: %ld bytes | peak: %ld bytes", current.total.allocated_bytes, current.total.peak_bytes);
+            static const char *budget_modes[] = {"Disabled", "Log", "Abort"};
+            int budget_mode = (int)get_frame_allocation_budget_mode();
+            int budget = (int)get_frame_allocation_budget();
+            bool budget_changed = ImGui::Combo("Frame allocation budget", &budget_mode, budget_modes, IM_ARRAYSIZE(budget_modes));
+            budget_changed |= ImGui::InputInt("Max allocations per frame", &budget);
+            if (budget_changed)
+            {
+                set_frame_allocation_budget((FrameAllocationBudgetMode)budget_mode, std::max(budget, 0));
+            }
+
+            if (ImGui::Button("Take snapshot"))
+            {
+                baseline = current;
+                has_baseline = true;
+            }
+
+            const MemorySnapshot &shown = has_baseline ? diff_memory_snapshots(baseline, current) : current;
+            if (has_baseline)
+            {
+                ImGui::SameLine();
+                ImGui::Text("Diff over %lu frames", shown.frame_index);
+            }
+
+            if (ImGui::BeginTable("Memory tags", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+            {
+                ImGui::TableSetupColumn("Tag");
+                ImGui::TableSetupColumn("Bytes");
+                ImGui::TableSetupColumn("Peak");
+                ImGui::TableSetupColumn("Allocations");
+                ImGui::TableSetupColumn("Frees");
+                ImGui::TableHeadersRow();
+                for (uint32_t i = 0; i < (uint32_t)MemoryTag::COUNT; i++)
+                {
+                    const MemoryStats &tag = shown.tags[i];
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(get_memory_tag_name((MemoryTag)i));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%ld", tag.allocated_bytes);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%ld", tag.peak_bytes);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%ld", tag.allocation_count);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%ld", tag.free_count);
+                }
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+
         if (ImGui::Begin("Camera"))
         {
             ImGui::DragFloat3("position", &camera.get_position().x, 0.1f);
@@ -13,6 +13,8 @@
 #include <Core/src/gfx/data/SSAO.hpp>
 #include <Core/src/gfx/Graphics.hpp>
 #include <Core/src/gfx/data/DebugRenderer.hpp>
+#include <Core/src/utils/JobSystem.hpp>
+#include <Core/src/mem.hpp>
 
 
 #include <Core/src/scene/scene.hpp>
@@ -27,7 +29,9 @@
 #include <Core/src/hid/Mouse.hpp>
 
 #include <thread>
+#include <cstring>
 #include <iostream>
+#include <filesystem>
 
 #include <glm/gtx/string_cast.hpp>
 
@@ -36,16 +40,82 @@
 using namespace gage;
 using namespace std::chrono_literals;
 
-int main()
+static constexpr uint32_t TRANSFORM_BENCHMARK_INSTANCES = 500;
+
+// Time the world transform pass over every node with 1 to N worker threads
+static void run_transform_benchmark(scene::SceneGraph &scene, const std::vector<scene::Node *> &instances)
+{
+    constexpr uint32_t WARMUP_ITERATIONS = 10;
+    constexpr uint32_t ITERATIONS = 100;
+    uint32_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "Transform benchmark: " << instances.size() << " instances, " << scene.transforms.get_size() << " transforms\n";
+
+    // Own thread so the worker index of the engine job system is left alone
+    std::thread benchmark_thread([&]()
+    {
+        double single_thread_ms = 0.0;
+        for (uint32_t threads = 1;; threads = std::min(threads * 2, max_threads))
+        {
+            utils::JobSystem job_system(threads);
+            double total_ms = 0.0;
+            for (uint32_t i = 0; i < WARMUP_ITERATIONS + ITERATIONS; i++)
+            {
+                // Moving every instance root dirties every node, like animating every character
+                glm::vec3 offset{i % 2 ? 0.001f : -0.001f, 0.0f, 0.0f};
+                for (scene::Node *instance : instances)
+                {
+                    instance->set_position(instance->get_position() + offset);
+                }
+
+                auto begin = std::chrono::high_resolution_clock::now();
+                scene.transforms.update(job_system);
+                auto end = std::chrono::high_resolution_clock::now();
+                if (i >= WARMUP_ITERATIONS)
+                {
+                    total_ms += std::chrono::duration<double, std::milli>(end - begin).count();
+                }
+            }
+
+            double ms = total_ms / ITERATIONS;
+            if (threads == 1)
+            {
+                single_thread_ms = ms;
+            }
+            std::cout << threads << " threads: " << ms << " ms, speed-up x" << single_thread_ms / ms << "\n";
+
+            if (threads == max_threads)
+                break;
+        }
+    });
+    benchmark_thread.join();
+}
+
+int main(int argc, char **argv)
 {
+    bool transform_benchmark = false;
+    std::string scene_path{};
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--transform-benchmark") == 0)
+        {
+            transform_benchmark = true;
+        }
+        else if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+        {
+            scene_path = argv[++i];
+        }
+    }
+
     gfx::init();
     win::init();
     scene::init();
     hid::init();
     try
     {
+        utils::JobSystem job_system{};
         win::Window window(800, 600, "Hello world");
-        gfx::Graphics gfx(window.p_window, 800, 600, "VulkanEngine");
+        gfx::Graphics gfx(window.p_window, 800, 600, "VulkanEngine", job_system.get_worker_count());
         win::ImguiWindow imgui_window(gfx);
 
         hid::Keyboard keyboard(window.p_window);
@@ -82,69 +152,105 @@ int main()
         //     }
         // }
 
-        scene::SceneGraph scene(gfx, camera);
+        scene::SceneGraph scene(gfx, camera, job_system);
 
         const scene::data::Model &scene_model = scene.import_model("res/models/human_base.glb", scene::data::ModelImportMode::Binary);
         const scene::data::Model &toothless_model = scene.import_model("res/models/toothless.glb", scene::data::ModelImportMode::Binary);
         const scene::data::Model &box_model = scene.import_model("res/models/box_textured.glb", scene::data::ModelImportMode::Binary);
 
-        scene::Node *animated_node = scene.instanciate_model(scene_model, {0, 0, 0});
-        animated_node->position = {50, 10, 50};
-        animated_node->name = "Player";
-        scene.add_component(animated_node, std::make_unique<scene::components::Animator>(scene, *animated_node, scene_model));
-        scene.add_component(animated_node, std::make_unique<scene::components::CharacterController>(scene, *animated_node));
-        scene.add_component(animated_node, std::make_unique<FPSCharacterController>(scene, *animated_node, scene.physics, camera));
-
-        auto terrain = scene.create_node();
-        terrain->name = "Terrain";
-        scene.add_component(terrain, std::make_unique<scene::components::Terrain>(scene, *terrain, gfx, 64, 17, 64, 1.0, -50, 50, 0.1f));
-
-        auto map = scene.create_node();
-        map->name = "Test map";
-        map->position = {50.0f, 0.0f, 50.0f};
-        scene::components::Map* map_comp = (scene::components::Map*)scene.add_component(map, std::make_unique<scene::components::Map>(scene, *map));
-
-        scene::components::AABBWall aabb_wall{};
-        aabb_wall.a = {0.0f, 0.0f, 0.0f};
-        aabb_wall.b = {10.0f, 1.0f, 10.0f};
-        aabb_wall.top.texture = "res/textures/grass_tiled.jpg";
-        aabb_wall.top.uv_scale = {10.0f, 10.0f};
-        aabb_wall.left.texture = "res/textures/x.jpg";
-        aabb_wall.left.uv_scale = {10.0f, 10.0f};
-
-        scene::components::StaticModel static_model{};
-        static_model.model_path = "res/models/toothless.glb";
-
-        map_comp->add_aabb_wall(aabb_wall);
-        map_comp->add_aabb_wall({{0.0f, 10.0f, 10.0f}, {10.0f, 10.0f, 1.0f}});
-        map_comp->add_aabb_wall({{0.0f, 10.0f, -10.0f}, {10.0f, 10.0f, 1.0f}});
-        static_model.offset = {0, 2, 0};
-        map_comp->add_static_model(static_model);
-        static_model.offset = {1, 2, 0};
-        map_comp->add_static_model(static_model);
-        static_model.offset = {2, 2, 0};
-        map_comp->add_static_model(static_model);
-        static_model.offset = {3, 2, 0};
-        map_comp->add_static_model(static_model);
-
-        scene::Node* physics_body = scene.instanciate_model(box_model, {50, 3, 50});
-        scene.add_component(physics_body, std::make_unique<scene::components::RigidBody>(scene, *physics_body, 
-            std::make_unique<scene::components::BoxShape>(glm::vec3{0, 0, 0}, glm::vec3{1, 1, 1})));
+        scene.register_script("FPSCharacterController", [&camera](scene::SceneGraph &scene_graph, scene::Node *node, const nlohmann::json &)
+                              { scene_graph.add_component<FPSCharacterController>(node, scene_graph.physics, camera); });
+
+        if (!scene_path.empty())
+        {
+            if (std::filesystem::path(scene_path).extension() == ".gscn")
+                scene.load_binary(scene_path);
+            else
+                scene.load(scene_path);
+        }
+        else
+        {
+            scene::Node *animated_node = scene.instanciate_model(scene_model, {0, 0, 0});
+            animated_node->set_position({50, 10, 50});
+            animated_node->name = "Player";
+            scene.add_component<scene::components::Animator>(animated_node, scene_model);
+            scene.add_component<scene::components::CharacterController>(animated_node);
+            scene.add_component<FPSCharacterController>(animated_node, scene.physics, camera);
+
+            auto terrain = scene.create_node();
+            terrain->name = "Terrain";
+            scene.add_component<scene::components::Terrain>(terrain, gfx, 64, 17, 64, 1.0, -50, 50, 0.1f);
+
+            auto map = scene.create_node();
+            map->name = "Test map";
+            map->set_position({50.0f, 0.0f, 50.0f});
+            scene::components::Map* map_comp = scene.add_component<scene::components::Map>(map);
+
+            scene::components::AABBWall aabb_wall{};
+            aabb_wall.a = {0.0f, 0.0f, 0.0f};
+            aabb_wall.b = {10.0f, 1.0f, 10.0f};
+            aabb_wall.top.texture = "res/textures/grass_tiled.jpg";
+            aabb_wall.top.uv_scale = {10.0f, 10.0f};
+            aabb_wall.left.texture = "res/textures/x.jpg";
+            aabb_wall.left.uv_scale = {10.0f, 10.0f};
+
+            scene::components::StaticModel static_model{};
+            static_model.model_path = "res/models/toothless.glb";
+
+            map_comp->add_aabb_wall(aabb_wall);
+            map_comp->add_aabb_wall({{0.0f, 10.0f, 10.0f}, {10.0f, 10.0f, 1.0f}});
+            map_comp->add_aabb_wall({{0.0f, 10.0f, -10.0f}, {10.0f, 10.0f, 1.0f}});
+            static_model.offset = {0, 2, 0};
+            map_comp->add_static_model(static_model);
+            static_model.offset = {1, 2, 0};
+            map_comp->add_static_model(static_model);
+            static_model.offset = {2, 2, 0};
+            map_comp->add_static_model(static_model);
+            static_model.offset = {3, 2, 0};
+            map_comp->add_static_model(static_model);
+
+            scene::Node* physics_body = scene.instanciate_model(box_model, {50, 3, 50});
+            scene.add_component<scene::components::RigidBody>(physics_body,
+                std::make_unique<scene::components::BoxShape>(glm::vec3{0, 0, 0}, glm::vec3{1, 1, 1}));
         
-        scene::Node* node = scene.instanciate_model(toothless_model, {50, 10, 50});
-        scene::components::Animator* component = 
-            (scene::components::Animator*)scene.add_component(node, std::make_unique<scene::components::Animator>(scene, *node, toothless_model));
-        scene.add_component(node, std::make_unique<scene::components::CharacterController>(scene, *node));
+            scene::Node* node = scene.instanciate_model(toothless_model, {50, 10, 50});
+            scene::components::Animator* component = scene.add_component<scene::components::Animator>(node, toothless_model);
+            scene.add_component<scene::components::CharacterController>(node);
+        }
+        scene.add_task({.name = "final_ambient.update",
+                        .stage = scene::TaskStage::UPDATE,
+                        .reads = scene::TaskResources::NONE,
+                        .writes = scene::TaskResources::LIGHTING,
+                        .function = [&gfx](const scene::TickContext &context)
+                        { gfx.final_ambient.update(context.delta); }});
+
+        std::vector<scene::Node *> benchmark_instances{};
+        if (transform_benchmark)
+        {
+            for (uint32_t i = 0; i < TRANSFORM_BENCHMARK_INSTANCES; i++)
+            {
+                glm::vec3 position{(i % 25) * 2.0f, 0.0f, (i / 25) * 2.0f};
+                scene::Node *instance = scene.instanciate_model(scene_model, position);
+                scene.add_component<scene::components::Animator>(instance, scene_model);
+                benchmark_instances.push_back(instance);
+            }
+        }
         scene.init();
 
+        if (transform_benchmark)
+        {
+            run_transform_benchmark(scene, benchmark_instances);
+        }
+
         auto previous = std::chrono::high_resolution_clock::now();
         uint64_t lag = 0; 
 
         double tick_time_in_seconds = 1.0 / 64.0;
         uint64_t tick_time_in_nanoseconds = tick_time_in_seconds * 1E9;
 
-        while (!window.is_closing())
+        while (!transform_benchmark && !window.is_closing())
         {
+            memory_begin_frame();
             auto current = std::chrono::high_resolution_clock::now();
             auto elapsed = std::chrono::nanoseconds(current - previous);
             previous = current;
@@ -152,16 +258,7 @@ int main()
 
             while (lag >= tick_time_in_nanoseconds)
             {
-                gfx.final_ambient.update(tick_time_in_seconds);
-                
-                scene.physics.update(tick_time_in_seconds);
-                scene.animation.update(tick_time_in_seconds);
-                scene.generic.update(tick_time_in_seconds, keyboard, mouse);
-
-                scene.build_node_transform();
-
-                scene.generic.late_update(tick_time_in_seconds, keyboard, mouse);
-                scene.animation.late_update(tick_time_in_seconds);
+                scene.tick(tick_time_in_seconds, keyboard, mouse);
                 lag -= tick_time_in_nanoseconds;
             }
 
@@ -177,16 +274,12 @@ int main()
 
             const auto &g_buffer = gfx.geometry_buffer;
 
-            g_buffer.begin_shadowpass(cmd);
-            scene.renderer.render_depth(cmd);
-            scene.terrain_renderer.render_depth(cmd);
-            scene.map_renderer.render_depth(cmd);
+            g_buffer.begin_shadowpass(cmd, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            scene.render_depth(cmd);
             g_buffer.end(cmd);
 
-            g_buffer.begin_mainpass(cmd);
-            scene.renderer.render(cmd);
-            scene.terrain_renderer.render(cmd);
-            scene.map_renderer.render(cmd);
+            g_buffer.begin_mainpass(cmd, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            scene.render(cmd);
             g_buffer.end(cmd);
 
             g_buffer.begin_ssaopass(cmd);
@@ -207,6 +300,8 @@ int main()
             g_buffer.end(cmd);
 
             gfx.end_frame(cmd);
+            job_system.reset_frame_arenas();
+            memory_end_frame();
         }
 
         gfx.wait();
@@ -30,16 +30,16 @@ FPSCharacterController::FPSCharacterController(scene::SceneGraph &scene, scene::
 
 void FPSCharacterController::init()
 {
-    character_controller = (scene::components::CharacterController *)this->node.get_requested_component(typeid(scene::components::CharacterController).name());
+    character_controller = this->node.get_requested_component<scene::components::CharacterController>();
 
-    head_node = this->node.search_child_by_name("mixamorig:Head");
-    spine1 = this->node.search_child_by_name("mixamorig:Spine1");
-    spine = this->node.search_child_by_name("mixamorig:Spine");
-    hips = this->node.search_child_by_name("mixamorig:Hips");
+    head_node = this->node.search_instance_node_by_name("mixamorig:Head");
+    spine1 = this->node.search_instance_node_by_name("mixamorig:Spine1");
+    spine = this->node.search_instance_node_by_name("mixamorig:Spine");
+    hips = this->node.search_instance_node_by_name("mixamorig:Hips");
 
     // hips->set_position({0.0f, -0.8f, 0.0f});
 
-    animator = (scene::components::Animator *)node.get_requested_component(typeid(scene::components::Animator).name());
+    animator = node.get_requested_component<scene::components::Animator>();
     scene::systems::Animation::set_animator_animation(animator, "idle");
 }
 void FPSCharacterController::update(float delta, const hid::Keyboard &keyboard, const hid::Mouse &mouse)
@@ -144,8 +144,8 @@ void FPSCharacterController::update(float delta, const hid::Keyboard &keyboard,
     }
 
     // camera.position = translation;
-    spine->rotation *= glm::quat(glm::vec3(glm::radians(-pitch), 0.0f, glm::radians(roll)));
-    this->node.rotation = glm::quat(glm::vec3(0.0f, glm::radians(yaw), 0.0f));
+    spine->set_rotation(spine->get_rotation() * glm::quat(glm::vec3(glm::radians(-pitch), 0.0f, glm::radians(roll))));
+    this->node.set_rotation(glm::quat(glm::vec3(0.0f, glm::radians(yaw), 0.0f)));
 }
 
 nlohmann::json FPSCharacterController::to_json() const
@@ -157,7 +157,7 @@ nlohmann::json FPSCharacterController::to_json() const
 
 void FPSCharacterController::late_update(float delta, const hid::Keyboard &keyboard, const hid::Mouse &mouse)
 {
-    auto head_global_transform = head_node->global_transform;
+    auto head_global_transform = head_node->get_global_transform();
     glm::vec3 scale;
     glm::quat rotation;
     glm::vec3 translation;
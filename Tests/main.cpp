@@ -0,0 +1,205 @@
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <Core/src/scene/scene.hpp>
+#include <Core/src/scene/TransformHierarchy.hpp>
+#include <Core/src/utils/JobSystem.hpp>
+
+using namespace gage;
+
+// Small engine tests without a framework, exits with 1 when a check failed
+static int failed = 0;
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            failed++; \
+        } \
+    } while (0)
+
+static bool near(const glm::vec4 &column, float x, float y, float z)
+{
+    return std::abs(column.x - x) < 1e-5f && std::abs(column.y - y) < 1e-5f && std::abs(column.z - z) < 1e-5f;
+}
+
+// Children of a destroyed transform become roots that keep their local transform
+static void test_destroy_parent_with_children(utils::JobSystem &job_system)
+{
+    scene::TransformHierarchy transforms{};
+    scene::TransformHandle grand_parent = transforms.create();
+    scene::TransformHandle parent = transforms.create(grand_parent);
+    scene::TransformHandle child = transforms.create(parent);
+    scene::TransformHandle grand_child = transforms.create(child);
+    scene::TransformHandle sibling = transforms.create(parent);
+    transforms.set_position(grand_parent, glm::vec3{100.0f, 0.0f, 0.0f});
+    transforms.set_position(parent, glm::vec3{10.0f, 0.0f, 0.0f});
+    transforms.set_position(child, glm::vec3{1.0f, 0.0f, 0.0f});
+    transforms.set_position(grand_child, glm::vec3{0.0f, 1.0f, 0.0f});
+    transforms.set_position(sibling, glm::vec3{0.0f, 0.0f, 1.0f});
+    transforms.update(job_system);
+    CHECK(near(transforms.get_global_transform(grand_child)[3], 111.0f, 1.0f, 0.0f));
+
+    transforms.destroy(parent);
+    transforms.update(job_system);
+    CHECK(transforms.get_size() == 4);
+    CHECK(near(transforms.get_global_transform(grand_parent)[3], 100.0f, 0.0f, 0.0f));
+    CHECK(near(transforms.get_global_transform(child)[3], 1.0f, 0.0f, 0.0f));
+    CHECK(near(transforms.get_global_transform(grand_child)[3], 1.0f, 1.0f, 0.0f));
+    CHECK(near(transforms.get_global_transform(sibling)[3], 0.0f, 0.0f, 1.0f));
+
+    // The orphans are roots now, moving the old grand parent or reusing the destroyed handle does not reach them
+    scene::TransformHandle reused = transforms.create(grand_parent);
+    CHECK(reused == parent);
+    transforms.set_position(grand_parent, glm::vec3{200.0f, 0.0f, 0.0f});
+    transforms.set_position(child, glm::vec3{2.0f, 0.0f, 0.0f});
+    transforms.update(job_system);
+    CHECK(near(transforms.get_global_transform(reused)[3], 200.0f, 0.0f, 0.0f));
+    CHECK(near(transforms.get_global_transform(grand_child)[3], 2.0f, 1.0f, 0.0f));
+    CHECK(near(transforms.get_global_transform(sibling)[3], 0.0f, 0.0f, 1.0f));
+
+    // Destroyed before any update, while the order is already dirty
+    scene::TransformHandle parent2 = transforms.create();
+    scene::TransformHandle child2 = transforms.create(parent2);
+    transforms.set_position(parent2, glm::vec3{5.0f, 0.0f, 0.0f});
+    transforms.set_position(child2, glm::vec3{0.0f, 5.0f, 0.0f});
+    transforms.set_parent(parent2, grand_parent);
+    transforms.destroy(parent2);
+    transforms.update(job_system);
+    CHECK(near(transforms.get_global_transform(child2)[3], 0.0f, 5.0f, 0.0f));
+}
+
+// Moving a parent recomputes its whole subtree and get_changed() (SceneGraph::get_changed_transforms()) lists exactly
+// that subtree, a tick without moves lists nothing
+static void test_changed_transforms(utils::JobSystem &job_system)
+{
+    scene::TransformHierarchy transforms{};
+    scene::TransformHandle parent = transforms.create();
+    scene::TransformHandle child = transforms.create(parent);
+    scene::TransformHandle grand_child = transforms.create(child);
+    scene::TransformHandle sibling = transforms.create(parent);
+    scene::TransformHandle other = transforms.create();
+    transforms.set_position(grand_child, glm::vec3{0.0f, 1.0f, 0.0f});
+    transforms.update(job_system);
+    CHECK(transforms.get_changed().size() == 5);
+
+    transforms.set_position(child, glm::vec3{1.0f, 0.0f, 0.0f});
+    transforms.update(job_system);
+    std::vector<scene::TransformHandle> changed = transforms.get_changed();
+    std::sort(changed.begin(), changed.end());
+    CHECK((changed == std::vector<scene::TransformHandle>{child, grand_child}));
+    CHECK(near(transforms.get_global_transform(grand_child)[3], 1.0f, 1.0f, 0.0f));
+
+    transforms.set_position(parent, glm::vec3{10.0f, 0.0f, 0.0f});
+    transforms.set_position(child, glm::vec3{2.0f, 0.0f, 0.0f});
+    transforms.update(job_system);
+    changed = transforms.get_changed();
+    std::sort(changed.begin(), changed.end());
+    CHECK((changed == std::vector<scene::TransformHandle>{parent, child, grand_child, sibling}));
+    CHECK(near(transforms.get_global_transform(grand_child)[3], 12.0f, 1.0f, 0.0f));
+    CHECK(near(transforms.get_global_transform(sibling)[3], 10.0f, 0.0f, 0.0f));
+    CHECK(near(transforms.get_global_transform(other)[3], 0.0f, 0.0f, 0.0f));
+
+    transforms.update(job_system);
+    CHECK(transforms.get_changed().empty());
+
+    // Setting the value it already has is not a move
+    transforms.set_position(parent, glm::vec3{10.0f, 0.0f, 0.0f});
+    transforms.update(job_system);
+    CHECK(transforms.get_changed().empty());
+}
+
+// Roots with many children holding short chains, far more transforms than one batch
+static std::vector<scene::TransformHandle> build_wide_hierarchy(scene::TransformHierarchy &transforms)
+{
+    std::vector<scene::TransformHandle> handles{};
+    for (uint32_t r = 0; r < 3; r++)
+    {
+        scene::TransformHandle root = transforms.create();
+        transforms.set_position(root, glm::vec3{r * 10.0f, 0.0f, 0.0f});
+        handles.push_back(root);
+        for (uint32_t c = 0; c < 1000; c++)
+        {
+            scene::TransformHandle parent = root;
+            for (uint32_t d = 0; d < 4; d++)
+            {
+                float angle = 0.01f * (c + d);
+                scene::TransformHandle child = transforms.create(parent);
+                transforms.set_position(child, glm::vec3{0.1f * c, 1.0f, 0.5f * d});
+                transforms.set_rotation(child, glm::quat{std::cos(angle), 0.0f, std::sin(angle), 0.0f});
+                transforms.set_scale(child, glm::vec3{1.0f + 0.01f * d});
+                handles.push_back(child);
+                parent = child;
+            }
+        }
+    }
+    return handles;
+}
+
+// Global transforms after a full update and after moving one root, with the given number of workers
+static std::vector<glm::mat4x4> update_wide_hierarchy(uint32_t worker_count)
+{
+    utils::JobSystem job_system{worker_count};
+    scene::TransformHierarchy transforms{};
+    std::vector<scene::TransformHandle> handles = build_wide_hierarchy(transforms);
+    std::vector<glm::mat4x4> global_transforms{};
+
+    transforms.update(job_system);
+    for (scene::TransformHandle handle : handles)
+    {
+        global_transforms.push_back(transforms.get_global_transform(handle));
+    }
+
+    transforms.set_position(handles[0], glm::vec3{0.0f, 5.0f, 0.0f});
+    transforms.update(job_system);
+    for (scene::TransformHandle handle : handles)
+    {
+        global_transforms.push_back(transforms.get_global_transform(handle));
+    }
+    return global_transforms;
+}
+
+// Batches updated in parallel give the same result as a single worker walking every batch
+static void test_parallel_update_matches_single_worker()
+{
+    std::vector<glm::mat4x4> single = update_wide_hierarchy(1);
+    std::vector<glm::mat4x4> parallel = update_wide_hierarchy(4);
+    CHECK(single.size() / 2 > scene::TransformHierarchy::MIN_TRANSFORMS_PER_BATCH);
+    CHECK(single.size() == parallel.size());
+
+    uint32_t mismatches = 0;
+    for (size_t i = 0; i < single.size() && i < parallel.size(); i++)
+    {
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            if (!near(parallel[i][column], single[i][column].x, single[i][column].y, single[i][column].z) ||
+                std::abs(parallel[i][column].w - single[i][column].w) >= 1e-5f)
+                mismatches++;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+int main()
+{
+    scene::init();
+    // Brings up job systems of its own, the calling thread can only be worker 0 of one job system at a time
+    test_parallel_update_matches_single_worker();
+
+    utils::JobSystem job_system{};
+
+    test_destroy_parent_with_children(job_system);
+    test_changed_transforms(job_system);
+
+    if (failed != 0)
+    {
+        std::fprintf(stderr, "%d checks failed\n", failed);
+        return 1;
+    }
+    std::printf("All tests passed\n");
+    return 0;
+}
@@ -128,4 +128,54 @@ project "Sandbox"
 
 
 
-   
\ No newline at end of file
+   
+
+project "AssetCooker"
+   location "AssetCooker"
+   kind "ConsoleApp"
+   targetdir "bin/%{prj.name}/%{cfg.buildcfg}"
+   objdir "obj/%{prj.name}/%{cfg.buildcfg}"
+
+   files {
+      "%{prj.location}/**.hpp", "%{prj.location}/**.cpp",
+   }
+   dependson { "Core" }
+   links { "Core" }
+   includedirs { 
+      "%{prj.location}",
+      "%{wks.location}"
+   }
+
+   filter "Debug"
+      buildoptions 
+      {
+         "-Wall -Wextra -Wpedantic -fsanitize=address -static-libasan"
+      }
+
+      linkoptions { "-fsanitize=address -static-libasan" }
+
+
+
+project "Tests"
+   location "Tests"
+   kind "ConsoleApp"
+   targetdir "bin/%{prj.name}/%{cfg.buildcfg}"
+   objdir "obj/%{prj.name}/%{cfg.buildcfg}"
+
+   files {
+      "%{prj.location}/**.hpp", "%{prj.location}/**.cpp",
+   }
+   dependson { "Core" }
+   links { "Core" }
+   includedirs { 
+      "%{prj.location}",
+      "%{wks.location}"
+   }
+
+   filter "Debug"
+      buildoptions 
+      {
+         "-Wall -Wextra -Wpedantic -fsanitize=address -static-libasan"
+      }
+
+      linkoptions { "-fsanitize=address -static-libasan" }